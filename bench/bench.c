@@ -0,0 +1,627 @@
+/**
+ * bench.c - Protocol-level benchmark suite
+ *
+ * Times every operation the demo in src/main.c exercises, plus the rest of
+ * the MIRACL and CJOSE surface we rely on in production:
+ * - MIRACL Core: ECDH key generation and shared secrets, ECDSA, EdDSA, HPKE
+ * - CJOSE: JWS sign/verify and JWE encrypt/decrypt for every alg/enc pair
+ *
+ * Each operation is timed call by call, so the report carries latency
+ * percentiles (p50, p99, p99.9) as well as throughput. Results are printed
+ * as a table and written as JSON for regression tracking.
+ *
+ * Usage: ccrypt-bench [-n iterations] [-o results.json] [-f filter]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// MIRACL Core headers
+#include "core.h"
+#include "big_256_56.h"
+#include "fp_NIST256.h"
+#include "ecp_NIST256.h"
+#include "ecdh_NIST256.h"
+#include "eddsa_NIST256.h"
+#include "hpke_NIST256.h"
+
+// Fast paths on top of MIRACL Core
+#include "ecc_NIST256.h"
+#include "ecpool_NIST256.h"
+
+// CJOSE headers
+#include "cjose/cjose.h"
+
+#define DEFAULT_ITERATIONS 1000
+#define DEFAULT_OUTPUT "build/bench.json"
+#define MAX_RESULTS 128
+#define WARMUP_ITERATIONS 10
+#define VERIFY_BATCH 64
+#define KEYGEN_BATCH 64
+
+// HPKE suite: DHKEM(P-256, HKDF-SHA256) = 0x10, HKDF-SHA256 = 1, AES-128-GCM = 1
+#define HPKE_CONFIG_ID (0x10 | (1 << 8) | (1 << 10))
+
+// A benchmarked operation returns 0 on success
+typedef int (*bench_fn)(void *ctx);
+
+typedef struct {
+    char group[32];
+    char name[64];
+    int iterations;
+    double ops_per_sec;
+    double mean_ns;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+} bench_result;
+
+static bench_result results[MAX_RESULTS];
+static int num_results = 0;
+static int iterations = DEFAULT_ITERATIONS;
+static const char *filter = NULL;
+
+static const char *payload = "{\"sub\":\"1234567890\",\"name\":\"John Doe\",\"iat\":1516239022}";
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile over sorted samples
+static double percentile(const double *sorted, int n, double p) {
+    int rank = (int)(p * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+// Time fn call by call and record its latency distribution
+static void run_bench(const char *group, const char *name, bench_fn fn, void *ctx) {
+    char full[128];
+    snprintf(full, sizeof(full), "%s/%s", group, name);
+    if (filter && !strstr(full, filter)) return;
+    if (num_results == MAX_RESULTS) return;
+
+    double *samples = malloc(sizeof(double) * iterations);
+    if (!samples) return;
+
+    for (int i = 0; i < WARMUP_ITERATIONS; i++) {
+        if (fn(ctx) != 0) {
+            printf("✗ %-40s failed, skipped\n", full);
+            free(samples);
+            return;
+        }
+    }
+
+    double total = 0;
+    for (int i = 0; i < iterations; i++) {
+        double start = now_ns();
+        int rc = fn(ctx);
+        samples[i] = now_ns() - start;
+        total += samples[i];
+        if (rc != 0) {
+            printf("✗ %-40s failed on iteration %d\n", full, i);
+            free(samples);
+            return;
+        }
+    }
+    qsort(samples, iterations, sizeof(double), compare_double);
+
+    bench_result *r = &results[num_results++];
+    snprintf(r->group, sizeof(r->group), "%s", group);
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->iterations = iterations;
+    r->ops_per_sec = iterations / (total / 1e9);
+    r->mean_ns = total / iterations;
+    r->p50_ns = percentile(samples, iterations, 0.50);
+    r->p99_ns = percentile(samples, iterations, 0.99);
+    r->p999_ns = percentile(samples, iterations, 0.999);
+
+    printf("%-40s %12.1f %12.1f %12.1f %12.1f\n", full,
+           r->ops_per_sec, r->p50_ns / 1e3, r->p99_ns / 1e3, r->p999_ns / 1e3);
+    free(samples);
+}
+
+static int write_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 1;
+    fprintf(f, "{\n  \"timestamp\": %ld,\n  \"iterations\": %d,\n  \"results\": [\n",
+            (long)time(NULL), iterations);
+    for (int i = 0; i < num_results; i++) {
+        bench_result *r = &results[i];
+        fprintf(f, "    {\"group\": \"%s\", \"name\": \"%s\", \"iterations\": %d, "
+                   "\"ops_per_sec\": %.2f, \"mean_ns\": %.1f, \"p50_ns\": %.1f, "
+                   "\"p99_ns\": %.1f, \"p999_ns\": %.1f}%s\n",
+                r->group, r->name, r->iterations, r->ops_per_sec, r->mean_ns,
+                r->p50_ns, r->p99_ns, r->p999_ns, i + 1 < num_results ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// MIRACL Core operations
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    csprng rng;
+    char s1[EGS_NIST256], w1[2 * EFS_NIST256 + 1];
+    char s2[EGS_NIST256], w2[2 * EFS_NIST256 + 1];
+    char c[EGS_NIST256], d[EGS_NIST256];
+    char ed_d[EGS_NIST256], ed_q[2 * EFS_NIST256 + 1], ed_sig[4 * EFS_NIST256];
+    char ske[EGS_NIST256], pke[2 * EFS_NIST256 + 1];
+    octet S1, W1, S2, W2, C, D, ED_D, ED_Q, ED_SIG, SKE, PKE, M;
+    ECC_NIST256_VERIFIER V1; // prepared once for W1
+    ECC_NIST256_POOL *pool;  // ephemeral keys for ECDH-ES
+    ECC_NIST256_SIGNER *signer; // nonce tuples for S1
+} miracl_ctx;
+
+static int op_key_pair_generate(void *p) {
+    miracl_ctx *m = p;
+    char s[EGS_NIST256], w[2 * EFS_NIST256 + 1];
+    octet S = {0, sizeof(s), s};
+    octet W = {0, sizeof(w), w};
+    return ECP_NIST256_KEY_PAIR_GENERATE(&m->rng, &S, &W);
+}
+
+static int op_ecc_key_pair_generate(void *p) {
+    miracl_ctx *m = p;
+    char s[EGS_NIST256], w[2 * EFS_NIST256 + 1];
+    octet S = {0, sizeof(s), s};
+    octet W = {0, sizeof(w), w};
+    return ECC_NIST256_KEY_PAIR_GENERATE(&m->rng, &S, &W);
+}
+
+// KEYGEN_BATCH key pairs one call at a time, then in one batch call
+static int op_ecc_key_pair_generate_loop(void *p) {
+    miracl_ctx *m = p;
+    static char s[KEYGEN_BATCH][EGS_NIST256], w[KEYGEN_BATCH][2 * EFS_NIST256 + 1];
+    int rc = 0;
+    for (int i = 0; i < KEYGEN_BATCH; i++) {
+        octet S = {0, sizeof(s[i]), s[i]};
+        octet W = {0, sizeof(w[i]), w[i]};
+        rc |= ECC_NIST256_KEY_PAIR_GENERATE(&m->rng, &S, &W);
+    }
+    return rc;
+}
+
+static int op_ecc_key_pair_generate_batch(void *p) {
+    miracl_ctx *m = p;
+    static char s[KEYGEN_BATCH * EGS_NIST256], w[KEYGEN_BATCH * (2 * EFS_NIST256 + 1)];
+    octet S = {0, sizeof(s), s};
+    octet W = {0, sizeof(w), w};
+    return ECC_NIST256_KEY_PAIR_GENERATE_BATCH(&m->rng, KEYGEN_BATCH, &S, &W);
+}
+
+static int op_svdp_dh(void *p) {
+    miracl_ctx *m = p;
+    char k[EFS_NIST256];
+    octet K = {0, sizeof(k), k};
+    return ECP_NIST256_SVDP_DH(&m->S1, &m->W2, &K, 0);
+}
+
+// ECDH-ES sender to W2: fresh ephemeral key pair, then the shared secret
+static int op_ecdh_es_inline(void *p) {
+    miracl_ctx *m = p;
+    char s[EGS_NIST256], e[2 * EFS_NIST256 + 1], z[EFS_NIST256];
+    octet S = {0, sizeof(s), s};
+    octet E = {0, sizeof(e), e};
+    octet Z = {0, sizeof(z), z};
+    if (ECC_NIST256_KEY_PAIR_GENERATE(&m->rng, &S, &E) != 0) return 1;
+    return ECP_NIST256_SVDP_DH(&S, &m->W2, &Z, 0);
+}
+
+static int op_ecdh_es_pool(void *p) {
+    miracl_ctx *m = p;
+    char e[2 * EFS_NIST256 + 1], z[EFS_NIST256];
+    octet E = {0, sizeof(e), e};
+    octet Z = {0, sizeof(z), z};
+    return ECC_NIST256_POOL_ECDH_ES(m->pool, &m->rng, &m->W2, &Z, &E);
+}
+
+static int op_sp_dsa(void *p) {
+    miracl_ctx *m = p;
+    return ECP_NIST256_SP_DSA(HASH_TYPE_NIST256, &m->rng, NULL, &m->S1, &m->M, &m->C, &m->D);
+}
+
+static int op_ecc_sp_dsa(void *p) {
+    miracl_ctx *m = p;
+    return ECC_NIST256_SP_DSA(HASH_TYPE_NIST256, &m->rng, NULL, &m->S1, &m->M, &m->C, &m->D);
+}
+
+static int op_signer_sp_dsa(void *p) {
+    miracl_ctx *m = p;
+    return ECC_NIST256_SIGNER_SP_DSA(m->signer, HASH_TYPE_NIST256, &m->rng, &m->M, &m->C, &m->D);
+}
+
+static int op_vp_dsa(void *p) {
+    miracl_ctx *m = p;
+    return ECP_NIST256_VP_DSA(HASH_TYPE_NIST256, &m->W1, &m->M, &m->C, &m->D);
+}
+
+static int op_verifier_init(void *p) {
+    miracl_ctx *m = p;
+    ECC_NIST256_VERIFIER v;
+    return ECC_NIST256_VERIFIER_INIT(&v, &m->W1);
+}
+
+static int op_verifier_vp_dsa(void *p) {
+    miracl_ctx *m = p;
+    return ECC_NIST256_VERIFIER_VP_DSA(&m->V1, HASH_TYPE_NIST256, &m->M, &m->C, &m->D);
+}
+
+// VERIFY_BATCH distinct keys, messages and signatures
+typedef struct {
+    char s[VERIFY_BATCH][EGS_NIST256], w[VERIFY_BATCH][2 * EFS_NIST256 + 1];
+    char m[VERIFY_BATCH][16], c[VERIFY_BATCH][EGS_NIST256], d[VERIFY_BATCH][EGS_NIST256];
+    octet S[VERIFY_BATCH], W[VERIFY_BATCH], M[VERIFY_BATCH], C[VERIFY_BATCH], D[VERIFY_BATCH];
+    int res[VERIFY_BATCH];
+} batch_ctx;
+
+static int setup_batch(batch_ctx *b, csprng *rng) {
+    for (int i = 0; i < VERIFY_BATCH; i++) {
+        b->S[i] = (octet){0, sizeof(b->s[i]), b->s[i]};
+        b->W[i] = (octet){0, sizeof(b->w[i]), b->w[i]};
+        b->M[i] = (octet){0, sizeof(b->m[i]), b->m[i]};
+        b->C[i] = (octet){0, sizeof(b->c[i]), b->c[i]};
+        b->D[i] = (octet){0, sizeof(b->d[i]), b->d[i]};
+        OCT_rand(&b->M[i], rng, sizeof(b->m[i]));
+        if (ECP_NIST256_KEY_PAIR_GENERATE(rng, &b->S[i], &b->W[i]) != 0 ||
+            ECP_NIST256_SP_DSA(HASH_TYPE_NIST256, rng, NULL, &b->S[i], &b->M[i], &b->C[i], &b->D[i]) != 0)
+            return 1;
+    }
+    return 0;
+}
+
+// One call verifies the whole batch; divide by VERIFY_BATCH for per-signature cost
+static int op_vp_dsa_batch(void *p) {
+    batch_ctx *b = p;
+    return ECC_NIST256_VP_DSA_BATCH(HASH_TYPE_NIST256, VERIFY_BATCH, b->W, b->M, b->C, b->D, b->res);
+}
+
+static int op_vp_dsa_loop(void *p) {
+    batch_ctx *b = p;
+    int rc = 0;
+    for (int i = 0; i < VERIFY_BATCH; i++)
+        rc |= ECP_NIST256_VP_DSA(HASH_TYPE_NIST256, &b->W[i], &b->M[i], &b->C[i], &b->D[i]);
+    return rc;
+}
+
+static int op_eddsa_sign(void *p) {
+    miracl_ctx *m = p;
+    return EDDSA_NIST256_SIGNATURE(false, &m->ED_D, NULL, &m->M, &m->ED_SIG);
+}
+
+static int op_eddsa_verify(void *p) {
+    miracl_ctx *m = p;
+    return EDDSA_NIST256_VERIFY(false, &m->ED_Q, NULL, &m->M, &m->ED_SIG) ? 0 : 1;
+}
+
+static int op_hpke_encap(void *p) {
+    miracl_ctx *m = p;
+    char z[EFS_NIST256];
+    octet Z = {0, sizeof(z), z};
+    HPKE_NIST256_Encap(HPKE_CONFIG_ID, &m->SKE, &Z, &m->PKE, &m->W2);
+    return Z.len > 0 ? 0 : 1;
+}
+
+static int op_hpke_decap(void *p) {
+    miracl_ctx *m = p;
+    char z[EFS_NIST256];
+    octet Z = {0, sizeof(z), z};
+    HPKE_NIST256_Decap(HPKE_CONFIG_ID, &m->S2, &Z, &m->PKE, &m->W2);
+    return Z.len > 0 ? 0 : 1;
+}
+
+static int bench_miracl(void) {
+    static miracl_ctx m;
+    static batch_ctx b;
+    char raw[100];
+    time_t ran = time(NULL);
+    raw[0] = (char)ran;
+    raw[1] = (char)(ran >> 8);
+    raw[2] = (char)(ran >> 16);
+    raw[3] = (char)(ran >> 24);
+    for (int i = 4; i < 100; i++) raw[i] = (char)i;
+    RAND_seed(&m.rng, 100, raw);
+
+    m.S1 = (octet){0, sizeof(m.s1), m.s1};
+    m.W1 = (octet){0, sizeof(m.w1), m.w1};
+    m.S2 = (octet){0, sizeof(m.s2), m.s2};
+    m.W2 = (octet){0, sizeof(m.w2), m.w2};
+    m.C = (octet){0, sizeof(m.c), m.c};
+    m.D = (octet){0, sizeof(m.d), m.d};
+    m.ED_D = (octet){0, sizeof(m.ed_d), m.ed_d};
+    m.ED_Q = (octet){0, sizeof(m.ed_q), m.ed_q};
+    m.ED_SIG = (octet){0, sizeof(m.ed_sig), m.ed_sig};
+    m.SKE = (octet){0, sizeof(m.ske), m.ske};
+    m.PKE = (octet){0, sizeof(m.pke), m.pke};
+    m.M = (octet){(int)strlen(payload), (int)strlen(payload), (char *)payload};
+
+    if (ECP_NIST256_KEY_PAIR_GENERATE(&m.rng, &m.S1, &m.W1) != 0 ||
+        ECP_NIST256_KEY_PAIR_GENERATE(&m.rng, &m.S2, &m.W2) != 0 ||
+        EDDSA_NIST256_KEY_PAIR_GENERATE(&m.rng, &m.ED_D, &m.ED_Q) != 0) {
+        printf("✗ MIRACL Core: key setup failed\n");
+        return 1;
+    }
+
+    // HPKE ephemeral key derived from a random seed, as a sender would
+    char seed[EGS_NIST256];
+    octet SEED = {0, sizeof(seed), seed};
+    OCT_rand(&SEED, &m.rng, EGS_NIST256);
+    DeriveKeyPair_NIST256(HPKE_CONFIG_ID, &m.SKE, &m.PKE, &SEED);
+
+    ECP_NIST256_SP_DSA(HASH_TYPE_NIST256, &m.rng, NULL, &m.S1, &m.M, &m.C, &m.D);
+    EDDSA_NIST256_SIGNATURE(false, &m.ED_D, NULL, &m.M, &m.ED_SIG);
+
+    if (ECC_NIST256_VERIFIER_INIT(&m.V1, &m.W1) != 0) {
+        printf("✗ ccrypt: verifier setup failed\n");
+        return 1;
+    }
+
+    run_bench("miracl", "ECP_NIST256_KEY_PAIR_GENERATE", op_key_pair_generate, &m);
+    run_bench("miracl", "ECP_NIST256_SVDP_DH", op_svdp_dh, &m);
+    run_bench("miracl", "ECP_NIST256_SP_DSA", op_sp_dsa, &m);
+    run_bench("miracl", "ECP_NIST256_VP_DSA", op_vp_dsa, &m);
+    run_bench("miracl", "EDDSA_NIST256_SIGNATURE", op_eddsa_sign, &m);
+    run_bench("miracl", "EDDSA_NIST256_VERIFY", op_eddsa_verify, &m);
+    run_bench("miracl", "HPKE_NIST256_Encap", op_hpke_encap, &m);
+    run_bench("miracl", "HPKE_NIST256_Decap", op_hpke_decap, &m);
+
+    run_bench("ccrypt", "ECC_NIST256_KEY_PAIR_GENERATE", op_ecc_key_pair_generate, &m);
+    run_bench("ccrypt", "ECC_NIST256_KEY_PAIR_GENERATE x64", op_ecc_key_pair_generate_loop, &m);
+    run_bench("ccrypt", "ECC_NIST256_KEY_PAIR_GENERATE_BATCH x64", op_ecc_key_pair_generate_batch, &m);
+    run_bench("ccrypt", "ECDH-ES inline ephemeral key", op_ecdh_es_inline, &m);
+    m.pool = ECC_NIST256_POOL_NEW(&m.rng, 256);
+    if (m.pool != NULL) {
+        ECC_NIST256_POOL_STATS ps;
+        run_bench("ccrypt", "ECC_NIST256_POOL_ECDH_ES", op_ecdh_es_pool, &m);
+        ECC_NIST256_POOL_GET_STATS(m.pool, &ps);
+        printf("  pool: depth %d/%d, %llu hits, %llu misses (%.1f%% miss rate)\n", ps.depth, ps.size,
+               (unsigned long long)ps.hits, (unsigned long long)ps.misses, 100.0 * ps.miss_rate);
+        ECC_NIST256_POOL_FREE(m.pool);
+        m.pool = NULL;
+    }
+    run_bench("ccrypt", "ECC_NIST256_SP_DSA", op_ecc_sp_dsa, &m);
+    m.signer = ECC_NIST256_SIGNER_NEW(&m.rng, &m.S1, 2048);
+    if (m.signer != NULL) {
+        // Let the ring fill first, so the run measures a burst served from it
+        ECC_NIST256_RING_STATS rs;
+        struct timespec tick = {0, 10000000};
+        for (int i = 0; i < 1000; i++) {
+            ECC_NIST256_SIGNER_GET_STATS(m.signer, &rs);
+            if (rs.depth == rs.size) break;
+            nanosleep(&tick, NULL);
+        }
+        run_bench("ccrypt", "ECC_NIST256_SIGNER_SP_DSA", op_signer_sp_dsa, &m);
+        ECC_NIST256_SIGNER_GET_STATS(m.signer, &rs);
+        printf("  signer: depth %d/%d, %llu hits, %llu misses (%.1f%% miss rate)\n", rs.depth, rs.size,
+               (unsigned long long)rs.hits, (unsigned long long)rs.misses, 100.0 * rs.miss_rate);
+        ECC_NIST256_SIGNER_FREE(m.signer);
+        m.signer = NULL;
+    }
+    run_bench("ccrypt", "ECC_NIST256_VERIFIER_INIT", op_verifier_init, &m);
+    run_bench("ccrypt", "ECC_NIST256_VERIFIER_VP_DSA", op_verifier_vp_dsa, &m);
+
+    if (setup_batch(&b, &m.rng) != 0) {
+        printf("✗ MIRACL Core: batch setup failed\n");
+        return 1;
+    }
+    run_bench("miracl", "ECP_NIST256_VP_DSA x64", op_vp_dsa_loop, &b);
+    run_bench("ccrypt", "ECC_NIST256_VP_DSA_BATCH x64", op_vp_dsa_batch, &b);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// CJOSE operations
+// ---------------------------------------------------------------------------
+
+typedef struct {
+    cjose_jwk_t *jwk;
+    cjose_header_t *header;
+    char *compact; // pre-built serialization for the verify/decrypt side
+} cjose_ctx;
+
+static int op_jws_sign(void *p) {
+    cjose_ctx *c = p;
+    cjose_err err;
+    cjose_jws_t *jws = cjose_jws_sign(c->jwk, c->header, (const uint8_t *)payload, strlen(payload), &err);
+    if (!jws) return 1;
+    cjose_jws_release(jws);
+    return 0;
+}
+
+// Verification starts from the compact form, as a receiving service would
+static int op_jws_verify(void *p) {
+    cjose_ctx *c = p;
+    cjose_err err;
+    cjose_jws_t *jws = cjose_jws_import(c->compact, strlen(c->compact), &err);
+    if (!jws) return 1;
+    bool ok = cjose_jws_verify(jws, c->jwk, &err);
+    cjose_jws_release(jws);
+    return ok ? 0 : 1;
+}
+
+static int op_jwe_encrypt(void *p) {
+    cjose_ctx *c = p;
+    cjose_err err;
+    cjose_jwe_t *jwe = cjose_jwe_encrypt(c->jwk, c->header, (const uint8_t *)payload, strlen(payload), &err);
+    if (!jwe) return 1;
+    cjose_jwe_release(jwe);
+    return 0;
+}
+
+static int op_jwe_decrypt(void *p) {
+    cjose_ctx *c = p;
+    cjose_err err;
+    size_t len = 0;
+    cjose_jwe_t *jwe = cjose_jwe_import(c->compact, strlen(c->compact), &err);
+    if (!jwe) return 1;
+    uint8_t *plain = cjose_jwe_decrypt(jwe, c->jwk, &len, &err);
+    cjose_jwe_release(jwe);
+    if (!plain) return 1;
+    cjose_get_dealloc()(plain);
+    return 0;
+}
+
+static cjose_header_t *make_header(const char *alg, const char *enc) {
+    cjose_err err;
+    cjose_header_t *header = cjose_header_new(&err);
+    if (!header) return NULL;
+    if (!cjose_header_set(header, CJOSE_HDR_ALG, alg, &err) ||
+        (enc && !cjose_header_set(header, CJOSE_HDR_ENC, enc, &err))) {
+        cjose_header_release(header);
+        return NULL;
+    }
+    return header;
+}
+
+static void bench_jws(const char *alg, cjose_jwk_t *jwk) {
+    cjose_err err;
+    cjose_ctx c = {jwk, make_header(alg, NULL), NULL};
+    if (!c.header) return;
+
+    cjose_jws_t *jws = cjose_jws_sign(jwk, c.header, (const uint8_t *)payload, strlen(payload), &err);
+    const char *ser = NULL;
+    if (jws && cjose_jws_export(jws, &ser, &err)) {
+        c.compact = strdup(ser);
+        run_bench("cjose_jws_sign", alg, op_jws_sign, &c);
+        run_bench("cjose_jws_verify", alg, op_jws_verify, &c);
+    } else {
+        printf("✗ CJOSE: %s signing failed: %s\n", alg, err.message ? err.message : "Unknown error");
+    }
+
+    if (jws) cjose_jws_release(jws);
+    free(c.compact);
+    cjose_header_release(c.header);
+}
+
+static void bench_jwe(const char *alg, const char *enc, cjose_jwk_t *jwk) {
+    cjose_err err;
+    char name[64];
+    cjose_ctx c = {jwk, make_header(alg, enc), NULL};
+    if (!c.header) return;
+    snprintf(name, sizeof(name), "%s+%s", alg, enc);
+
+    cjose_jwe_t *jwe = cjose_jwe_encrypt(jwk, c.header, (const uint8_t *)payload, strlen(payload), &err);
+    if (jwe && (c.compact = cjose_jwe_export(jwe, &err)) != NULL) {
+        run_bench("cjose_jwe_encrypt", name, op_jwe_encrypt, &c);
+        run_bench("cjose_jwe_decrypt", name, op_jwe_decrypt, &c);
+        cjose_get_dealloc()(c.compact);
+    } else {
+        printf("✗ CJOSE: %s encryption failed: %s\n", name, err.message ? err.message : "Unknown error");
+    }
+
+    if (jwe) cjose_jwe_release(jwe);
+    cjose_header_release(c.header);
+}
+
+// Content-encryption key size for "dir", in bytes
+static size_t cek_size(const char *enc) {
+    if (strcmp(enc, CJOSE_HDR_ENC_A128GCM) == 0) return 16;
+    if (strcmp(enc, CJOSE_HDR_ENC_A192GCM) == 0) return 24;
+    if (strcmp(enc, CJOSE_HDR_ENC_A256GCM) == 0) return 32;
+    if (strcmp(enc, CJOSE_HDR_ENC_A128CBC_HS256) == 0) return 32;
+    if (strcmp(enc, CJOSE_HDR_ENC_A192CBC_HS384) == 0) return 48;
+    return 64;
+}
+
+static int bench_cjose(void) {
+    cjose_err err;
+    static const uint8_t e[] = {0x01, 0x00, 0x01};
+
+    cjose_jwk_t *oct = cjose_jwk_create_oct_random(32, &err);
+    cjose_jwk_t *ec = cjose_jwk_create_EC_random(CJOSE_JWK_EC_P_256, &err);
+    cjose_jwk_t *rsa = cjose_jwk_create_RSA_random(2048, e, sizeof(e), &err);
+    cjose_jwk_t *kw[3] = {
+        cjose_jwk_create_oct_random(16, &err),
+        cjose_jwk_create_oct_random(24, &err),
+        cjose_jwk_create_oct_random(32, &err),
+    };
+    if (!oct || !ec || !rsa || !kw[0] || !kw[1] || !kw[2]) {
+        printf("✗ CJOSE: key setup failed: %s\n", err.message ? err.message : "Unknown error");
+        return 1;
+    }
+
+    bench_jws(CJOSE_HDR_ALG_HS256, oct);
+    bench_jws(CJOSE_HDR_ALG_ES256, ec);
+    bench_jws(CJOSE_HDR_ALG_RS256, rsa);
+    bench_jws(CJOSE_HDR_ALG_PS256, rsa);
+
+    const char *encs[] = {
+        CJOSE_HDR_ENC_A128GCM, CJOSE_HDR_ENC_A192GCM, CJOSE_HDR_ENC_A256GCM,
+        CJOSE_HDR_ENC_A128CBC_HS256, CJOSE_HDR_ENC_A192CBC_HS384, CJOSE_HDR_ENC_A256CBC_HS512,
+    };
+    for (size_t i = 0; i < sizeof(encs) / sizeof(encs[0]); i++) {
+        const char *enc = encs[i];
+        bench_jwe(CJOSE_HDR_ALG_RSA_OAEP, enc, rsa);
+        bench_jwe(CJOSE_HDR_ALG_RSA1_5, enc, rsa);
+        bench_jwe(CJOSE_HDR_ALG_A128KW, enc, kw[0]);
+        bench_jwe(CJOSE_HDR_ALG_A192KW, enc, kw[1]);
+        bench_jwe(CJOSE_HDR_ALG_A256KW, enc, kw[2]);
+        bench_jwe(CJOSE_HDR_ALG_ECDH_ES, enc, ec);
+
+        cjose_jwk_t *cek = cjose_jwk_create_oct_random(cek_size(enc), &err);
+        if (cek) {
+            bench_jwe(CJOSE_HDR_ALG_DIR, enc, cek);
+            cjose_jwk_release(cek);
+        }
+    }
+
+    cjose_jwk_release(oct);
+    cjose_jwk_release(ec);
+    cjose_jwk_release(rsa);
+    for (int i = 0; i < 3; i++) cjose_jwk_release(kw[i]);
+    return 0;
+}
+
+static void usage(const char *prog) {
+    printf("Usage: %s [-n iterations] [-o results.json] [-f filter]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    const char *output = DEFAULT_OUTPUT;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (iterations < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("CJOSE + MIRACL Core Benchmarks (%d iterations)\n", iterations);
+    printf("==============================================\n");
+    printf("%-40s %12s %12s %12s %12s\n", "operation", "ops/sec", "p50 (us)", "p99 (us)", "p99.9 (us)");
+
+    int rc = bench_miracl();
+    rc |= bench_cjose();
+
+    if (write_json(output) != 0) {
+        printf("✗ Failed to write %s\n", output);
+        return 1;
+    }
+    printf("\n✓ Results written to %s\n", output);
+    return rc;
+}
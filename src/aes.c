@@ -0,0 +1,596 @@
+/**
+ * aes.c - Bulk AES on MIRACL Core's core_aes state, with AES-NI and VAES
+ *
+ * With fkey packed little-endian, round key r is the 16 bytes at
+ * fkey + 4r as they lie in memory, so the kernels load the schedule
+ * straight into vector registers; likewise rkey is already the schedule
+ * AESDEC expects, the InvMixColumns of the middle round keys in reverse.
+ *
+ * The interleaved kernels keep their blocks in named registers, x0..x7
+ * or y0..y3, each round applied to all of them in turn. Blocks left over
+ * from the widest kernel go through the next one down, and single blocks
+ * one at a time. Counter blocks are held byte-reversed, so that the
+ * big-endian 32-bit counter is the low word of the vector and the next
+ * counters are one vector addition away.
+ */
+
+#include <string.h>
+
+#include "aes.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(AES_NOSIMD)
+#define AES_X86
+#include <immintrin.h>
+#endif
+
+#define AES_CHUNK 64  /* Blocks staged at a time by the IEEE-1363 functions */
+
+static int AES_active = -1;
+
+#ifdef AES_X86
+
+#define AESNI_TARGET __attribute__((target("aes,sse4.1")))
+#define VAES_TARGET __attribute__((target("aes,sse4.1,avx512f,avx512bw,vaes")))
+
+static const unsigned char RCON[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+
+/* One round f with key k on each of the eight blocks x0..x7 */
+#define AES_ROUND8(f, k)    \
+    do                      \
+    {                       \
+        x0 = f(x0, k);      \
+        x1 = f(x1, k);      \
+        x2 = f(x2, k);      \
+        x3 = f(x3, k);      \
+        x4 = f(x4, k);      \
+        x5 = f(x5, k);      \
+        x6 = f(x6, k);      \
+        x7 = f(x7, k);      \
+    } while (0)
+
+/* All nr rounds on x0..x7, with round functions f, then g for the last */
+#define AES_CIPHER8(rk, nr, f, g)                                      \
+    do                                                                 \
+    {                                                                  \
+        AES_ROUND8(_mm_xor_si128, rk[0]);                              \
+        for (int r = 1; r < nr; r++) AES_ROUND8(f, rk[r]);             \
+        AES_ROUND8(g, rk[nr]);                                         \
+    } while (0)
+
+#define AES_ROUND4(f, k)    \
+    do                      \
+    {                       \
+        y0 = f(y0, k);      \
+        y1 = f(y1, k);      \
+        y2 = f(y2, k);      \
+        y3 = f(y3, k);      \
+    } while (0)
+
+#define AES_CIPHER16(rk, nr, f, g)                                     \
+    do                                                                 \
+    {                                                                  \
+        AES_ROUND4(_mm512_xor_si512, rk[0]);                           \
+        for (int r = 1; r < nr; r++) AES_ROUND4(f, rk[r]);             \
+        AES_ROUND4(g, rk[nr]);                                         \
+    } while (0)
+
+/* SubWord of the little-endian word x, from the S-box in the AES unit */
+AESNI_TARGET static unsign32 AES_subword(unsign32 x)
+{
+    return (unsign32)_mm_cvtsi128_si32(_mm_aeskeygenassist_si128(_mm_set_epi32(0, 0, (int)x, 0), 0));
+}
+
+/* The FIPS-197 key expansion of the nk-word key k into 4(nk+7) words w */
+AESNI_TARGET static void AES_expand(unsign32 *w, int nk, const char *k)
+{
+    unsign32 t;
+    int i, n = 4 * (nk + 7);
+
+    for (i = 0; i < nk; i++)
+        w[i] = (unsign32)(unsigned char)k[4 * i] | (unsign32)(unsigned char)k[4 * i + 1] << 8 |
+               (unsign32)(unsigned char)k[4 * i + 2] << 16 | (unsign32)(unsigned char)k[4 * i + 3] << 24;
+    for (i = nk; i < n; i++)
+    {
+        t = w[i - 1];
+        if (i % nk == 0)
+        {
+            /* RotWord moves byte 0 to the top, a right rotation of the packed word */
+            t = AES_subword(t);
+            t = ((t >> 8) | (t << 24)) ^ RCON[i / nk - 1];
+        }
+        else if (nk == 8 && i % nk == 4)
+            t = AES_subword(t);
+        w[i] = w[i - nk] ^ t;
+    }
+}
+
+/* The equivalent inverse cipher schedule d of the nr-round encryption schedule e */
+AESNI_TARGET static void AES_invert(unsign32 *d, const unsign32 *e, int nr)
+{
+    __m128i k;
+
+    for (int r = 0; r <= nr; r++)
+    {
+        k = _mm_loadu_si128((const __m128i *)(e + 4 * (nr - r)));
+        if (r > 0 && r < nr) k = _mm_aesimc_si128(k);
+        _mm_storeu_si128((__m128i *)(d + 4 * r), k);
+    }
+}
+
+AESNI_TARGET static void AES_ecb_aesni(const unsign32 *key, int nr, unsigned char *b, int n, int dec)
+{
+    __m128i rk[15], x0, x1, x2, x3, x4, x5, x6, x7;
+
+    for (int r = 0; r <= nr; r++) rk[r] = _mm_loadu_si128((const __m128i *)(key + 4 * r));
+    for (; n >= 8; n -= 8, b += 8 * AES_BLOCK)
+    {
+        x0 = _mm_loadu_si128((const __m128i *)b);
+        x1 = _mm_loadu_si128((const __m128i *)(b + 16));
+        x2 = _mm_loadu_si128((const __m128i *)(b + 32));
+        x3 = _mm_loadu_si128((const __m128i *)(b + 48));
+        x4 = _mm_loadu_si128((const __m128i *)(b + 64));
+        x5 = _mm_loadu_si128((const __m128i *)(b + 80));
+        x6 = _mm_loadu_si128((const __m128i *)(b + 96));
+        x7 = _mm_loadu_si128((const __m128i *)(b + 112));
+        if (dec) AES_CIPHER8(rk, nr, _mm_aesdec_si128, _mm_aesdeclast_si128);
+        else AES_CIPHER8(rk, nr, _mm_aesenc_si128, _mm_aesenclast_si128);
+        _mm_storeu_si128((__m128i *)b, x0);
+        _mm_storeu_si128((__m128i *)(b + 16), x1);
+        _mm_storeu_si128((__m128i *)(b + 32), x2);
+        _mm_storeu_si128((__m128i *)(b + 48), x3);
+        _mm_storeu_si128((__m128i *)(b + 64), x4);
+        _mm_storeu_si128((__m128i *)(b + 80), x5);
+        _mm_storeu_si128((__m128i *)(b + 96), x6);
+        _mm_storeu_si128((__m128i *)(b + 112), x7);
+    }
+    for (; n > 0; n--, b += AES_BLOCK)
+    {
+        x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i *)b), rk[0]);
+        for (int r = 1; r < nr; r++) x0 = dec ? _mm_aesdec_si128(x0, rk[r]) : _mm_aesenc_si128(x0, rk[r]);
+        x0 = dec ? _mm_aesdeclast_si128(x0, rk[nr]) : _mm_aesenclast_si128(x0, rk[nr]);
+        _mm_storeu_si128((__m128i *)b, x0);
+    }
+}
+
+AESNI_TARGET static void AES_cbc_encrypt_aesni(const unsign32 *key, int nr, unsigned char *iv, unsigned char *b, int n)
+{
+    __m128i rk[15], x = _mm_loadu_si128((const __m128i *)iv);
+
+    for (int r = 0; r <= nr; r++) rk[r] = _mm_loadu_si128((const __m128i *)(key + 4 * r));
+    for (; n > 0; n--, b += AES_BLOCK)
+    {
+        x = _mm_xor_si128(x, _mm_loadu_si128((const __m128i *)b));
+        x = _mm_xor_si128(x, rk[0]);
+        for (int r = 1; r < nr; r++) x = _mm_aesenc_si128(x, rk[r]);
+        x = _mm_aesenclast_si128(x, rk[nr]);
+        _mm_storeu_si128((__m128i *)b, x);
+    }
+    _mm_storeu_si128((__m128i *)iv, x);
+}
+
+AESNI_TARGET static void AES_cbc_decrypt_aesni(const unsign32 *key, int nr, unsigned char *iv, unsigned char *b, int n)
+{
+    __m128i rk[15], x0, x1, x2, x3, x4, x5, x6, x7, c[8];
+    __m128i v = _mm_loadu_si128((const __m128i *)iv);
+
+    for (int r = 0; r <= nr; r++) rk[r] = _mm_loadu_si128((const __m128i *)(key + 4 * r));
+    for (; n >= 8; n -= 8, b += 8 * AES_BLOCK)
+    {
+        for (int i = 0; i < 8; i++) c[i] = _mm_loadu_si128((const __m128i *)(b + 16 * i));
+        x0 = c[0];
+        x1 = c[1];
+        x2 = c[2];
+        x3 = c[3];
+        x4 = c[4];
+        x5 = c[5];
+        x6 = c[6];
+        x7 = c[7];
+        AES_CIPHER8(rk, nr, _mm_aesdec_si128, _mm_aesdeclast_si128);
+        _mm_storeu_si128((__m128i *)b, _mm_xor_si128(x0, v));
+        _mm_storeu_si128((__m128i *)(b + 16), _mm_xor_si128(x1, c[0]));
+        _mm_storeu_si128((__m128i *)(b + 32), _mm_xor_si128(x2, c[1]));
+        _mm_storeu_si128((__m128i *)(b + 48), _mm_xor_si128(x3, c[2]));
+        _mm_storeu_si128((__m128i *)(b + 64), _mm_xor_si128(x4, c[3]));
+        _mm_storeu_si128((__m128i *)(b + 80), _mm_xor_si128(x5, c[4]));
+        _mm_storeu_si128((__m128i *)(b + 96), _mm_xor_si128(x6, c[5]));
+        _mm_storeu_si128((__m128i *)(b + 112), _mm_xor_si128(x7, c[6]));
+        v = c[7];
+    }
+    for (; n > 0; n--, b += AES_BLOCK)
+    {
+        c[0] = _mm_loadu_si128((const __m128i *)b);
+        x0 = _mm_xor_si128(c[0], rk[0]);
+        for (int r = 1; r < nr; r++) x0 = _mm_aesdec_si128(x0, rk[r]);
+        x0 = _mm_aesdeclast_si128(x0, rk[nr]);
+        _mm_storeu_si128((__m128i *)b, _mm_xor_si128(x0, v));
+        v = c[0];
+    }
+    _mm_storeu_si128((__m128i *)iv, v);
+}
+
+/* n whole blocks of counter mode from counter block ctr, which is advanced */
+AESNI_TARGET static void AES_ctr_aesni(const unsign32 *key, int nr, unsigned char *ctr, unsigned char *out, const unsigned char *in, int n)
+{
+    const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i rk[15], x0, x1, x2, x3, x4, x5, x6, x7;
+    __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)ctr), rev);
+
+    for (int r = 0; r <= nr; r++) rk[r] = _mm_loadu_si128((const __m128i *)(key + 4 * r));
+    for (; n >= 8; n -= 8, in += 8 * AES_BLOCK, out += 8 * AES_BLOCK)
+    {
+        x0 = _mm_shuffle_epi8(c, rev);
+        x1 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 1)), rev);
+        x2 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 2)), rev);
+        x3 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 3)), rev);
+        x4 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 4)), rev);
+        x5 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 5)), rev);
+        x6 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 6)), rev);
+        x7 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 7)), rev);
+        c = _mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 8));
+        AES_CIPHER8(rk, nr, _mm_aesenc_si128, _mm_aesenclast_si128);
+        _mm_storeu_si128((__m128i *)out, _mm_xor_si128(x0, _mm_loadu_si128((const __m128i *)in)));
+        _mm_storeu_si128((__m128i *)(out + 16), _mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)(in + 16))));
+        _mm_storeu_si128((__m128i *)(out + 32), _mm_xor_si128(x2, _mm_loadu_si128((const __m128i *)(in + 32))));
+        _mm_storeu_si128((__m128i *)(out + 48), _mm_xor_si128(x3, _mm_loadu_si128((const __m128i *)(in + 48))));
+        _mm_storeu_si128((__m128i *)(out + 64), _mm_xor_si128(x4, _mm_loadu_si128((const __m128i *)(in + 64))));
+        _mm_storeu_si128((__m128i *)(out + 80), _mm_xor_si128(x5, _mm_loadu_si128((const __m128i *)(in + 80))));
+        _mm_storeu_si128((__m128i *)(out + 96), _mm_xor_si128(x6, _mm_loadu_si128((const __m128i *)(in + 96))));
+        _mm_storeu_si128((__m128i *)(out + 112), _mm_xor_si128(x7, _mm_loadu_si128((const __m128i *)(in + 112))));
+    }
+    for (; n > 0; n--, in += AES_BLOCK, out += AES_BLOCK)
+    {
+        x0 = _mm_xor_si128(_mm_shuffle_epi8(c, rev), rk[0]);
+        c = _mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 1));
+        for (int r = 1; r < nr; r++) x0 = _mm_aesenc_si128(x0, rk[r]);
+        x0 = _mm_aesenclast_si128(x0, rk[nr]);
+        _mm_storeu_si128((__m128i *)out, _mm_xor_si128(x0, _mm_loadu_si128((const __m128i *)in)));
+    }
+    _mm_storeu_si128((__m128i *)ctr, _mm_shuffle_epi8(c, rev));
+}
+
+VAES_TARGET static void AES_ecb_vaes(const unsign32 *key, int nr, unsigned char *b, int n, int dec)
+{
+    __m512i rk[15], y0, y1, y2, y3;
+    int m = n & ~15;
+
+    for (int r = 0; r <= nr; r++) rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(key + 4 * r)));
+    for (int i = 0; i < m; i += 16)
+    {
+        y0 = _mm512_loadu_si512(b + 16 * i);
+        y1 = _mm512_loadu_si512(b + 16 * i + 64);
+        y2 = _mm512_loadu_si512(b + 16 * i + 128);
+        y3 = _mm512_loadu_si512(b + 16 * i + 192);
+        if (dec) AES_CIPHER16(rk, nr, _mm512_aesdec_epi128, _mm512_aesdeclast_epi128);
+        else AES_CIPHER16(rk, nr, _mm512_aesenc_epi128, _mm512_aesenclast_epi128);
+        _mm512_storeu_si512(b + 16 * i, y0);
+        _mm512_storeu_si512(b + 16 * i + 64, y1);
+        _mm512_storeu_si512(b + 16 * i + 128, y2);
+        _mm512_storeu_si512(b + 16 * i + 192, y3);
+    }
+    if (m < n) AES_ecb_aesni(key, nr, b + 16 * m, n - m, dec);
+}
+
+VAES_TARGET static void AES_cbc_decrypt_vaes(const unsign32 *key, int nr, unsigned char *iv, unsigned char *b, int n)
+{
+    __m512i rk[15], y0, y1, y2, y3, c0, c1, c2, c3;
+    __m512i last = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)iv));
+    int m = n & ~15;
+
+    if (m == 0)
+    {
+        AES_cbc_decrypt_aesni(key, nr, iv, b, n);
+        return;
+    }
+    for (int r = 0; r <= nr; r++) rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(key + 4 * r)));
+    for (int i = 0; i < m; i += 16)
+    {
+        y0 = c0 = _mm512_loadu_si512(b + 16 * i);
+        y1 = c1 = _mm512_loadu_si512(b + 16 * i + 64);
+        y2 = c2 = _mm512_loadu_si512(b + 16 * i + 128);
+        y3 = c3 = _mm512_loadu_si512(b + 16 * i + 192);
+        AES_CIPHER16(rk, nr, _mm512_aesdec_epi128, _mm512_aesdeclast_epi128);
+        /* Each block is XORed with the ciphertext one block back: shift the blocks up one lane */
+        _mm512_storeu_si512(b + 16 * i, _mm512_xor_si512(y0, _mm512_alignr_epi64(c0, last, 6)));
+        _mm512_storeu_si512(b + 16 * i + 64, _mm512_xor_si512(y1, _mm512_alignr_epi64(c1, c0, 6)));
+        _mm512_storeu_si512(b + 16 * i + 128, _mm512_xor_si512(y2, _mm512_alignr_epi64(c2, c1, 6)));
+        _mm512_storeu_si512(b + 16 * i + 192, _mm512_xor_si512(y3, _mm512_alignr_epi64(c3, c2, 6)));
+        last = c3;
+    }
+    _mm_storeu_si128((__m128i *)iv, _mm512_extracti32x4_epi32(last, 3));
+    if (m < n) AES_cbc_decrypt_aesni(key, nr, iv, b + 16 * m, n - m);
+}
+
+VAES_TARGET static void AES_ctr_vaes(const unsign32 *key, int nr, unsigned char *ctr, unsigned char *out, const unsigned char *in, int n)
+{
+    const __m512i rev = _mm512_broadcast_i32x4(_mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i four = _mm512_set_epi32(0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 4);
+    __m512i rk[15], y0, y1, y2, y3, c;
+    int m = n & ~15;
+
+    if (m == 0)
+    {
+        AES_ctr_aesni(key, nr, ctr, out, in, n);
+        return;
+    }
+    /* Lane j of c holds counter + j, byte-reversed */
+    c = _mm512_shuffle_epi8(_mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)ctr)), rev);
+    c = _mm512_add_epi32(c, _mm512_set_epi32(0, 0, 0, 3, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0));
+    for (int r = 0; r <= nr; r++) rk[r] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(key + 4 * r)));
+    for (int i = 0; i < m; i += 16)
+    {
+        y0 = _mm512_shuffle_epi8(c, rev);
+        c = _mm512_add_epi32(c, four);
+        y1 = _mm512_shuffle_epi8(c, rev);
+        c = _mm512_add_epi32(c, four);
+        y2 = _mm512_shuffle_epi8(c, rev);
+        c = _mm512_add_epi32(c, four);
+        y3 = _mm512_shuffle_epi8(c, rev);
+        c = _mm512_add_epi32(c, four);
+        AES_CIPHER16(rk, nr, _mm512_aesenc_epi128, _mm512_aesenclast_epi128);
+        _mm512_storeu_si512(out + 16 * i, _mm512_xor_si512(y0, _mm512_loadu_si512(in + 16 * i)));
+        _mm512_storeu_si512(out + 16 * i + 64, _mm512_xor_si512(y1, _mm512_loadu_si512(in + 16 * i + 64)));
+        _mm512_storeu_si512(out + 16 * i + 128, _mm512_xor_si512(y2, _mm512_loadu_si512(in + 16 * i + 128)));
+        _mm512_storeu_si512(out + 16 * i + 192, _mm512_xor_si512(y3, _mm512_loadu_si512(in + 16 * i + 192)));
+    }
+    _mm_storeu_si128((__m128i *)ctr, _mm_shuffle_epi8(_mm512_castsi512_si128(c), _mm512_castsi512_si128(rev)));
+    if (m < n) AES_ctr_aesni(key, nr, ctr, out + 16 * m, in + 16 * m, n - m);
+}
+
+#endif
+
+int AES_simd(int max)
+{
+    int k = AES_SIMD_NONE;
+
+#ifdef AES_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1"))
+    {
+        if (max >= AES_SIMD_VAES && __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512bw"))
+            k = AES_SIMD_VAES;
+        else if (max >= AES_SIMD_AESNI)
+            k = AES_SIMD_AESNI;
+    }
+#else
+    (void)max;
+#endif
+    return DISPATCH_set(&AES_active, k);
+}
+
+int AES_simd_active(void)
+{
+    return DISPATCH_get(&AES_active, AES_simd, AES_SIMD_VAES);
+}
+
+int AES_init_encrypt(core_aes *A, int m, int n, char *k, char *iv)
+{
+    if (n != 16 && n != 24 && n != 32) return 0;
+#ifdef AES_X86
+    if (AES_simd_active() != AES_SIMD_NONE)
+    {
+        A->Nk = n / 4;
+        A->Nr = 6 + n / 4;
+        AES_reset(A, m, iv);
+        AES_expand(A->fkey, n / 4, k);
+        memset(A->rkey, 0, sizeof(A->rkey));
+        return 1;
+    }
+#endif
+    if (!AES_init(A, m, n, k, iv)) return 0;
+    memset(A->rkey, 0, sizeof(A->rkey));
+    return 1;
+}
+
+int AES_init_decrypt(core_aes *A, int m, int n, char *k, char *iv)
+{
+    if (n != 16 && n != 24 && n != 32) return 0;
+#ifdef AES_X86
+    if (AES_simd_active() != AES_SIMD_NONE)
+    {
+        unsign32 e[60];
+
+        A->Nk = n / 4;
+        A->Nr = 6 + n / 4;
+        AES_reset(A, m, iv);
+        AES_expand(e, n / 4, k);
+        AES_invert(A->rkey, e, A->Nr);
+        memset(A->fkey, 0, sizeof(A->fkey));
+        memset(e, 0, sizeof(e));
+        return 1;
+    }
+#endif
+    if (!AES_init(A, m, n, k, iv)) return 0;
+    memset(A->fkey, 0, sizeof(A->fkey));
+    return 1;
+}
+
+void AES_ecb_encrypt_blocks(core_aes *A, uchar *b, int n)
+{
+    switch (AES_simd_active())
+    {
+#ifdef AES_X86
+    case AES_SIMD_VAES:
+        AES_ecb_vaes(A->fkey, A->Nr, b, n, 0);
+        return;
+    case AES_SIMD_AESNI:
+        AES_ecb_aesni(A->fkey, A->Nr, b, n, 0);
+        return;
+#endif
+    default:
+        for (int i = 0; i < n; i++) AES_ecb_encrypt(A, b + AES_BLOCK * i);
+    }
+}
+
+void AES_ecb_decrypt_blocks(core_aes *A, uchar *b, int n)
+{
+    switch (AES_simd_active())
+    {
+#ifdef AES_X86
+    case AES_SIMD_VAES:
+        AES_ecb_vaes(A->rkey, A->Nr, b, n, 1);
+        return;
+    case AES_SIMD_AESNI:
+        AES_ecb_aesni(A->rkey, A->Nr, b, n, 1);
+        return;
+#endif
+    default:
+        for (int i = 0; i < n; i++) AES_ecb_decrypt(A, b + AES_BLOCK * i);
+    }
+}
+
+void AES_cbc_encrypt_blocks(core_aes *A, char *b, int n)
+{
+    unsigned char *f = (unsigned char *)A->f, *p = (unsigned char *)b;
+
+#ifdef AES_X86
+    if (AES_simd_active() != AES_SIMD_NONE)
+    {
+        AES_cbc_encrypt_aesni(A->fkey, A->Nr, f, p, n);
+        return;
+    }
+#endif
+    for (; n > 0; n--, p += AES_BLOCK)
+    {
+        for (int i = 0; i < AES_BLOCK; i++) p[i] ^= f[i];
+        AES_ecb_encrypt(A, p);
+        memcpy(f, p, AES_BLOCK);
+    }
+}
+
+void AES_cbc_decrypt_blocks(core_aes *A, char *b, int n)
+{
+    unsigned char c[AES_BLOCK], *f = (unsigned char *)A->f, *p = (unsigned char *)b;
+
+    switch (AES_simd_active())
+    {
+#ifdef AES_X86
+    case AES_SIMD_VAES:
+        AES_cbc_decrypt_vaes(A->rkey, A->Nr, f, p, n);
+        return;
+    case AES_SIMD_AESNI:
+        AES_cbc_decrypt_aesni(A->rkey, A->Nr, f, p, n);
+        return;
+#endif
+    default:
+        for (; n > 0; n--, p += AES_BLOCK)
+        {
+            memcpy(c, p, AES_BLOCK);
+            AES_ecb_decrypt(A, p);
+            for (int i = 0; i < AES_BLOCK; i++) p[i] ^= f[i];
+            memcpy(f, c, AES_BLOCK);
+        }
+    }
+}
+
+void AES_ctr32_xor(core_aes *A, char *out, char *in, int len)
+{
+    unsigned char k[AES_BLOCK], *f = (unsigned char *)A->f;
+    int i, r = len % AES_BLOCK;
+
+    switch (AES_simd_active())
+    {
+#ifdef AES_X86
+    case AES_SIMD_VAES:
+        AES_ctr_vaes(A->fkey, A->Nr, f, (unsigned char *)out, (const unsigned char *)in, len / AES_BLOCK);
+        break;
+    case AES_SIMD_AESNI:
+        AES_ctr_aesni(A->fkey, A->Nr, f, (unsigned char *)out, (const unsigned char *)in, len / AES_BLOCK);
+        break;
+#endif
+    default:
+        r = len;
+    }
+
+    /* The portable path, and the partial final block of the others, on the same kernel */
+    for (i = len - r; i < len; i += AES_BLOCK)
+    {
+        memcpy(k, f, AES_BLOCK);
+        AES_ecb_encrypt_blocks(A, k, 1);
+        for (int j = 0; j < AES_BLOCK && i + j < len; j++) out[i + j] = (char)(in[i + j] ^ k[j]);
+        for (int j = AES_BLOCK - 1; j >= AES_BLOCK - 4; j--)
+            if (++f[j] != 0) break;
+    }
+    memset(k, 0, sizeof(k));
+}
+
+void AES_CBC_IV0_ENCRYPT_bulk(octet *K, octet *P, octet *C)
+{
+    core_aes a;
+    char b[AES_CHUNK * AES_BLOCK];
+    int m, n, pad, ipt = 0, last = 0;
+
+    C->len = 0;
+    AES_init_encrypt(&a, CBC, K->len, K->val, NULL);
+    /* Whole chunks, then the rest with the padding, a whole block of it if the rest is empty */
+    while (!last)
+    {
+        m = P->len - ipt;
+        if (m >= (int)sizeof(b))
+        {
+            m = (int)sizeof(b);
+            n = AES_CHUNK;
+        }
+        else
+        {
+            n = m / AES_BLOCK + 1;
+            pad = n * AES_BLOCK - m;
+            memset(b + m, pad, (size_t)pad);
+            last = 1;
+        }
+        memcpy(b, P->val + ipt, (size_t)m);
+        ipt += m;
+        AES_cbc_encrypt_blocks(&a, b, n);
+        m = C->max - C->len < n * AES_BLOCK ? C->max - C->len : n * AES_BLOCK;
+        memcpy(C->val + C->len, b, (size_t)m);
+        C->len += m;
+    }
+    AES_end(&a);
+    memset(b, 0, sizeof(b));
+}
+
+int AES_CBC_IV0_DECRYPT_bulk(octet *K, octet *C, octet *P)
+{
+    core_aes a;
+    char b[AES_CHUNK * AES_BLOCK];
+    int i, m, n, pad, bad, opt = 0, ipt = 0;
+
+    P->len = 0;
+    if (C->len == 0 || C->len % AES_BLOCK != 0) return 0;
+    AES_init_decrypt(&a, CBC, K->len, K->val, NULL);
+    for (;;)
+    {
+        n = (C->len - ipt) / AES_BLOCK;
+        if (n > AES_CHUNK) n = AES_CHUNK;
+        memcpy(b, C->val + ipt, (size_t)(n * AES_BLOCK));
+        ipt += n * AES_BLOCK;
+        AES_cbc_decrypt_blocks(&a, b, n);
+        if (ipt == C->len) break;
+        m = P->max - opt < n * AES_BLOCK ? P->max - opt : n * AES_BLOCK;
+        memcpy(P->val + opt, b, (size_t)m);
+        opt += m;
+    }
+    AES_end(&a);
+
+    /* The last block of b ends in pad bytes of value pad */
+    m = (n - 1) * AES_BLOCK;
+    pad = (unsigned char)b[m + AES_BLOCK - 1];
+    bad = pad < 1 || pad > AES_BLOCK;
+    for (i = 0; i < AES_BLOCK; i++)
+        bad |= i >= AES_BLOCK - pad && (unsigned char)b[m + i] != pad;
+    if (!bad)
+    {
+        m = n * AES_BLOCK - pad;
+        if (m > P->max - opt) m = P->max - opt;
+        memcpy(P->val + opt, b, (size_t)m);
+        opt += m;
+    }
+    memset(b, 0, sizeof(b));
+    if (bad)
+    {
+        memset(P->val, 0, (size_t)opt);
+        return 0;
+    }
+    P->len = opt;
+    return 1;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file aes.h
+ * @brief Bulk AES on MIRACL Core's core_aes state, with AES-NI and VAES
+ *
+ * AES_ecb_encrypt and AES_ecb_decrypt take one block per call and run it
+ * through lookup tables indexed by key and data bytes, so their cache
+ * footprint depends on both. The functions here take many blocks per call
+ * on the same core_aes state, and on a CPU with AES-NI run the rounds in
+ * hardware, in constant time. Where the blocks are independent, in ECB,
+ * CTR and CBC decryption, eight are interleaved so that each round
+ * instruction is issued while the previous ones are still in flight; with
+ * VAES on AVX-512, four blocks share a register and sixteen are in flight.
+ * CBC encryption is serial, one block after another.
+ *
+ * AES_init expands both key schedules, though every mode but ECB and CBC
+ * decryption needs only the encryption one. AES_init_encrypt and
+ * AES_init_decrypt expand just the one the caller will use, with the
+ * AES-NI key-assist instruction when the CPU has it.
+ *
+ * The schedules are as core_aes holds them: fkey packs the bytes of each
+ * round key word little-endian, and rkey holds the keys of the equivalent
+ * inverse cipher, last round first. Output is the same as from the
+ * block-at-a-time functions. The kernel is chosen at run time; without
+ * AES-NI, or built with -DAES_NOSIMD (make NOSIMD=1), blocks go through
+ * AES_ecb_encrypt and AES_ecb_decrypt.
+ */
+
+#ifndef AES_H
+#define AES_H
+
+#include "core.h"
+
+#define AES_BLOCK 16         /**< AES block size in bytes */
+
+#define AES_SIMD_NONE 0      /**< MIRACL's table-driven AES, a block at a time */
+#define AES_SIMD_AESNI 1     /**< AES-NI, eight blocks interleaved */
+#define AES_SIMD_VAES 2      /**< VAES on AVX-512, sixteen blocks interleaved */
+
+/**	@brief Selects the fastest AES kernel the CPU has, up to a limit
+ *
+	The choice is made automatically, and thread-safely, on first use; this
+	overrides it, for comparing the kernels. All use the same key schedules
+	and give the same output, so encryption in other threads stays correct
+	across the switch.
+	@param max the fastest kernel allowed, AES_SIMD_NONE, _AESNI or _VAES
+	@return the kernel now in use
+ */
+extern int AES_simd(int max);
+/**	@brief Tests which AES kernel is in use
+ *
+	@return AES_SIMD_NONE, AES_SIMD_AESNI or AES_SIMD_VAES
+ */
+extern int AES_simd_active(void);
+/**	@brief Initialise an instance of CORE_AES for encryption only
+ *
+	As AES_init, but only fkey is expanded and rkey is zero, so the instance
+	serves every mode except ECB and CBC decryption.
+	@param A an instance CORE_AES
+	@param m is the active mode of operation (ECB, CBC, OFB, CFB etc)
+	@param n is the key length in bytes, 16, 24 or 32
+	@param k the AES key
+	@param iv the Initialisation Vector
+	@return 0 for invalid n
+ */
+extern int AES_init_encrypt(core_aes *A, int m, int n, char *k, char *iv);
+/**	@brief Initialise an instance of CORE_AES for ECB or CBC decryption only
+ *
+	As AES_init, but only rkey is expanded and fkey is zero.
+	@param A an instance CORE_AES
+	@param m is the active mode of operation, ECB or CBC
+	@param n is the key length in bytes, 16, 24 or 32
+	@param k the AES key
+	@param iv the Initialisation Vector
+	@return 0 for invalid n
+ */
+extern int AES_init_decrypt(core_aes *A, int m, int n, char *k, char *iv);
+/**	@brief Encrypt 16 byte blocks in ECB mode
+ *
+	Same as AES_ecb_encrypt on each block in turn.
+	@param A an instance of the CORE_AES
+	@param b is an array of n blocks of plaintext, on exit ciphertext
+	@param n the number of blocks
+ */
+extern void AES_ecb_encrypt_blocks(core_aes *A, uchar *b, int n);
+/**	@brief Decrypt 16 byte blocks in ECB mode
+ *
+	Same as AES_ecb_decrypt on each block in turn.
+	@param A an instance of the CORE_AES
+	@param b is an array of n blocks of ciphertext, on exit plaintext
+	@param n the number of blocks
+ */
+extern void AES_ecb_decrypt_blocks(core_aes *A, uchar *b, int n);
+/**	@brief Encrypt 16 byte blocks in CBC mode
+ *
+	Same as AES_encrypt in CBC mode on each block in turn: the chaining
+	vector is read from and left in A.
+	@param A an instance of the CORE_AES
+	@param b is an array of n blocks of plaintext, on exit ciphertext
+	@param n the number of blocks
+ */
+extern void AES_cbc_encrypt_blocks(core_aes *A, char *b, int n);
+/**	@brief Decrypt 16 byte blocks in CBC mode
+ *
+	Same as AES_decrypt in CBC mode on each block in turn.
+	@param A an instance of the CORE_AES
+	@param b is an array of n blocks of ciphertext, on exit plaintext
+	@param n the number of blocks
+ */
+extern void AES_cbc_decrypt_blocks(core_aes *A, char *b, int n);
+/**	@brief Encrypt or decrypt in counter mode with a 32-bit counter
+ *
+	Block i of keystream is the encryption of the counter block, the 16
+	bytes of A's chaining vector, whose last four bytes are a big-endian
+	counter incremented modulo 2^32 after each block, as in GCM. A partial
+	final block uses up a whole counter value.
+	@param A an instance of the CORE_AES
+	@param out the output bytes, which may be the same as in
+	@param in the input bytes
+	@param len the number of bytes
+ */
+extern void AES_ctr32_xor(core_aes *A, char *out, char *in, int len);
+/**	@brief AES encrypts a plaintext to a ciphtertext
+ *
+	Same output as AES_CBC_IV0_ENCRYPT, as used by ECIES.
+	@param K AES key
+	@param P input plaintext octet
+	@param C output ciphertext octet
+ */
+extern void AES_CBC_IV0_ENCRYPT_bulk(octet *K, octet *P, octet *C);
+/**	@brief AES decrypts a ciphertext to a plaintext
+ *
+	Same output as AES_CBC_IV0_DECRYPT, as used by ECIES, except that P
+	is left empty when the input is bad.
+	@param K AES key
+	@param C input ciphertext octet
+	@param P output plaintext octet
+	@return 0 if bad input, else 1
+ */
+extern int AES_CBC_IV0_DECRYPT_bulk(octet *K, octet *C, octet *P);
+
+#endif
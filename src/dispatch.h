@@ -0,0 +1,43 @@
+/**
+ * @file dispatch.h
+ * @brief Run-time kernel selection shared by the SIMD modules
+ *
+ * Each module keeps the level of its kernels in one int, -1 until the
+ * first call chooses it, and the kernels of every level in a const table.
+ * The level is then the only state that changes, so storing it with
+ * release and loading it with acquire is all a thread needs to see one
+ * whole set of kernels. Threads racing on first use all store the same
+ * choice.
+ */
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+/**	@brief Publishes the level a module's _simd function has chosen
+ *
+	@param level the module's level
+	@param k the level chosen
+	@return k
+ */
+static inline int DISPATCH_set(int *level, int k)
+{
+    __atomic_store_n(level, k, __ATOMIC_RELEASE);
+    return k;
+}
+
+/**	@brief Reads a module's level, choosing it on first use
+ *
+	@param level the module's level, -1 until chosen
+	@param simd the module's _simd function, which calls DISPATCH_set
+	@param max the limit simd is called with on first use
+	@return the level in use
+ */
+static inline int DISPATCH_get(int *level, int (*simd)(int), int max)
+{
+    int k = __atomic_load_n(level, __ATOMIC_ACQUIRE);
+
+    if (k < 0) k = simd(max);
+    return k;
+}
+
+#endif
@@ -0,0 +1,253 @@
+/**
+ * ecbatch_NIST256.c - Array operations on NIST256 points
+ *
+ * With a[i] = z_0.z_1...z_i, one inversion gives 1/a[n-1]. Walking back
+ * down the array, 1/z_i = a[i-1]/a[i] and 1/a[i-1] = z_i/a[i], so each
+ * point costs three multiplications to recover its own inverse.
+ */
+
+#include <stdlib.h>
+
+#include "ecbatch_NIST256.h"
+#include "fp64_NIST256.h"
+#include "fpb_NIST256.h"
+
+/* The field prime, big-endian */
+static const unsigned char ECP_NIST256_PBYTES[MODBYTES_256_56] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/* x = 1/y, by safegcd on the FP64 field if enabled, else MIRACL's exponentiation */
+static void ECP_NIST256_finv(FP_NIST256 *x, FP_NIST256 *y)
+{
+#ifdef NIST256_SAFEGCD
+    FP64_NIST256 t;
+
+    FP64_NIST256_fromFP(&t, y);
+    FP64_NIST256_inv(&t, &t);
+    FP64_NIST256_toFP(x, &t);
+#else
+    FP_NIST256_inv(x, y, NULL);
+#endif
+}
+
+void ECP_NIST256_affine_batch(int n, ECP_NIST256 P[])
+{
+    FP_NIST256 *a, inv, zi, one;
+    int i, last = -1;
+
+    if (n <= 0) return;
+    a = (FP_NIST256 *)malloc((size_t)n * sizeof(FP_NIST256));
+    if (a == NULL)
+    {
+        for (i = 0; i < n; i++) ECP_NIST256_affine(&P[i]);
+        return;
+    }
+
+    /* Running products of the z-coordinates, skipping infinity and already affine points */
+    FP_NIST256_one(&one);
+    FP_NIST256_copy(&inv, &one);
+    for (i = 0; i < n; i++)
+    {
+        if (ECP_NIST256_isinf(&P[i]) || FP_NIST256_equals(&P[i].z, &one)) continue;
+        if (last < 0) FP_NIST256_copy(&a[i], &P[i].z);
+        else FP_NIST256_mul(&a[i], &a[last], &P[i].z);
+        last = i;
+    }
+    if (last < 0)
+    {
+        free(a);
+        return;
+    }
+
+    ECP_NIST256_finv(&inv, &a[last]);
+    for (i = last; i >= 0; i--)
+    {
+        if (ECP_NIST256_isinf(&P[i]) || FP_NIST256_equals(&P[i].z, &one)) continue;
+
+        /* Find the previous point that took part in the product */
+        last = i - 1;
+        while (last >= 0 && (ECP_NIST256_isinf(&P[last]) || FP_NIST256_equals(&P[last].z, &one))) last--;
+
+        if (last >= 0)
+        {
+            FP_NIST256_mul(&zi, &inv, &a[last]);
+            FP_NIST256_mul(&inv, &inv, &P[i].z);
+        }
+        else FP_NIST256_copy(&zi, &inv);
+
+        FP_NIST256_mul(&P[i].x, &P[i].x, &zi);
+        FP_NIST256_mul(&P[i].y, &P[i].y, &zi);
+        FP_NIST256_reduce(&P[i].x);
+        FP_NIST256_reduce(&P[i].y);
+        FP_NIST256_copy(&P[i].z, &one);
+    }
+    free(a);
+}
+
+void ECP64_NIST256_affine_batch(int n, ECP64_NIST256 P[])
+{
+    FP64_NIST256 *a, inv, zi, one;
+    int i, last = -1;
+
+    if (n <= 0) return;
+    a = (FP64_NIST256 *)malloc((size_t)n * sizeof(FP64_NIST256));
+    if (a == NULL)
+    {
+        for (i = 0; i < n; i++) ECP64_NIST256_affine(&P[i]);
+        return;
+    }
+
+    FP64_NIST256_one(&one);
+    for (i = 0; i < n; i++)
+    {
+        if (ECP64_NIST256_isinf(&P[i]) || FP64_NIST256_equals(&P[i].z, &one)) continue;
+        if (last < 0) FP64_NIST256_copy(&a[i], &P[i].z);
+        else FP64_NIST256_mul(&a[i], &a[last], &P[i].z);
+        last = i;
+    }
+    if (last < 0)
+    {
+        free(a);
+        return;
+    }
+
+    FP64_NIST256_inv(&inv, &a[last]);
+    for (i = last; i >= 0; i--)
+    {
+        if (ECP64_NIST256_isinf(&P[i]) || FP64_NIST256_equals(&P[i].z, &one)) continue;
+
+        last = i - 1;
+        while (last >= 0 && (ECP64_NIST256_isinf(&P[last]) || FP64_NIST256_equals(&P[last].z, &one))) last--;
+
+        if (last >= 0)
+        {
+            FP64_NIST256_mul(&zi, &inv, &a[last]);
+            FP64_NIST256_mul(&inv, &inv, &P[i].z);
+        }
+        else FP64_NIST256_copy(&zi, &inv);
+
+        FP64_NIST256_mul(&P[i].x, &P[i].x, &zi);
+        FP64_NIST256_mul(&P[i].y, &P[i].y, &zi);
+        FP64_NIST256_copy(&P[i].z, &one);
+    }
+    free(a);
+}
+
+void ECP_NIST256_toOctet_batch(octet *S, int n, ECP_NIST256 P[], bool c)
+{
+    int len = c ? MODBYTES_256_56 + 1 : 2 * MODBYTES_256_56 + 1;
+    octet T;
+
+    S->len = 0;
+    if (n < 0 || n > S->max / len) return;
+    ECP_NIST256_affine_batch(n, P);
+
+    /* Already affine, so toOctet does no further inversion */
+    for (int i = 0; i < n; i++)
+    {
+        T.len = 0;
+        T.max = len;
+        T.val = S->val + (size_t)i * len;
+        ECP_NIST256_toOctet(&T, &P[i], c);
+    }
+    S->len = n * len;
+}
+
+/* Reads a big-endian field element, failing if it is not below p. Public data, so variable time */
+static int ECP_NIST256_getfp(FP64_NIST256 *x, const char *b)
+{
+    int i;
+
+    for (i = 0; i < MODBYTES_256_56 && (unsigned char)b[i] == ECP_NIST256_PBYTES[i]; i++);
+    if (i == MODBYTES_256_56 || (unsigned char)b[i] > ECP_NIST256_PBYTES[i]) return 0;
+    FP64_NIST256_fromBytes(x, b);
+    return 1;
+}
+
+int ECP_NIST256_fromOctet_batch(int n, ECP_NIST256 P[], octet W[], int res[])
+{
+    FP64_NIST256 *x, *y, *r, t;
+    FPB_NIST256 rb, yb;
+    ECP64_NIST256 Q;
+    int *idx, i, j, m = 0, ok = 1;
+
+    if (n <= 0) return 1;
+    x = (FP64_NIST256 *)malloc((size_t)n * (3 * sizeof(FP64_NIST256) + sizeof(int)));
+    if (x == NULL)
+    {
+        for (i = 0; i < n; i++)
+        {
+            res[i] = ECP_NIST256_fromOctet(&P[i], &W[i]);
+            ok &= res[i];
+        }
+        return ok;
+    }
+    y = x + n;
+    r = y + n;
+    idx = (int *)(r + n);
+
+    /* Parse, and check uncompressed points against the curve; collect the compressed ones */
+    for (i = 0; i < n; i++)
+    {
+        int typ = W[i].len > 0 ? W[i].val[0] : -1;
+
+        res[i] = 0;
+        if (typ == 0x04 && W[i].len == 2 * MODBYTES_256_56 + 1)
+        {
+            if (!ECP_NIST256_getfp(&x[i], &W[i].val[1]) || !ECP_NIST256_getfp(&y[i], &W[i].val[MODBYTES_256_56 + 1])) continue;
+            ECP64_NIST256_rhs(&r[i], &x[i]);
+            FP64_NIST256_sqr(&t, &y[i]);
+            res[i] = FP64_NIST256_equals(&t, &r[i]);
+        }
+        else if ((typ == 0x02 || typ == 0x03) && W[i].len == MODBYTES_256_56 + 1)
+        {
+            if (!ECP_NIST256_getfp(&x[i], &W[i].val[1])) continue;
+            ECP64_NIST256_rhs(&r[i], &x[i]);
+            idx[m++] = i;
+        }
+    }
+
+    /* Square roots of the right hand sides, eight lanes at a time where that is faster */
+    if (FPB_NIST256_simd_active())
+    {
+        for (i = 0; i < m; i += FPB_NIST256_LANES)
+        {
+            /* A short final group repeats its last value in the spare lanes */
+            for (j = 0; j < FPB_NIST256_LANES; j++) FPB_NIST256_set(&rb, j, &r[idx[i + j < m ? i + j : m - 1]]);
+            FPB_NIST256_sqrt(&yb, &rb);
+            for (j = 0; j < FPB_NIST256_LANES && i + j < m; j++) FPB_NIST256_get(&y[idx[i + j]], &yb, j);
+        }
+    }
+    else
+    {
+        for (i = 0; i < m; i++) FP64_NIST256_sqrt(&y[idx[i]], &r[idx[i]]);
+    }
+
+    /* Keep the roots that square back, with the parity the prefix asks for */
+    for (i = 0; i < m; i++)
+    {
+        j = idx[i];
+        FP64_NIST256_sqr(&t, &y[j]);
+        res[j] = FP64_NIST256_equals(&t, &r[j]);
+        if (FP64_NIST256_parity(&y[j]) != (W[j].val[0] & 1)) FP64_NIST256_neg(&y[j], &y[j]);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (res[i])
+        {
+            FP64_NIST256_copy(&Q.x, &x[i]);
+            FP64_NIST256_copy(&Q.y, &y[i]);
+            FP64_NIST256_one(&Q.z);
+            ECP64_NIST256_toECP(&P[i], &Q);
+        }
+        else ECP_NIST256_inf(&P[i]);
+        ok &= res[i];
+    }
+
+    free(x);
+    return ok;
+}
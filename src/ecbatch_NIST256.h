@@ -0,0 +1,67 @@
+/**
+ * @file ecbatch_NIST256.h
+ * @brief Array operations on NIST256 points
+ *
+ * ECP_NIST256_affine pays one field inversion per point. Montgomery's
+ * simultaneous-inversion trick replaces n inversions with one inversion
+ * and 3(n-1) multiplications, which matters whenever many points are
+ * normalised or serialised together: fresh ephemeral keys, precomputed
+ * tables, batches of public keys.
+ */
+
+#ifndef ECBATCH_NIST256_H
+#define ECBATCH_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+#include "fp_NIST256.h"
+#include "ecp_NIST256.h"
+#include "ecp64_NIST256.h"
+
+/**	@brief Converts n ECPs from Projective to affine coordinates
+ *
+	Same result as calling ECP_NIST256_affine on each point, with a single
+	FP_NIST256_inv for the whole array. Points at infinity are left as they are.
+	@param n the number of points
+	@param P array of n ECP instances to be converted to affine form
+ */
+extern void ECP_NIST256_affine_batch(int n, ECP_NIST256 P[]);
+
+/**	@brief Converts n ECP64s from Projective to affine coordinates
+ *
+	Same result as calling ECP64_NIST256_affine on each point, with a single
+	FP64_NIST256_inv for the whole array. Points at infinity are left as they are.
+	@param n the number of points
+	@param P array of n ECP64 instances to be converted to affine form
+ */
+extern void ECP64_NIST256_affine_batch(int n, ECP64_NIST256 P[]);
+
+/**	@brief Formats n ECPs as octet strings, one after another in a single buffer
+ *
+	The points are first normalised in place with ECP_NIST256_affine_batch,
+	then point i is written at S->val + i*len, where len is MODBYTES_256_56+1 if
+	compressed, else 2*MODBYTES_256_56+1. Each encoding is byte-for-byte the one
+	ECP_NIST256_toOctet produces.
+	@param S output octet; on exit S->len = n*len, or 0 if S->max is less
+	@param n the number of points
+	@param P array of n ECP instances, normalised to affine on exit if S->len > 0
+	@param c true for compression
+ */
+extern void ECP_NIST256_toOctet_batch(octet *S, int n, ECP_NIST256 P[], bool c);
+
+/**	@brief Creates n ECPs from octet strings, validating each
+ *
+	Accepts the forms ECP_NIST256_fromOctet does: 0x04|x|y, and 0x02|x or
+	0x03|x compressed. Coordinates must be below p and the point on the
+	curve. The compressed y-coordinates come from FP64_NIST256_sqrt, an
+	addition chain for the P-256 prime, run eight at a time on
+	FPB_NIST256 lanes when the IFMA kernels are in use.
+	@param n the number of points
+	@param P array of n ECP instances, on exit P[i] is the point in W[i], or infinity if W[i] is invalid
+	@param W array of n input octet strings
+	@param res array of n outputs, 1 if W[i] is a valid point, else 0
+	@return 1 if every octet string is a valid point, else 0
+ */
+extern int ECP_NIST256_fromOctet_batch(int n, ECP_NIST256 P[], octet W[], int res[]);
+
+#endif
@@ -0,0 +1,719 @@
+/**
+ * ecc_NIST256.c - Fast paths for NIST256 ECDH/ECDSA
+ *
+ * Follows IEEE-1363 exactly as MIRACL Core's ecdh_NIST256.c does, so the
+ * results are bit-for-bit the same for the same inputs and RNG state.
+ */
+
+#include <stdlib.h>
+
+#include "ecc_NIST256.h"
+#include "ecgen_NIST256.h"
+#include "ecpb_NIST256.h"
+#include "fr64_NIST256.h"
+#include "hashb256.h"
+#include "hash512.h"
+
+/* Read a signature component, keeping the low MODBYTES bytes as ECP_NIST256_VP_DSA does */
+static void ECC_NIST256_frombytes(BIG_256_56 x, octet *O)
+{
+    if (O->len > MODBYTES_256_56)
+        BIG_256_56_fromBytes(x, O->val + O->len - MODBYTES_256_56);
+    else
+        BIG_256_56_fromBytesLen(x, O->val, O->len);
+}
+
+/* Same value, and the same RNG bytes consumed, as BIG_256_56_randomnum(x, r, RNG). That reads
+   2*256 bits, each byte least significant bit first, into a number most significant bit first;
+   reversing each byte gives the number as big-endian bytes, reduced here without a division */
+static void ECC_NIST256_randomnum(FR64_NIST256 *x, csprng *RNG)
+{
+    char b[2 * MODBYTES_256_56];
+
+    for (int i = 0; i < 2 * MODBYTES_256_56; i++)
+    {
+        unsigned int v = (unsigned int)RAND_byte(RNG) & 0xff;
+        v = ((v & 0x0f) << 4) | ((v & 0xf0) >> 4);
+        v = ((v & 0x33) << 2) | ((v & 0xcc) >> 2);
+        v = ((v & 0x55) << 1) | ((v & 0xaa) >> 1);
+        b[i] = (char)v;
+    }
+    FR64_NIST256_fromBytesLen(x, b, 2 * MODBYTES_256_56);
+    for (int i = 0; i < 2 * MODBYTES_256_56; i++) b[i] = 0;
+}
+
+/* Leftmost MODBYTES bytes of the message hash, as an integer mod r */
+static void ECC_NIST256_hashit(int hlen, FR64_NIST256 *f, octet *M)
+{
+    char h[128];
+    octet H = {0, sizeof(h), h};
+    hash256 sh;
+    hash512c sh5;
+    int blen;
+
+    if (hlen == SHA256)
+    {
+        HASH256_init(&sh);
+        HASH256_update(&sh, M->val, M->len);
+        HASH256_hash(&sh, H.val);
+        H.len = SHA256;
+    }
+    else if (hlen == SHA384 || hlen == SHA512)
+    {
+        if (hlen == SHA384) HASH384C_init(&sh5);
+        else HASH512C_init(&sh5);
+        HASH512C_update(&sh5, M->val, M->len);
+        HASH512C_hash(&sh5, H.val);
+        H.len = hlen;
+    }
+    else SPhash(MC_SHA2, hlen, &H, M);
+    blen = H.len;
+    if (H.len > MODBYTES_256_56) blen = MODBYTES_256_56;
+    FR64_NIST256_fromBytesLen(f, H.val, blen);
+}
+
+/* Test x(P) mod r == c without converting P to affine: X == c.Z, or X == (c+r).Z if c+r < p */
+static int ECC_NIST256_xcheck(const ECP64_NIST256 *P, BIG_256_56 c)
+{
+    BIG_256_56 x, r, q;
+    FP64_NIST256 cx;
+    char b[MODBYTES_256_56];
+
+    BIG_256_56_toBytes(b, c);
+    FP64_NIST256_fromBytes(&cx, b);
+    if (ECP64_NIST256_xequals(P, &cx)) return 1;
+
+    BIG_256_56_rcopy(r, CURVE_Order_NIST256);
+    BIG_256_56_rcopy(q, Modulus_NIST256);
+    BIG_256_56_add(x, c, r);
+    BIG_256_56_norm(x);
+    if (BIG_256_56_comp(x, q) >= 0) return 0;
+
+    BIG_256_56_toBytes(b, x);
+    FP64_NIST256_fromBytes(&cx, b);
+    return ECP64_NIST256_xequals(P, &cx);
+}
+
+#define ECC_NIST256_GWINDOW 4  /* wNAF window for G, served by the odd entries of ECP_NIST256_GTAB[0] */
+#define ECC_NIST256_BWINDOW 5  /* wNAF window for a public key seen only once */
+
+/* Width-w NAF of e, least significant digit first. Variable time - public data only */
+static int ECC_NIST256_wnaf(sign8 *naf, BIG_256_56 e, int w)
+{
+    BIG_256_56 k;
+    int d, len = 0;
+
+    BIG_256_56_copy(k, e);
+    BIG_256_56_norm(k);
+    while (!BIG_256_56_iszilch(k))
+    {
+        d = 0;
+        if (BIG_256_56_parity(k))
+        {
+            d = BIG_256_56_lastbits(k, w);
+            if (d >= (1 << (w - 1))) d -= (1 << w);
+            if (d > 0) BIG_256_56_dec(k, d);
+            else BIG_256_56_inc(k, -d);
+            BIG_256_56_norm(k);
+        }
+        naf[len++] = (sign8)d;
+        BIG_256_56_fshr(k, 1);
+    }
+    return len;
+}
+
+/* T[i] = (2i+1).W for 0 <= i < n */
+static void ECC_NIST256_odd_multiples(ECP64_NIST256 *T, const ECP64_NIST256 *W, int n)
+{
+    ECP64_NIST256 W2;
+
+    ECP64_NIST256_copy(&W2, W);
+    ECP64_NIST256_dbl(&W2);
+    ECP64_NIST256_copy(&T[0], W);
+    for (int i = 1; i < n; i++)
+    {
+        ECP64_NIST256_copy(&T[i], &T[i - 1]);
+        ECP64_NIST256_add(&T[i], &W2);
+    }
+}
+
+/* Add d.Q to P, where d is an odd wNAF digit and T[i] = (2i+1).Q */
+static void ECC_NIST256_addnaf(ECP64_NIST256 *P, const ECP64_NIST256 *T, int d)
+{
+    ECP64_NIST256 Q;
+
+    ECP64_NIST256_copy(&Q, &T[(d < 0 ? -d : d) / 2]);
+    if (d < 0) ECP64_NIST256_neg(&Q);
+    ECP64_NIST256_add(P, &Q);
+}
+
+/* Add d.G to P, from the odd entries (2i+1).G of the first row of the fixed-base table */
+static void ECC_NIST256_addnafg(ECP64_NIST256 *P, int d)
+{
+    ECP64_NIST256_AFFINE Q = ECP_NIST256_GTAB[0][(d < 0 ? -d : d) - 1];
+
+    if (d < 0) FP64_NIST256_neg(&Q.y, &Q.y);
+    ECP64_NIST256_add_affine(P, &Q);
+}
+
+/* R = e.W + f.G, where T holds the odd multiples of W for window w. Variable time - public data only */
+static void ECC_NIST256_mul2_vartime(ECP64_NIST256 *R, const ECP64_NIST256 *T, int w, BIG_256_56 e, BIG_256_56 f)
+{
+    sign8 ne[BIGBITS_256_56 + 1], nf[BIGBITS_256_56 + 1];
+    int le, lf, i;
+
+    le = ECC_NIST256_wnaf(ne, e, w);
+    lf = ECC_NIST256_wnaf(nf, f, ECC_NIST256_GWINDOW);
+
+    ECP64_NIST256_inf(R);
+    for (i = (le > lf ? le : lf) - 1; i >= 0; i--)
+    {
+        ECP64_NIST256_dbl(R);
+        if (i < le && ne[i] != 0) ECC_NIST256_addnaf(R, T, ne[i]);
+        if (i < lf && nf[i] != 0) ECC_NIST256_addnafg(R, nf[i]);
+    }
+}
+
+#define ECC_NIST256_DIGITS (ECGEN_NIST256_WINDOWS)  /* Signed 4-bit digits of a scalar, with the final carry */
+
+/* Signed 4-bit recoding of e, d[i] in [-8, 8], least significant digit first. Variable time - public data only */
+static void ECC_NIST256_recode(sign32 d[][FPB_NIST256_LANES], int l, BIG_256_56 e)
+{
+    char b[MODBYTES_256_56];
+    sign32 t, carry = 0;
+
+    BIG_256_56_toBytes(b, e);
+    for (int i = 0; i < ECC_NIST256_DIGITS - 1; i++)
+    {
+        t = ((b[MODBYTES_256_56 - 1 - i / 2] & 0xff) >> (4 * (i & 1))) & 0xf;
+        t += carry;
+        carry = (t + 8) >> 4;
+        d[i][l] = t - (carry << 4);
+    }
+    d[ECC_NIST256_DIGITS - 1][l] = carry;
+}
+
+/* P += d.Q lane by lane, where T[k] = (k+1).Q. Lanes with a zero digit are left alone */
+static void ECC_NIST256_addbatch(ECPB_NIST256 *P, const ECPB_NIST256 *T, const sign32 *d)
+{
+    ECPB_NIST256 A, S;
+    unsign64 nz[FPB_NIST256_LANES], any = 0;
+
+    for (int l = 0; l < FPB_NIST256_LANES; l++)
+    {
+        nz[l] = d[l] != 0 ? ~(unsign64)0 : 0;
+        any |= nz[l];
+    }
+    if (!any) return;
+
+    ECPB_NIST256_select(&A, T, d);
+    ECPB_NIST256_copy(&S, P);
+    ECPB_NIST256_add(&S, &A);
+    ECPB_NIST256_cmove(P, &S, nz);
+}
+
+/* R[l] = e[l].W[l] + f[l].G for eight lanes at once, GT[k] = (k+1).G in every lane. Variable time - public data only */
+static void ECC_NIST256_mul2_batch(ECP64_NIST256 *R, const ECP64_NIST256 *W, BIG_256_56 *e, BIG_256_56 *f, const ECPB_NIST256 *GT)
+{
+    sign32 de[ECC_NIST256_DIGITS][FPB_NIST256_LANES], df[ECC_NIST256_DIGITS][FPB_NIST256_LANES];
+    ECPB_NIST256 T[ECGEN_NIST256_ENTRIES], P;
+    int i, l;
+
+    for (l = 0; l < FPB_NIST256_LANES; l++)
+    {
+        ECPB_NIST256_set(&T[0], l, &W[l]);
+        ECC_NIST256_recode(de, l, e[l]);
+        ECC_NIST256_recode(df, l, f[l]);
+    }
+    ECPB_NIST256_copy(&T[1], &T[0]);
+    ECPB_NIST256_dbl(&T[1]);
+    for (i = 2; i < ECGEN_NIST256_ENTRIES; i++)
+    {
+        ECPB_NIST256_copy(&T[i], &T[i - 1]);
+        ECPB_NIST256_add(&T[i], &T[0]);
+    }
+
+    ECPB_NIST256_inf(&P);
+    for (i = ECC_NIST256_DIGITS - 1; i >= 0; i--)
+    {
+        if (i < ECC_NIST256_DIGITS - 1)
+            for (l = 0; l < ECGEN_NIST256_WINDOW; l++) ECPB_NIST256_dbl(&P);
+        ECC_NIST256_addbatch(&P, T, de[i]);
+        ECC_NIST256_addbatch(&P, GT, df[i]);
+    }
+
+    for (l = 0; l < FPB_NIST256_LANES; l++) ECPB_NIST256_get(&R[l], &P, l);
+}
+
+/* GT[k] = (k+1).G in every lane, from the first row of the fixed-base table */
+static void ECC_NIST256_gtab_batch(ECPB_NIST256 *GT)
+{
+    ECP64_NIST256 Q;
+
+    FP64_NIST256_one(&Q.z);
+    for (int k = 0; k < ECGEN_NIST256_ENTRIES; k++)
+    {
+        Q.x = ECP_NIST256_GTAB[0][k].x;
+        Q.y = ECP_NIST256_GTAB[0][k].y;
+        for (int l = 0; l < FPB_NIST256_LANES; l++) ECPB_NIST256_set(&GT[k], l, &Q);
+    }
+}
+
+/* Verify the signatures idx[0..m-1] eight at a time, u1 in U1[] and u2 in U2[] */
+static void ECC_NIST256_verify_batch(int m, const int *idx, const ECP64_NIST256 *WQ, BIG_256_56 *U1, BIG_256_56 *U2, BIG_256_56 *c, int *res)
+{
+    ECPB_NIST256 GT[ECGEN_NIST256_ENTRIES];
+    ECP64_NIST256 W[FPB_NIST256_LANES], R[FPB_NIST256_LANES];
+    BIG_256_56 u1[FPB_NIST256_LANES], u2[FPB_NIST256_LANES];
+
+    ECC_NIST256_gtab_batch(GT);
+    for (int j = 0; j < m; j += FPB_NIST256_LANES)
+    {
+        /* A short final group repeats its last signature in the spare lanes */
+        for (int l = 0; l < FPB_NIST256_LANES; l++)
+        {
+            int i = idx[j + l < m ? j + l : m - 1];
+            ECP64_NIST256_copy(&W[l], &WQ[i]);
+            BIG_256_56_copy(u1[l], U1[i]);
+            BIG_256_56_copy(u2[l], U2[i]);
+        }
+        ECC_NIST256_mul2_batch(R, W, u2, u1, GT);
+        for (int l = 0; l < FPB_NIST256_LANES && j + l < m; l++)
+            if (!ECC_NIST256_xcheck(&R[l], c[idx[j + l]])) res[idx[j + l]] = ECDH_ERROR;
+    }
+}
+
+int ECC_NIST256_KEY_PAIR_GENERATE(csprng *RNG, octet *S, octet *W)
+{
+    BIG_256_56 r, s;
+    ECP64_NIST256 G;
+
+    BIG_256_56_rcopy(r, CURVE_Order_NIST256);
+    if (RNG != NULL)
+    {
+        BIG_256_56_randomnum(s, r, RNG);
+    }
+    else
+    {
+        BIG_256_56_fromBytes(s, S->val);
+        BIG_256_56_mod(s, r);
+    }
+
+    S->len = EGS_NIST256;
+    BIG_256_56_toBytes(S->val, s);
+
+    /* Uncompressed, as ECP_NIST256_toOctet(W, &G, false) writes it */
+    ECP64_NIST256_mulgen(&G, s);
+    ECP64_NIST256_affine(&G);
+    W->len = 2 * EFS_NIST256 + 1;
+    W->val[0] = 0x04;
+    FP64_NIST256_toBytes(&W->val[1], &G.x);
+    FP64_NIST256_toBytes(&W->val[EFS_NIST256 + 1], &G.y);
+
+    BIG_256_56_zero(s);
+    return 0;
+}
+
+int ECC_NIST256_KEY_PAIR_GENERATE_BATCH(csprng *RNG, int n, octet *S, octet *W)
+{
+    const int wlen = 2 * EFS_NIST256 + 1;
+    BIG_256_56 *s, r;
+    ECP64_NIST256 *G;
+    FR64_NIST256 f;
+    int i;
+
+    if (n <= 0) return 0;
+    /* Bound n before multiplying, so that n * wlen cannot overflow */
+    if (n > S->max / EGS_NIST256 || n > W->max / wlen || (RNG == NULL && S->len < n * EGS_NIST256)) return ECDH_ERROR;
+
+    s = (BIG_256_56 *)malloc((size_t)n * (sizeof(BIG_256_56) + sizeof(ECP64_NIST256)));
+    if (s == NULL) return ECDH_ERROR;
+    G = (ECP64_NIST256 *)(s + n);
+
+    BIG_256_56_rcopy(r, CURVE_Order_NIST256);
+    for (i = 0; i < n; i++)
+    {
+        if (RNG != NULL)
+        {
+            ECC_NIST256_randomnum(&f, RNG);
+            FR64_NIST256_toBytes(&S->val[i * EGS_NIST256], &f);
+            BIG_256_56_fromBytes(s[i], &S->val[i * EGS_NIST256]);
+        }
+        else
+        {
+            BIG_256_56_fromBytes(s[i], &S->val[i * EGS_NIST256]);
+            BIG_256_56_mod(s[i], r);
+            BIG_256_56_toBytes(&S->val[i * EGS_NIST256], s[i]);
+        }
+    }
+    S->len = n * EGS_NIST256;
+    FR64_NIST256_zero(&f);
+
+    ECP64_NIST256_mulgen_batch(n, G, s);
+
+    /* Uncompressed, as ECP_NIST256_toOctet(W, &G, false) writes it */
+    for (i = 0; i < n; i++)
+    {
+        char *w = &W->val[i * wlen];
+        w[0] = 0x04;
+        FP64_NIST256_toBytes(&w[1], &G[i].x);
+        FP64_NIST256_toBytes(&w[EFS_NIST256 + 1], &G[i].y);
+    }
+    W->len = n * wlen;
+
+    for (i = 0; i < n; i++) BIG_256_56_zero(s[i]);
+    free(s);
+    return 0;
+}
+
+int ECC_NIST256_SP_DSA(int hlen, csprng *RNG, octet *K, octet *S, octet *F, octet *C, octet *D)
+{
+    BIG_256_56 r, u, w;
+    FR64_NIST256 s, f, c, d, k, m;
+    ECP64_NIST256 V;
+    char vx[EFS_NIST256];
+
+    ECC_NIST256_hashit(hlen, &f, F);
+
+    BIG_256_56_rcopy(r, CURVE_Order_NIST256);
+    FR64_NIST256_fromBytes(&s, S->val);
+
+    if (RNG == NULL)
+    {
+        BIG_256_56_fromBytes(u, K->val);
+        BIG_256_56_mod(u, r);
+        BIG_256_56_one(w);
+    }
+
+    do
+    {
+        if (RNG != NULL)
+        {
+            BIG_256_56_randomnum(u, r, RNG);
+            BIG_256_56_randomnum(w, r, RNG);  /* IMPORTANT - side channel masking to protect invmodp() */
+        }
+
+        ECP64_NIST256_mulgen(&V, u);
+        ECP64_NIST256_affine(&V);
+        FP64_NIST256_toBytes(vx, &V.x);
+        FR64_NIST256_fromBytes(&c, vx);
+        if (FR64_NIST256_iszilch(&c))
+        {
+            if (RNG == NULL) return ECDH_ERROR;
+            continue;
+        }
+
+        /* d = (f + s.c)/k, with k masked by w through the inversion */
+        FR64_NIST256_fromBIG(&k, u);
+        FR64_NIST256_fromBIG(&m, w);
+        FR64_NIST256_mul(&k, &k, &m);
+        FR64_NIST256_inv(&k, &k);
+        FR64_NIST256_mul(&d, &s, &c);
+        FR64_NIST256_add(&d, &f, &d);
+        FR64_NIST256_mul(&d, &d, &m);
+        FR64_NIST256_mul(&d, &k, &d);
+        if (FR64_NIST256_iszilch(&d) && RNG == NULL) return ECDH_ERROR;
+    }
+    while (FR64_NIST256_iszilch(&d));
+
+    C->len = D->len = EGS_NIST256;
+    FR64_NIST256_toBytes(C->val, &c);
+    FR64_NIST256_toBytes(D->val, &d);
+
+    FR64_NIST256_zero(&s);
+    FR64_NIST256_zero(&k);
+    FR64_NIST256_zero(&m);
+    BIG_256_56_zero(u);
+    BIG_256_56_zero(w);
+    return 0;
+}
+
+/* A nonce tuple: c = x(k.G) mod r, kinv = 1/k and u = s.c/k */
+typedef struct
+{
+    FR64_NIST256 c;
+    FR64_NIST256 kinv;
+    FR64_NIST256 u;
+} ECC_NIST256_SIGNER_TUPLE;
+
+struct ECC_NIST256_SIGNER
+{
+    ECC_NIST256_RING *Q;
+    FR64_NIST256 s;
+};
+
+/* n nonce tuples: the n products k.G share one affine conversion, and the n inverses one inversion */
+static int ECC_NIST256_SIGNER_fill(void *arg, csprng *RNG, int n, char *out)
+{
+    ECC_NIST256_SIGNER *G = (ECC_NIST256_SIGNER *)arg;
+    ECC_NIST256_SIGNER_TUPLE *T = (ECC_NIST256_SIGNER_TUPLE *)out;
+    FR64_NIST256 k[ECC_NIST256_RING_BATCH], acc[ECC_NIST256_RING_BATCH], inv;
+    BIG_256_56 e[ECC_NIST256_RING_BATCH];
+    ECP64_NIST256 V[ECC_NIST256_RING_BATCH];
+    char vx[EFS_NIST256];
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        ECC_NIST256_randomnum(&k[i], RNG);
+        FR64_NIST256_toBIG(e[i], &k[i]);
+    }
+    ECP64_NIST256_mulgen_batch(n, V, e);
+
+    for (i = 0; i < n; i++)
+    {
+        FP64_NIST256_toBytes(vx, &V[i].x);
+        FR64_NIST256_fromBytes(&T[i].c, vx);
+        /* k = 0 or c = 0 has probability about 2^-256, but would spoil the whole batch */
+        while (FR64_NIST256_iszilch(&k[i]) || FR64_NIST256_iszilch(&T[i].c))
+        {
+            ECC_NIST256_randomnum(&k[i], RNG);
+            FR64_NIST256_toBIG(e[i], &k[i]);
+            ECP64_NIST256_mulgen(&V[i], e[i]);
+            ECP64_NIST256_affine(&V[i]);
+            FP64_NIST256_toBytes(vx, &V[i].x);
+            FR64_NIST256_fromBytes(&T[i].c, vx);
+        }
+        if (i == 0) FR64_NIST256_copy(&acc[0], &k[0]);
+        else FR64_NIST256_mul(&acc[i], &acc[i - 1], &k[i]);
+    }
+
+    FR64_NIST256_inv(&inv, &acc[n - 1]);
+    for (i = n - 1; i > 0; i--)
+    {
+        FR64_NIST256_mul(&T[i].kinv, &inv, &acc[i - 1]);
+        FR64_NIST256_mul(&inv, &inv, &k[i]);
+    }
+    FR64_NIST256_copy(&T[0].kinv, &inv);
+
+    for (i = 0; i < n; i++)
+    {
+        FR64_NIST256_mul(&T[i].u, &G->s, &T[i].c);
+        FR64_NIST256_mul(&T[i].u, &T[i].u, &T[i].kinv);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        FR64_NIST256_zero(&k[i]);
+        FR64_NIST256_zero(&acc[i]);
+        BIG_256_56_zero(e[i]);
+    }
+    FR64_NIST256_zero(&inv);
+    return 0;
+}
+
+ECC_NIST256_SIGNER *ECC_NIST256_SIGNER_NEW(csprng *R, octet *S, int size)
+{
+    ECC_NIST256_SIGNER *G;
+
+    G = (ECC_NIST256_SIGNER *)malloc(sizeof(ECC_NIST256_SIGNER));
+    if (G == NULL) return NULL;
+    FR64_NIST256_fromBytes(&G->s, S->val);
+    G->Q = ECC_NIST256_RING_NEW(R, size, sizeof(ECC_NIST256_SIGNER_TUPLE), ECC_NIST256_SIGNER_fill, G);
+    if (G->Q == NULL)
+    {
+        FR64_NIST256_zero(&G->s);
+        free(G);
+        return NULL;
+    }
+    return G;
+}
+
+void ECC_NIST256_SIGNER_FREE(ECC_NIST256_SIGNER *G)
+{
+    if (G == NULL) return;
+    ECC_NIST256_RING_FREE(G->Q);
+    FR64_NIST256_zero(&G->s);
+    free(G);
+}
+
+int ECC_NIST256_SIGNER_SP_DSA(ECC_NIST256_SIGNER *G, int hlen, csprng *RNG, octet *F, octet *C, octet *D)
+{
+    ECC_NIST256_SIGNER_TUPLE T;
+    FR64_NIST256 f, d;
+
+    ECC_NIST256_hashit(hlen, &f, F);
+
+    do
+    {
+        if (!ECC_NIST256_RING_TAKE(G->Q, (char *)&T))
+        {
+            if (RNG == NULL) return ECDH_ERROR;
+            ECC_NIST256_SIGNER_fill(G, RNG, 1, (char *)&T);
+        }
+
+        /* d = (f + s.c)/k = f/k + u */
+        FR64_NIST256_mul(&d, &f, &T.kinv);
+        FR64_NIST256_add(&d, &d, &T.u);
+    }
+    while (FR64_NIST256_iszilch(&d));
+
+    C->len = D->len = EGS_NIST256;
+    FR64_NIST256_toBytes(C->val, &T.c);
+    FR64_NIST256_toBytes(D->val, &d);
+
+    FR64_NIST256_zero(&T.kinv);
+    FR64_NIST256_zero(&T.u);
+    return 0;
+}
+
+void ECC_NIST256_SIGNER_GET_STATS(ECC_NIST256_SIGNER *G, ECC_NIST256_RING_STATS *S)
+{
+    ECC_NIST256_RING_GET_STATS(G->Q, S);
+}
+
+int ECC_NIST256_VP_DSA_BATCH(int hlen, int n, octet *W, octet *F, octet *C, octet *D, int *res)
+{
+    BIG_256_56 r;
+    BIG_256_56 *c, *u1, *u2;
+    FR64_NIST256 *fd, *acc, f, t, inv;
+    ECP_NIST256 WP;
+    ECP64_NIST256 *WQ, R, T[1 << (ECC_NIST256_BWINDOW - 2)];
+    HASH256_JOB *J = NULL;
+    char *hd = NULL;
+    int *idx, i, m = 0, ok = 1;
+    int simd = FPB_NIST256_simd_active();
+
+    if (n <= 0) return 0;
+    c = (BIG_256_56 *)malloc(3 * (size_t)n * sizeof(BIG_256_56));
+    fd = (FR64_NIST256 *)malloc(2 * (size_t)n * sizeof(FR64_NIST256));
+    WQ = (ECP64_NIST256 *)malloc((size_t)n * (sizeof(ECP64_NIST256) + sizeof(int)));
+    if (c == NULL || fd == NULL || WQ == NULL)
+    {
+        free(c);
+        free(fd);
+        free(WQ);
+        return ECDH_ERROR;
+    }
+    u1 = c + n;
+    u2 = u1 + n;
+    acc = fd + n;
+    idx = (int *)(WQ + n);
+
+    BIG_256_56_rcopy(r, CURVE_Order_NIST256);
+
+    /* Range checks, and running products of the valid d[i] */
+    FR64_NIST256_one(&t);
+    for (i = 0; i < n; i++)
+    {
+        ECC_NIST256_frombytes(c[i], &C[i]);
+        ECC_NIST256_frombytes(u2[i], &D[i]);
+        res[i] = 0;
+        if (BIG_256_56_iszilch(c[i]) || BIG_256_56_comp(c[i], r) >= 0 || BIG_256_56_iszilch(u2[i]) || BIG_256_56_comp(u2[i], r) >= 0)
+            res[i] = ECDH_ERROR;
+        else
+        {
+            FR64_NIST256_fromBIG(&fd[i], u2[i]);
+            FR64_NIST256_mul(&t, &t, &fd[i]);
+        }
+        FR64_NIST256_copy(&acc[i], &t);
+    }
+
+    /* The SHA-256 message hashes several at a time, for the signatures still in the running */
+    if (hlen == SHA256) J = (HASH256_JOB *)malloc((size_t)n * (sizeof(HASH256_JOB) + SHA256));
+    if (J != NULL)
+    {
+        hd = (char *)(J + n);
+        for (i = 0; i < n; i++)
+        {
+            if (res[i] != 0) continue;
+            J[m].msg = F[i].val;
+            J[m].len = F[i].len;
+            J[m].iv = NULL;
+            J[m].prefix = 0;
+            J[m].digest = &hd[i * SHA256];
+            m++;
+        }
+        HASH256_multi(m, J);
+        m = 0;
+    }
+
+    /* One inversion for the whole batch, then peel off each d[i]^-1 */
+    FR64_NIST256_inv(&inv, &t);
+    for (i = n - 1; i >= 0; i--)
+    {
+        if (res[i] != 0) continue;
+        if (i > 0) FR64_NIST256_mul(&t, &inv, &acc[i - 1]);
+        else FR64_NIST256_copy(&t, &inv);
+        FR64_NIST256_mul(&inv, &inv, &fd[i]);
+        FR64_NIST256_copy(&fd[i], &t);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (res[i] != 0) continue;
+
+        if (hd != NULL) FR64_NIST256_fromBytesLen(&f, &hd[i * SHA256], SHA256);
+        else ECC_NIST256_hashit(hlen, &f, &F[i]);
+        FR64_NIST256_mul(&f, &f, &fd[i]);
+        FR64_NIST256_toBIG(u1[i], &f);
+        FR64_NIST256_fromBIG(&t, c[i]);
+        FR64_NIST256_mul(&t, &t, &fd[i]);
+        FR64_NIST256_toBIG(u2[i], &t);
+
+        if (!ECP_NIST256_fromOctet(&WP, &W[i]))
+        {
+            res[i] = ECDH_ERROR;
+            continue;
+        }
+        ECP64_NIST256_fromECP(&WQ[i], &WP);
+        if (simd)
+        {
+            idx[m++] = i;
+            continue;
+        }
+        ECC_NIST256_odd_multiples(T, &WQ[i], 1 << (ECC_NIST256_BWINDOW - 2));
+        ECC_NIST256_mul2_vartime(&R, T, ECC_NIST256_BWINDOW, u2[i], u1[i]);
+        if (!ECC_NIST256_xcheck(&R, c[i])) res[i] = ECDH_ERROR;
+    }
+    if (m > 0) ECC_NIST256_verify_batch(m, idx, WQ, u1, u2, c, res);
+    free(J);
+    free(WQ);
+    free(fd);
+    free(c);
+
+    /* Anything the batch rejected is decided by the reference implementation */
+    for (i = 0; i < n; i++)
+    {
+        if (res[i] == 0) continue;
+        res[i] = ECP_NIST256_VP_DSA(hlen, &W[i], &F[i], &C[i], &D[i]);
+        if (res[i] != 0) ok = 0;
+    }
+    return ok ? 0 : ECDH_ERROR;
+}
+
+int ECC_NIST256_VERIFIER_INIT(ECC_NIST256_VERIFIER *V, octet *W)
+{
+    ECP64_NIST256 WQ;
+
+    if (ECP_NIST256_PUBLIC_KEY_VALIDATE(W) != 0) return ECDH_INVALID_PUBLIC_KEY;
+    if (!ECP_NIST256_fromOctet(&V->W, W)) return ECDH_INVALID_PUBLIC_KEY;
+    ECP64_NIST256_fromECP(&WQ, &V->W);
+    ECC_NIST256_odd_multiples(V->T, &WQ, ECC_NIST256_VTAB);
+    return 0;
+}
+
+int ECC_NIST256_VERIFIER_VP_DSA(const ECC_NIST256_VERIFIER *V, int hlen, octet *F, octet *C, octet *D)
+{
+    BIG_256_56 r, c, d, u1, u2;
+    FR64_NIST256 f, t, di;
+    ECP64_NIST256 R;
+
+    BIG_256_56_rcopy(r, CURVE_Order_NIST256);
+    ECC_NIST256_frombytes(c, C);
+    ECC_NIST256_frombytes(d, D);
+    if (BIG_256_56_iszilch(c) || BIG_256_56_comp(c, r) >= 0 || BIG_256_56_iszilch(d) || BIG_256_56_comp(d, r) >= 0)
+        return ECDH_ERROR;
+
+    ECC_NIST256_hashit(hlen, &f, F);
+    FR64_NIST256_fromBIG(&di, d);
+    FR64_NIST256_inv(&di, &di);
+    FR64_NIST256_mul(&f, &f, &di);
+    FR64_NIST256_toBIG(u1, &f);
+    FR64_NIST256_fromBIG(&t, c);
+    FR64_NIST256_mul(&t, &t, &di);
+    FR64_NIST256_toBIG(u2, &t);
+
+    ECC_NIST256_mul2_vartime(&R, V->T, ECC_NIST256_VWINDOW, u2, u1);
+    return ECC_NIST256_xcheck(&R, c) ? 0 : ECDH_ERROR;
+}
@@ -0,0 +1,175 @@
+/**
+ * @file ecc_NIST256.h
+ * @brief Fast paths for MIRACL Core's NIST256 ECDH/ECDSA primitives
+ *
+ * Drop-in counterparts of the ECP_NIST256_* functions in ecdh_NIST256.h.
+ * Inputs, outputs and error codes are identical, so callers can switch
+ * by changing the prefix; only the implementation differs.
+ */
+
+#ifndef ECC_NIST256_H
+#define ECC_NIST256_H
+
+#include "core.h"
+#include "ecdh_NIST256.h"
+#include "ecp64_NIST256.h"
+#include "ecring_NIST256.h"
+
+#define ECC_NIST256_VWINDOW 6                                /**< wNAF window width for a verifier's public key */
+#define ECC_NIST256_VTAB (1 << (ECC_NIST256_VWINDOW - 2))    /**< Odd multiples W,3W,..,(2*VTAB-1)W held by a verifier */
+
+/**
+	@brief ECDSA verifier for one public key, built once and reused
+
+	Holds the decoded, validated public key and its odd multiples, so a
+	verification does no octet parsing, no point validation and no table
+	construction. Immutable after ECC_NIST256_VERIFIER_INIT, so one
+	instance can be shared by any number of threads.
+*/
+typedef struct
+{
+    ECP_NIST256 W;                      /**< Public key */
+    ECP64_NIST256 T[ECC_NIST256_VTAB];  /**< Precomputed W,3W,5W,...  */
+} ECC_NIST256_VERIFIER;
+
+/**
+	@brief ECDSA signer for one private key, with precomputed nonce tuples, opaque
+
+	Everything in an ECDSA signature but the last step is independent of
+	the message: the nonce k, r = x(k.G) mod n, 1/k and r.s/k. A signer
+	keeps a ring of such tuples, refilled by a background thread that
+	computes them in batches, with one inversion mod n per batch. Signing
+	then takes a tuple and computes s = f/k + r.s/k, two operations mod n.
+	Each tuple is used for exactly one signature and wiped as it is taken.
+
+	A signer stays usable in a child of fork(), and never reuses a nonce
+	there: the child's first use wipes the tuples it inherited and restarts
+	the refill thread on an RNG reseeded from /dev/urandom. Should that
+	fail, the child signs on the inline path only, with the caller's R,
+	which like any csprng must itself be reseeded after fork().
+*/
+typedef struct ECC_NIST256_SIGNER ECC_NIST256_SIGNER;
+
+/**	@brief Generate an ECC public/private key pair
+ *
+	Same as ECP_NIST256_KEY_PAIR_GENERATE, with s.G from the fixed-base table
+	@param R is a pointer to a cryptographically secure random number generator
+	@param s the private key, an output internally randomly generated if R!=NULL, otherwise must be provided as an input
+	@param W the output public key, which is s.G, where G is a fixed generator
+	@return 0 or an error code
+ */
+extern int ECC_NIST256_KEY_PAIR_GENERATE(csprng *R, octet *s, octet *W);
+
+/**	@brief Generate n ECC public/private key pairs
+ *
+	Same keys as n calls to ECC_NIST256_KEY_PAIR_GENERATE with the same RNG,
+	written one after another into two contiguous buffers. The random bytes
+	for all n scalars are drawn in one pass and reduced without division,
+	the n products s.G share the fixed-base comb (eight lanes at a time
+	when the IFMA kernels are in use), and all n points share a single
+	field inversion for the affine conversion.
+	@param R is a pointer to a cryptographically secure random number generator
+	@param n the number of key pairs
+	@param s n private keys of EGS_NIST256 bytes each, an output internally randomly generated if R!=NULL, otherwise must be provided as an input
+	@param W the n output public keys of 2*EFS_NIST256+1 bytes each, W->max must be at least n times that
+	@return 0 or an error code
+ */
+extern int ECC_NIST256_KEY_PAIR_GENERATE_BATCH(csprng *R, int n, octet *s, octet *W);
+
+/**	@brief ECDSA Signature
+ *
+	Same as ECP_NIST256_SP_DSA, with k.G from the fixed-base table
+	@param h is the hash type
+	@param R is a pointer to a cryptographically secure random number generator
+	@param k Ephemeral key. This value is used when R=NULL
+	@param s the input private signing key
+	@param M the input message to be signed
+	@param c component of the output signature
+	@param d component of the output signature
+	@return 0 or an error code
+ */
+extern int ECC_NIST256_SP_DSA(int h, csprng *R, octet *k, octet *s, octet *M, octet *c, octet *d);
+
+/**	@brief Create a signer for a private key and start filling its ring
+ *
+	The ring's own RNG is seeded from R, which is only used during this call.
+	@param R is a pointer to a cryptographically secure random number generator
+	@param s the input private signing key
+	@param size the number of tuples the ring holds, rounded up to a power of 2
+	@return the new signer, or NULL on failure
+ */
+extern ECC_NIST256_SIGNER *ECC_NIST256_SIGNER_NEW(csprng *R, octet *s, int size);
+/**	@brief Stop the signer's thread, wipe its key and every tuple left, and free it
+ *
+	No other thread may be using the signer.
+	@param G the signer, may be NULL
+ */
+extern void ECC_NIST256_SIGNER_FREE(ECC_NIST256_SIGNER *G);
+/**	@brief ECDSA Signature with a precomputed nonce tuple
+ *
+	Same output distribution as ECC_NIST256_SP_DSA with the signer's key.
+	Safe to call from any number of threads, each with its own R. If the
+	ring is empty, a tuple is computed inline with R instead.
+	@param G the signer
+	@param h is the hash type
+	@param R is a pointer to a cryptographically secure random number generator, used only when the ring is empty
+	@param M the input message to be signed
+	@param c component of the output signature
+	@param d component of the output signature
+	@return 0, or ECDH_ERROR if the ring is empty and R=NULL
+ */
+extern int ECC_NIST256_SIGNER_SP_DSA(ECC_NIST256_SIGNER *G, int h, csprng *R, octet *M, octet *c, octet *d);
+/**	@brief Read a signer's ring counters
+ *
+	@param G the signer
+	@param S on exit the counters: tuples ready, taken, missed and filled
+ */
+extern void ECC_NIST256_SIGNER_GET_STATS(ECC_NIST256_SIGNER *G, ECC_NIST256_RING_STATS *S);
+
+/**	@brief Batch ECDSA Signature Verification
+ *
+	Verifies n independent (W[i], M[i], c[i], d[i]) signatures. The n scalar
+	inversions d[i]^-1 share one modular inversion, the double multiplication
+	is an interleaved variable-time wNAF (all inputs are public), and the
+	x-coordinate test is done in projective coordinates, so no field
+	inversion is needed.
+	When the FPB_NIST256 IFMA kernels are in use, the double multiplications
+	instead run eight signatures at a time on ECPB_NIST256 lanes, with signed
+	4-bit windows over one shared chain of doublings. SHA-256 message
+	hashes are computed together by HASH256_multi.
+	Signatures rejected by the batch are re-checked one by one with
+	ECP_NIST256_VP_DSA, so res[] always agrees with the reference.
+	@param h is the hash type
+	@param n the number of signatures
+	@param W array of n input public keys
+	@param M array of n input messages
+	@param c array of n first components of the input signatures
+	@param d array of n second components of the input signatures
+	@param res array of n outputs, 0 or an error code for each signature
+	@return 0 if every signature verifies, else ECDH_ERROR
+ */
+extern int ECC_NIST256_VP_DSA_BATCH(int h, int n, octet W[], octet M[], octet c[], octet d[], int res[]);
+
+/**	@brief Build a verifier for a public key
+ *
+	@param V the verifier to initialise
+	@param W the input public key
+	@return 0 if public key is OK, or an error code
+ */
+extern int ECC_NIST256_VERIFIER_INIT(ECC_NIST256_VERIFIER *V, octet *W);
+
+/**	@brief ECDSA Signature Verification against a prepared public key
+ *
+	Same result as ECP_NIST256_VP_DSA with the verifier's public key. The
+	double multiplication runs in variable time, which is safe here as
+	every input is public.
+	@param V the verifier for the public key
+	@param h is the hash type
+	@param M the input message
+	@param c component of the input signature
+	@param d component of the input signature
+	@return 0 or an error code
+ */
+extern int ECC_NIST256_VERIFIER_VP_DSA(const ECC_NIST256_VERIFIER *V, int h, octet *M, octet *c, octet *d);
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * ecgen_NIST256.c - Fixed-base comb for the NIST256 generator
+ *
+ * The scalar is split into 4-bit windows and recoded into signed digits
+ * d_i in [-8, 7], with the carry out of the top window becoming a 65th
+ * digit. Then e.G = sum d_i.16^i.G, and each term is a table lookup:
+ * |d_i| selects one of eight precomputed points and the sign of d_i
+ * conditionally negates its y-coordinate. Table points are affine, so
+ * each term is a mixed addition; a zero digit is absorbed by discarding
+ * the sum with a constant-time move.
+ */
+
+#include "ecgen_NIST256.h"
+
+/* Constant time equality test, 1 if b==c else 0 */
+static int teq(sign32 b, sign32 c)
+{
+    sign32 x = b ^ c;
+    x -= 1;  // if x=0, x now -1
+    return (int)((x >> 31) & 1);
+}
+
+void ECP64_NIST256_gselect(ECP64_NIST256_AFFINE *T, int i, sign32 d)
+{
+    FP64_NIST256 ny;
+    sign32 m = d >> 31;
+    sign32 babs = (d ^ m) - m;
+
+    *T = ECP_NIST256_GTAB[i][0];
+    for (int j = 1; j < ECGEN_NIST256_ENTRIES; j++)
+    {
+        int s = teq(babs, j + 1);
+        FP64_NIST256_cmove(&T->x, &ECP_NIST256_GTAB[i][j].x, s);
+        FP64_NIST256_cmove(&T->y, &ECP_NIST256_GTAB[i][j].y, s);
+    }
+
+    FP64_NIST256_neg(&ny, &T->y);
+    FP64_NIST256_cmove(&T->y, &ny, (int)(m & 1));
+}
+
+/* P += d.16^i.G */
+static void ECP_NIST256_gadd(ECP64_NIST256 *P, int i, sign32 d)
+{
+    ECP64_NIST256_AFFINE T;
+    ECP64_NIST256 S;
+    sign32 m = d >> 31;
+    sign32 babs = (d ^ m) - m;
+
+    ECP64_NIST256_gselect(&T, i, d);
+    ECP64_NIST256_copy(&S, P);
+    ECP64_NIST256_add_affine(&S, &T);
+    ECP64_NIST256_cmove(P, &S, 1 - teq(babs, 0));
+}
+
+void ECP64_NIST256_mulgen(ECP64_NIST256 *P, BIG_256_56 e)
+{
+    char b[MODBYTES_256_56];
+    sign32 t, d, carry = 0;
+
+    BIG_256_56_toBytes(b, e);
+    ECP64_NIST256_inf(P);
+
+    for (int i = 0; i < ECGEN_NIST256_WINDOWS - 1; i++)
+    {
+        t = ((b[MODBYTES_256_56 - 1 - i / 2] & 0xff) >> (4 * (i & 1))) & 0xf;
+        t += carry;
+        carry = (t + 8) >> 4;
+        d = t - (carry << 4);
+        ECP_NIST256_gadd(P, i, d);
+    }
+    ECP_NIST256_gadd(P, ECGEN_NIST256_WINDOWS - 1, carry);
+
+    for (int i = 0; i < MODBYTES_256_56; i++) b[i] = 0;
+}
+
+void ECP_NIST256_mulgen(ECP_NIST256 *P, BIG_256_56 e)
+{
+    ECP64_NIST256 R;
+
+    ECP64_NIST256_mulgen(&R, e);
+    ECP64_NIST256_toECP(P, &R);
+}
@@ -0,0 +1,55 @@
+/**
+ * @file ecgen_NIST256.h
+ * @brief Fixed-base scalar multiplication for the NIST256 generator
+ *
+ * The generator G never changes, so all of its window multiples can be
+ * computed once. The table is produced at build time by
+ * tools/gentab_NIST256.c and lives in read-only data; s.G then costs 65
+ * point additions and no doublings, against 256 doublings plus additions
+ * for the generic ECP_NIST256_mul. The additions run on the full-radix
+ * FP64_NIST256 field, with the table already in that form.
+ */
+
+#ifndef ECGEN_NIST256_H
+#define ECGEN_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+#include "fp_NIST256.h"
+#include "ecp_NIST256.h"
+#include "ecp64_NIST256.h"
+
+#define ECGEN_NIST256_WINDOW 4    /**< Bits per signed window */
+#define ECGEN_NIST256_WINDOWS 65  /**< 256/WINDOW windows, plus one for the final recoding carry */
+#define ECGEN_NIST256_ENTRIES 8   /**< Multiples 1..2^(WINDOW-1) stored per window */
+
+/** Affine multiples (j+1).16^i.G as FP64_NIST256 residues, generated at build time */
+extern const ECP64_NIST256_AFFINE ECP_NIST256_GTAB[ECGEN_NIST256_WINDOWS][ECGEN_NIST256_ENTRIES];
+
+/**	@brief Constant-time load of a fixed-base table entry
+ *
+	Scans every entry of window i with constant-time moves
+	@param T on exit = d.16^i.G, or an arbitrary table point if d = 0
+	@param i the window, 0 <= i < ECGEN_NIST256_WINDOWS
+	@param d signed digit, -8 <= d <= 8
+ */
+extern void ECP64_NIST256_gselect(ECP64_NIST256_AFFINE *T, int i, sign32 d);
+
+/**	@brief Multiplies the curve generator by a scalar, P=e*G, side-channel resistant
+ *
+	As ECP_NIST256_mulgen, leaving the result on the FP64 field
+	@param P ECP64 instance, on exit =e*G
+	@param e BIG number multiplier, 0 <= e < 2^256
+ */
+extern void ECP64_NIST256_mulgen(ECP64_NIST256 *P, BIG_256_56 e);
+
+/**	@brief Multiplies the curve generator by a scalar, P=e*G, side-channel resistant
+ *
+	Table lookups scan every entry of a window with constant-time moves,
+	and the scalar is recoded into signed digits without branching.
+	@param P ECP instance, on exit =e*G
+	@param e BIG number multiplier, 0 <= e < 2^256
+ */
+extern void ECP_NIST256_mulgen(ECP_NIST256 *P, BIG_256_56 e);
+
+#endif
@@ -0,0 +1,269 @@
+/**
+ * ecmsm_NIST256.c - Multi-scalar multiplication of NIST256 points by the bucket method
+ *
+ * For window k every point is added into the bucket of its digit, then
+ * the sum over b of b.B[b] is formed from the top bucket down as a
+ * running sum of running sums, 2^c additions. The window sums S[k] are
+ * finally combined Horner-style with c doublings between them.
+ *
+ * Threads claim whole windows from a shared counter, each with its own
+ * buckets, so the only shared writes are to distinct S[k].
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DARWIN_C_SOURCE  /* macOS hides _SC_NPROCESSORS_ONLN under strict POSIX */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "ecmsm_NIST256.h"
+#include "ecbatch_NIST256.h"
+
+typedef struct
+{
+    int n;                          /* Points taking part */
+    int c;                          /* Window size in bits */
+    int windows;
+    int next;                       /* Next window to claim */
+    const ECP64_NIST256_AFFINE *A;  /* The n points, affine */
+    const sign16 *d;                /* windows x n signed digits, window by window */
+    ECP64_NIST256 *S;               /* The window sums */
+} ECMSM_NIST256_JOB;
+
+int ECMSM_NIST256_window(int n)
+{
+    double cost, best = 0;
+    int c, w = 1;
+
+    for (c = 1; c <= ECMSM_NIST256_MAXWINDOW; c++)
+    {
+        cost = (double)(256 / c + 1) * ((double)n + (double)(1 << c));
+        if (c == 1 || cost < best)
+        {
+            best = cost;
+            w = c;
+        }
+    }
+    return w;
+}
+
+/* Signed c-bit digits of e, -2^(c-1) < d <= 2^(c-1), written stride apart */
+static void ECMSM_NIST256_recode(sign16 *d, size_t stride, BIG_256_56 e, int c, int windows)
+{
+    char b[MODBYTES_256_56];
+    unsign64 w[6] = {0};
+    int i, k, pos, sh, v, carry = 0;
+
+    BIG_256_56_toBytes(b, e);
+    for (i = 0; i < MODBYTES_256_56; i++)
+        w[i / 8] |= (unsign64)(unsigned char)b[MODBYTES_256_56 - 1 - i] << (8 * (i % 8));
+
+    for (k = 0; k < windows; k++)
+    {
+        pos = k * c;
+        sh = pos & 63;
+        v = (int)(w[pos >> 6] >> sh);
+        if (sh + c > 64) v |= (int)(w[(pos >> 6) + 1] << (64 - sh));
+        v = (v & ((1 << c) - 1)) + carry;
+        carry = v > (1 << (c - 1));
+        v -= carry << c;
+        d[k * stride] = (sign16)v;
+    }
+}
+
+/* Claim windows until none are left, with nb = 2^(c-1) buckets B and flags used */
+static void ECMSM_NIST256_windows(ECMSM_NIST256_JOB *J, ECP64_NIST256 *B, char *used)
+{
+    ECP64_NIST256_AFFINE Q;
+    ECP64_NIST256 run, sum;
+    const sign16 *d;
+    int i, k, b, rs, ss, nb = 1 << (J->c - 1);
+
+    while ((k = __atomic_fetch_add(&J->next, 1, __ATOMIC_RELAXED)) < J->windows)
+    {
+        d = J->d + (size_t)k * J->n;
+        memset(used, 0, (size_t)nb);
+        for (i = 0; i < J->n; i++)
+        {
+            if (d[i] == 0) continue;
+            Q = J->A[i];
+            if (d[i] < 0) FP64_NIST256_neg(&Q.y, &Q.y);
+            b = (d[i] < 0 ? -d[i] : d[i]) - 1;
+            if (used[b])
+            {
+                ECP64_NIST256_add_affine(&B[b], &Q);
+                continue;
+            }
+            FP64_NIST256_copy(&B[b].x, &Q.x);
+            FP64_NIST256_copy(&B[b].y, &Q.y);
+            FP64_NIST256_one(&B[b].z);
+            used[b] = 1;
+        }
+
+        /* sum = B[0] + 2.B[1] + ... + nb.B[nb-1] */
+        rs = ss = 0;
+        for (b = nb - 1; b >= 0; b--)
+        {
+            if (used[b])
+            {
+                if (rs) ECP64_NIST256_add(&run, &B[b]);
+                else ECP64_NIST256_copy(&run, &B[b]);
+                rs = 1;
+            }
+            if (!rs) continue;
+            if (ss) ECP64_NIST256_add(&sum, &run);
+            else ECP64_NIST256_copy(&sum, &run);
+            ss = 1;
+        }
+        if (ss) ECP64_NIST256_copy(&J->S[k], &sum);
+        else ECP64_NIST256_inf(&J->S[k]);
+    }
+}
+
+static void *ECMSM_NIST256_thread(void *arg)
+{
+    ECMSM_NIST256_JOB *J = (ECMSM_NIST256_JOB *)arg;
+    size_t nb = (size_t)1 << (J->c - 1);
+    ECP64_NIST256 *B;
+
+    /* Without buckets this thread takes no windows, and the others do its share */
+    B = (ECP64_NIST256 *)malloc(nb * (sizeof(ECP64_NIST256) + 1));
+    if (B == NULL) return NULL;
+    ECMSM_NIST256_windows(J, B, (char *)(B + nb));
+    free(B);
+    return NULL;
+}
+
+/* Interleaved double-and-add, for when there is no memory for buckets */
+static void ECMSM_NIST256_simple(ECP64_NIST256 *P, int n, const ECP64_NIST256 X[], BIG_256_56 e[])
+{
+    int i, j;
+
+    ECP64_NIST256_inf(P);
+    for (j = 8 * MODBYTES_256_56 - 1; j >= 0; j--)
+    {
+        ECP64_NIST256_dbl(P);
+        for (i = 0; i < n; i++)
+            if (BIG_256_56_bit(e[i], j)) ECP64_NIST256_add(P, &X[i]);
+    }
+}
+
+/* The bucket method on points T, which are normalised in place */
+static void ECMSM_NIST256_run(ECP64_NIST256 *P, int n, ECP64_NIST256 T[], BIG_256_56 e[], int threads)
+{
+    ECMSM_NIST256_JOB J;
+    ECP64_NIST256_AFFINE *A;
+    ECP64_NIST256 *B, *S;
+    pthread_t tid[64];
+    sign16 *d;
+    size_t nb;
+    int i, k, m = 0, started = 0;
+
+    for (i = 0; i < n; i++)
+        if (!BIG_256_56_iszilch(e[i]) && !ECP64_NIST256_isinf(&T[i])) m++;
+    if (m == 0)
+    {
+        ECP64_NIST256_inf(P);
+        return;
+    }
+
+    J.n = m;
+    J.c = ECMSM_NIST256_window(m);
+    J.windows = 8 * MODBYTES_256_56 / J.c + 1;
+    J.next = 0;
+    nb = (size_t)1 << (J.c - 1);
+
+    A = (ECP64_NIST256_AFFINE *)malloc((size_t)m * sizeof(ECP64_NIST256_AFFINE));
+    d = (sign16 *)malloc((size_t)m * J.windows * sizeof(sign16));
+    S = (ECP64_NIST256 *)malloc((size_t)J.windows * sizeof(ECP64_NIST256));
+    B = (ECP64_NIST256 *)malloc(nb * (sizeof(ECP64_NIST256) + 1));
+    if (A == NULL || d == NULL || S == NULL || B == NULL)
+    {
+        free(A);
+        free(d);
+        free(S);
+        free(B);
+        ECMSM_NIST256_simple(P, n, T, e);
+        return;
+    }
+
+    ECP64_NIST256_affine_batch(n, T);
+    for (i = 0, k = 0; i < n; i++)
+    {
+        if (BIG_256_56_iszilch(e[i]) || ECP64_NIST256_isinf(&T[i])) continue;
+        FP64_NIST256_copy(&A[k].x, &T[i].x);
+        FP64_NIST256_copy(&A[k].y, &T[i].y);
+        ECMSM_NIST256_recode(d + k, (size_t)m, e[i], J.c, J.windows);
+        k++;
+    }
+    J.A = A;
+    J.d = d;
+    J.S = S;
+
+    if (threads == 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (m < ECMSM_NIST256_MT_MIN || threads < 1) threads = 1;
+    if (threads > J.windows) threads = J.windows;
+    if (threads > (int)(sizeof(tid) / sizeof(tid[0]))) threads = (int)(sizeof(tid) / sizeof(tid[0]));
+    for (i = 1; i < threads; i++)
+        if (pthread_create(&tid[started], NULL, ECMSM_NIST256_thread, &J) == 0) started++;
+
+    ECMSM_NIST256_windows(&J, B, (char *)(B + nb));
+    for (i = 0; i < started; i++) pthread_join(tid[i], NULL);
+
+    ECP64_NIST256_copy(P, &S[J.windows - 1]);
+    for (k = J.windows - 2; k >= 0; k--)
+    {
+        if (!ECP64_NIST256_isinf(P))
+            for (i = 0; i < J.c; i++) ECP64_NIST256_dbl(P);
+        ECP64_NIST256_add(P, &S[k]);
+    }
+
+    free(A);
+    free(d);
+    free(S);
+    free(B);
+}
+
+void ECP64_NIST256_muln(ECP64_NIST256 *P, int n, const ECP64_NIST256 X[], BIG_256_56 e[], int threads)
+{
+    ECP64_NIST256 *T;
+
+    if (n <= 0)
+    {
+        ECP64_NIST256_inf(P);
+        return;
+    }
+    T = (ECP64_NIST256 *)malloc((size_t)n * sizeof(ECP64_NIST256));
+    if (T == NULL)
+    {
+        ECMSM_NIST256_simple(P, n, X, e);
+        return;
+    }
+    memcpy(T, X, (size_t)n * sizeof(ECP64_NIST256));
+    ECMSM_NIST256_run(P, n, T, e, threads);
+    free(T);
+}
+
+void ECP_NIST256_muln_bucket(ECP_NIST256 *P, int n, ECP_NIST256 X[], BIG_256_56 e[], int threads)
+{
+    ECP64_NIST256 *T, R;
+    int i;
+
+    if (n <= 0)
+    {
+        ECP_NIST256_inf(P);
+        return;
+    }
+    T = (ECP64_NIST256 *)malloc((size_t)n * sizeof(ECP64_NIST256));
+    if (T == NULL)
+    {
+        ECP_NIST256_muln(P, n, X, e);
+        return;
+    }
+    for (i = 0; i < n; i++) ECP64_NIST256_fromECP(&T[i], &X[i]);
+    ECMSM_NIST256_run(&R, n, T, e, threads);
+    free(T);
+    ECP64_NIST256_toECP(P, &R);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file ecmsm_NIST256.h
+ * @brief Multi-scalar multiplication of NIST256 points by the bucket method
+ *
+ * ECP_NIST256_muln computes e[0].X[0] + ... + e[n-1].X[n-1] with a fixed
+ * window and 16 buckets, so its cost stays close to linear in n. Pippenger's
+ * bucket method with a window c chosen from n costs about
+ * (256/c)(n + 2^c) point additions, which for large n is n.256/log2(n)
+ * rather than n.256/4, plus one shared chain of 256 doublings.
+ *
+ * Scalars are recoded into signed c-bit digits, so each window needs
+ * 2^(c-1) buckets and a negative digit only negates y. The points are
+ * normalised to affine with one field inversion and added into the
+ * buckets with mixed additions on the FP64_NIST256 field. Windows are
+ * independent until the final doublings, so they can be shared out
+ * between threads.
+ *
+ * Everything here is variable time: use it only on public points and
+ * public scalars, such as in batch verification.
+ */
+
+#ifndef ECMSM_NIST256_H
+#define ECMSM_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+#include "fp_NIST256.h"
+#include "ecp_NIST256.h"
+#include "ecp64_NIST256.h"
+
+#define ECMSM_NIST256_MAXWINDOW 15  /**< Largest window, 2^14 buckets per window */
+#define ECMSM_NIST256_MT_MIN 128    /**< Fewest points worth starting threads for */
+
+/**	@brief Window size used for n points
+ *
+	The c in 1..ECMSM_NIST256_MAXWINDOW that minimises (256/c+1)(n+2^c)
+	@param n the number of points
+	@return the window size in bits
+ */
+extern int ECMSM_NIST256_window(int n);
+
+/**	@brief Multi-scalar multiplication P=e[0].X[0]+...+e[n-1].X[n-1], not side-channel resistant
+ *
+	Pippenger's bucket method on the FP64 field. Points at infinity and
+	zero scalars are skipped. With threads > 1 and at least
+	ECMSM_NIST256_MT_MIN points, the windows are shared out between the
+	calling thread and up to threads-1 helper threads; threads = 0 uses
+	one thread per online CPU. The result does not depend on threads.
+	@param P ECP64 instance, on exit = the sum
+	@param n the number of points
+	@param X array of n ECP64 points, left unchanged
+	@param e array of n BIG multipliers, 0 <= e[i] < 2^256
+	@param threads the most threads to use, or 0 for one per CPU
+ */
+extern void ECP64_NIST256_muln(ECP64_NIST256 *P, int n, const ECP64_NIST256 X[], BIG_256_56 e[], int threads);
+
+/**	@brief Multi-scalar multiplication P=e[0].X[0]+...+e[n-1].X[n-1], not side-channel resistant
+ *
+	Same result as ECP_NIST256_muln(P, n, X, e), computed by
+	ECP64_NIST256_muln. With threads = 1 it is a drop-in replacement.
+	@param P ECP instance, on exit = the sum
+	@param n the number of points
+	@param X array of n ECP points, left unchanged
+	@param e array of n BIG multipliers, 0 <= e[i] < 2^256
+	@param threads the most threads to use, or 0 for one per CPU
+ */
+extern void ECP_NIST256_muln_bucket(ECP_NIST256 *P, int n, ECP_NIST256 X[], BIG_256_56 e[], int threads);
+
+#endif
@@ -0,0 +1,223 @@
+/**
+ * ecp64_NIST256.c - NIST256 point arithmetic over FP64_NIST256
+ *
+ * Addition, mixed addition and doubling are Algorithms 4, 5 and 6 of
+ * Renes, Costello and Batina, "Complete addition formulas for prime order
+ * elliptic curves" (2016), for a = -3. The step numbers in the comments
+ * follow the paper.
+ */
+
+#include "ecp64_NIST256.h"
+
+/* Curve constant b, in Montgomery form */
+static const FP64_NIST256 B = {{0xD89CDF6229C4BDDFULL, 0xACF005CD78843090ULL, 0xE5A220ABF7212ED6ULL, 0xDC30061D04874834ULL}};
+
+void ECP64_NIST256_inf(ECP64_NIST256 *P)
+{
+    FP64_NIST256_zero(&P->x);
+    FP64_NIST256_one(&P->y);
+    FP64_NIST256_zero(&P->z);
+}
+
+int ECP64_NIST256_isinf(const ECP64_NIST256 *P)
+{
+    return FP64_NIST256_iszilch(&P->x) & FP64_NIST256_iszilch(&P->z);
+}
+
+void ECP64_NIST256_copy(ECP64_NIST256 *P, const ECP64_NIST256 *Q)
+{
+    FP64_NIST256_copy(&P->x, &Q->x);
+    FP64_NIST256_copy(&P->y, &Q->y);
+    FP64_NIST256_copy(&P->z, &Q->z);
+}
+
+void ECP64_NIST256_cmove(ECP64_NIST256 *P, const ECP64_NIST256 *Q, int s)
+{
+    FP64_NIST256_cmove(&P->x, &Q->x, s);
+    FP64_NIST256_cmove(&P->y, &Q->y, s);
+    FP64_NIST256_cmove(&P->z, &Q->z, s);
+}
+
+void ECP64_NIST256_neg(ECP64_NIST256 *P)
+{
+    FP64_NIST256_neg(&P->y, &P->y);
+}
+
+void ECP64_NIST256_dbl(ECP64_NIST256 *P)
+{
+    FP64_NIST256 t0, t1, t2, t3, x3, y3, z3;
+
+    FP64_NIST256_sqr(&t0, &P->x);         /* 1 */
+    FP64_NIST256_sqr(&t1, &P->y);         /* 2 */
+    FP64_NIST256_sqr(&t2, &P->z);         /* 3 */
+    FP64_NIST256_mul(&t3, &P->x, &P->y);  /* 4 */
+    FP64_NIST256_add(&t3, &t3, &t3);      /* 5 */
+    FP64_NIST256_mul(&z3, &P->x, &P->z);  /* 6 */
+    FP64_NIST256_add(&z3, &z3, &z3);      /* 7 */
+    FP64_NIST256_mul(&y3, &B, &t2);       /* 8 */
+    FP64_NIST256_sub(&y3, &y3, &z3);      /* 9 */
+    FP64_NIST256_add(&x3, &y3, &y3);      /* 10 */
+    FP64_NIST256_add(&y3, &x3, &y3);      /* 11 */
+    FP64_NIST256_sub(&x3, &t1, &y3);      /* 12 */
+    FP64_NIST256_add(&y3, &t1, &y3);      /* 13 */
+    FP64_NIST256_mul(&y3, &x3, &y3);      /* 14 */
+    FP64_NIST256_mul(&x3, &x3, &t3);      /* 15 */
+    FP64_NIST256_add(&t3, &t2, &t2);      /* 16 */
+    FP64_NIST256_add(&t2, &t2, &t3);      /* 17 */
+    FP64_NIST256_mul(&z3, &B, &z3);       /* 18 */
+    FP64_NIST256_sub(&z3, &z3, &t2);      /* 19 */
+    FP64_NIST256_sub(&z3, &z3, &t0);      /* 20 */
+    FP64_NIST256_add(&t3, &z3, &z3);      /* 21 */
+    FP64_NIST256_add(&z3, &z3, &t3);      /* 22 */
+    FP64_NIST256_add(&t3, &t0, &t0);      /* 23 */
+    FP64_NIST256_add(&t0, &t3, &t0);      /* 24 */
+    FP64_NIST256_sub(&t0, &t0, &t2);      /* 25 */
+    FP64_NIST256_mul(&t0, &t0, &z3);      /* 26 */
+    FP64_NIST256_add(&y3, &y3, &t0);      /* 27 */
+    FP64_NIST256_mul(&t0, &P->y, &P->z);  /* 28 */
+    FP64_NIST256_add(&t0, &t0, &t0);      /* 29 */
+    FP64_NIST256_mul(&z3, &t0, &z3);      /* 30 */
+    FP64_NIST256_sub(&P->x, &x3, &z3);    /* 31 */
+    FP64_NIST256_mul(&z3, &t0, &t1);      /* 32 */
+    FP64_NIST256_add(&z3, &z3, &z3);      /* 33 */
+    FP64_NIST256_add(&z3, &z3, &z3);      /* 34 */
+    FP64_NIST256_copy(&P->y, &y3);
+    FP64_NIST256_copy(&P->z, &z3);
+}
+
+void ECP64_NIST256_add(ECP64_NIST256 *P, const ECP64_NIST256 *Q)
+{
+    FP64_NIST256 t0, t1, t2, t3, t4, x3, y3, z3;
+
+    FP64_NIST256_mul(&t0, &P->x, &Q->x);  /* 1 */
+    FP64_NIST256_mul(&t1, &P->y, &Q->y);  /* 2 */
+    FP64_NIST256_mul(&t2, &P->z, &Q->z);  /* 3 */
+    FP64_NIST256_add(&t3, &P->x, &P->y);  /* 4 */
+    FP64_NIST256_add(&t4, &Q->x, &Q->y);  /* 5 */
+    FP64_NIST256_mul(&t3, &t3, &t4);      /* 6 */
+    FP64_NIST256_add(&t4, &t0, &t1);      /* 7 */
+    FP64_NIST256_sub(&t3, &t3, &t4);      /* 8 */
+    FP64_NIST256_add(&t4, &P->y, &P->z);  /* 9 */
+    FP64_NIST256_add(&x3, &Q->y, &Q->z);  /* 10 */
+    FP64_NIST256_mul(&t4, &t4, &x3);      /* 11 */
+    FP64_NIST256_add(&x3, &t1, &t2);      /* 12 */
+    FP64_NIST256_sub(&t4, &t4, &x3);      /* 13 */
+    FP64_NIST256_add(&x3, &P->x, &P->z);  /* 14 */
+    FP64_NIST256_add(&y3, &Q->x, &Q->z);  /* 15 */
+    FP64_NIST256_mul(&x3, &x3, &y3);      /* 16 */
+    FP64_NIST256_add(&y3, &t0, &t2);      /* 17 */
+    FP64_NIST256_sub(&y3, &x3, &y3);      /* 18 */
+    FP64_NIST256_mul(&z3, &B, &t2);       /* 19 */
+    FP64_NIST256_sub(&x3, &y3, &z3);      /* 20 */
+    FP64_NIST256_add(&z3, &x3, &x3);      /* 21 */
+    FP64_NIST256_add(&x3, &x3, &z3);      /* 22 */
+    FP64_NIST256_sub(&z3, &t1, &x3);      /* 23 */
+    FP64_NIST256_add(&x3, &t1, &x3);      /* 24 */
+    FP64_NIST256_mul(&y3, &B, &y3);       /* 25 */
+    FP64_NIST256_add(&t1, &t2, &t2);      /* 26 */
+    FP64_NIST256_add(&t2, &t1, &t2);      /* 27 */
+    FP64_NIST256_sub(&y3, &y3, &t2);      /* 28 */
+    FP64_NIST256_sub(&y3, &y3, &t0);      /* 29 */
+    FP64_NIST256_add(&t1, &y3, &y3);      /* 30 */
+    FP64_NIST256_add(&y3, &t1, &y3);      /* 31 */
+    FP64_NIST256_add(&t1, &t0, &t0);      /* 32 */
+    FP64_NIST256_add(&t0, &t1, &t0);      /* 33 */
+    FP64_NIST256_sub(&t0, &t0, &t2);      /* 34 */
+    FP64_NIST256_mul(&t1, &t4, &y3);      /* 35 */
+    FP64_NIST256_mul(&t2, &t0, &y3);      /* 36 */
+    FP64_NIST256_mul(&y3, &x3, &z3);      /* 37 */
+    FP64_NIST256_add(&P->y, &y3, &t2);    /* 38 */
+    FP64_NIST256_mul(&x3, &t3, &x3);      /* 39 */
+    FP64_NIST256_sub(&P->x, &x3, &t1);    /* 40 */
+    FP64_NIST256_mul(&z3, &t4, &z3);      /* 41 */
+    FP64_NIST256_mul(&t1, &t3, &t0);      /* 42 */
+    FP64_NIST256_add(&P->z, &z3, &t1);    /* 43 */
+}
+
+void ECP64_NIST256_add_affine(ECP64_NIST256 *P, const ECP64_NIST256_AFFINE *Q)
+{
+    FP64_NIST256 t0, t1, t2, t3, t4, x3, y3, z3;
+
+    FP64_NIST256_mul(&t0, &P->x, &Q->x);  /* 1 */
+    FP64_NIST256_mul(&t1, &P->y, &Q->y);  /* 2 */
+    FP64_NIST256_add(&t3, &Q->x, &Q->y);  /* 3 */
+    FP64_NIST256_add(&t4, &P->x, &P->y);  /* 4 */
+    FP64_NIST256_mul(&t3, &t3, &t4);      /* 5 */
+    FP64_NIST256_add(&t4, &t0, &t1);      /* 6 */
+    FP64_NIST256_sub(&t3, &t3, &t4);      /* 7 */
+    FP64_NIST256_mul(&t4, &Q->y, &P->z);  /* 8 */
+    FP64_NIST256_add(&t4, &t4, &P->y);    /* 9 */
+    FP64_NIST256_mul(&y3, &Q->x, &P->z);  /* 10 */
+    FP64_NIST256_add(&y3, &y3, &P->x);    /* 11 */
+    FP64_NIST256_mul(&z3, &B, &P->z);     /* 12 */
+    FP64_NIST256_sub(&x3, &y3, &z3);      /* 13 */
+    FP64_NIST256_add(&z3, &x3, &x3);      /* 14 */
+    FP64_NIST256_add(&x3, &x3, &z3);      /* 15 */
+    FP64_NIST256_sub(&z3, &t1, &x3);      /* 16 */
+    FP64_NIST256_add(&x3, &t1, &x3);      /* 17 */
+    FP64_NIST256_mul(&y3, &B, &y3);       /* 18 */
+    FP64_NIST256_add(&t1, &P->z, &P->z);  /* 19 */
+    FP64_NIST256_add(&t2, &t1, &P->z);    /* 20 */
+    FP64_NIST256_sub(&y3, &y3, &t2);      /* 21 */
+    FP64_NIST256_sub(&y3, &y3, &t0);      /* 22 */
+    FP64_NIST256_add(&t1, &y3, &y3);      /* 23 */
+    FP64_NIST256_add(&y3, &t1, &y3);      /* 24 */
+    FP64_NIST256_add(&t1, &t0, &t0);      /* 25 */
+    FP64_NIST256_add(&t0, &t1, &t0);      /* 26 */
+    FP64_NIST256_sub(&t0, &t0, &t2);      /* 27 */
+    FP64_NIST256_mul(&t1, &t4, &y3);      /* 28 */
+    FP64_NIST256_mul(&t2, &t0, &y3);      /* 29 */
+    FP64_NIST256_mul(&y3, &x3, &z3);      /* 30 */
+    FP64_NIST256_add(&P->y, &y3, &t2);    /* 31 */
+    FP64_NIST256_mul(&x3, &t3, &x3);      /* 32 */
+    FP64_NIST256_sub(&P->x, &x3, &t1);    /* 33 */
+    FP64_NIST256_mul(&z3, &t4, &z3);      /* 34 */
+    FP64_NIST256_mul(&t1, &t3, &t0);      /* 35 */
+    FP64_NIST256_add(&P->z, &z3, &t1);    /* 36 */
+}
+
+void ECP64_NIST256_affine(ECP64_NIST256 *P)
+{
+    FP64_NIST256 zi;
+
+    if (ECP64_NIST256_isinf(P)) return;
+    FP64_NIST256_inv(&zi, &P->z);
+    FP64_NIST256_mul(&P->x, &P->x, &zi);
+    FP64_NIST256_mul(&P->y, &P->y, &zi);
+    FP64_NIST256_one(&P->z);
+}
+
+void ECP64_NIST256_rhs(FP64_NIST256 *r, const FP64_NIST256 *x)
+{
+    FP64_NIST256 t;
+
+    FP64_NIST256_sqr(&t, x);
+    FP64_NIST256_mul(&t, &t, x);
+    FP64_NIST256_sub(&t, &t, x);
+    FP64_NIST256_sub(&t, &t, x);
+    FP64_NIST256_sub(&t, &t, x);
+    FP64_NIST256_add(r, &t, &B);
+}
+
+int ECP64_NIST256_xequals(const ECP64_NIST256 *P, const FP64_NIST256 *c)
+{
+    FP64_NIST256 cz;
+
+    if (ECP64_NIST256_isinf(P)) return 0;
+    FP64_NIST256_mul(&cz, c, &P->z);
+    return FP64_NIST256_equals(&cz, &P->x);
+}
+
+void ECP64_NIST256_fromECP(ECP64_NIST256 *P, ECP_NIST256 *Q)
+{
+    FP64_NIST256_fromFP(&P->x, &Q->x);
+    FP64_NIST256_fromFP(&P->y, &Q->y);
+    FP64_NIST256_fromFP(&P->z, &Q->z);
+}
+
+void ECP64_NIST256_toECP(ECP_NIST256 *P, const ECP64_NIST256 *Q)
+{
+    FP64_NIST256_toFP(&P->x, &Q->x);
+    FP64_NIST256_toFP(&P->y, &Q->y);
+    FP64_NIST256_toFP(&P->z, &Q->z);
+}
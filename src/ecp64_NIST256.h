@@ -0,0 +1,117 @@
+/**
+ * @file ecp64_NIST256.h
+ * @brief NIST256 point arithmetic over the full-radix FP64_NIST256 field
+ *
+ * Same homogeneous projective coordinates as ECP_NIST256 (x = X/Z,
+ * y = Y/Z, infinity is (0,1,0)) and the same complete formulas of
+ * Renes, Costello and Batina for a = -3, so there are no exceptional
+ * cases and no branches on secret data. Only the field underneath
+ * differs, and points convert to and from ECP_NIST256 losslessly.
+ */
+
+#ifndef ECP64_NIST256_H
+#define ECP64_NIST256_H
+
+#include "core.h"
+#include "ecp_NIST256.h"
+#include "fp64_NIST256.h"
+
+/**
+	@brief NIST256 point in projective coordinates over FP64_NIST256
+*/
+typedef struct
+{
+    FP64_NIST256 x;  /**< x-coordinate of point */
+    FP64_NIST256 y;  /**< y-coordinate of point */
+    FP64_NIST256 z;  /**< z-coordinate of point */
+} ECP64_NIST256;
+
+/**
+	@brief Affine NIST256 point, never the point at infinity
+*/
+typedef struct
+{
+    FP64_NIST256 x;  /**< x-coordinate of point */
+    FP64_NIST256 y;  /**< y-coordinate of point */
+} ECP64_NIST256_AFFINE;
+
+/**	@brief Set ECP64 to point-at-infinity
+ *
+	@param P ECP64 instance to be set to infinity
+ */
+extern void ECP64_NIST256_inf(ECP64_NIST256 *P);
+/**	@brief Tests for ECP64 point equal to infinity
+ *
+	@param P ECP64 point to be tested
+	@return 1 if infinity, else returns 0
+ */
+extern int ECP64_NIST256_isinf(const ECP64_NIST256 *P);
+/**	@brief Copy ECP64 point to another ECP64 point
+ *
+	@param P ECP64 instance, on exit = Q
+	@param Q ECP64 instance to be copied
+ */
+extern void ECP64_NIST256_copy(ECP64_NIST256 *P, const ECP64_NIST256 *Q);
+/**	@brief Conditional copy of ECP64 point
+ *
+	Conditionally copies second parameter to the first (without branching)
+	@param P ECP64 instance, set to Q if s!=0
+	@param Q another ECP64 instance
+	@param s copy only takes place if not equal to 0
+ */
+extern void ECP64_NIST256_cmove(ECP64_NIST256 *P, const ECP64_NIST256 *Q, int s);
+/**	@brief Negation of an ECP64 point
+ *
+	@param P ECP64 instance, on exit = -P
+ */
+extern void ECP64_NIST256_neg(ECP64_NIST256 *P);
+/**	@brief Doubles an ECP64 instance P
+ *
+	@param P ECP64 instance, on exit =2*P
+ */
+extern void ECP64_NIST256_dbl(ECP64_NIST256 *P);
+/**	@brief Adds ECP64 instance Q to ECP64 instance P
+ *
+	@param P ECP64 instance, on exit =P+Q
+	@param Q ECP64 instance to be added to P
+ */
+extern void ECP64_NIST256_add(ECP64_NIST256 *P, const ECP64_NIST256 *Q);
+/**	@brief Adds an affine point Q to ECP64 instance P
+ *
+	Mixed addition, cheaper than ECP64_NIST256_add. Complete for any P.
+	@param P ECP64 instance, on exit =P+Q
+	@param Q affine point to be added to P, not infinity
+ */
+extern void ECP64_NIST256_add_affine(ECP64_NIST256 *P, const ECP64_NIST256_AFFINE *Q);
+/**	@brief Converts an ECP64 point from Projective to affine coordinates
+ *
+	@param P ECP64 instance to be converted to affine form
+ */
+extern void ECP64_NIST256_affine(ECP64_NIST256 *P);
+/**	@brief Calculate Right Hand Side of curve equation y^2=f(x)
+ *
+	@param r FP64 instance, on exit = x^3-3x+b
+	@param x FP64 instance
+ */
+extern void ECP64_NIST256_rhs(FP64_NIST256 *r, const FP64_NIST256 *x);
+/**	@brief Tests x(P) = c, without leaving projective coordinates
+ *
+	@param P ECP64 instance
+	@param c the x-coordinate to compare against, as an FP64 residue
+	@return 1 if P is not infinity and x(P) = c, else 0
+ */
+extern int ECP64_NIST256_xequals(const ECP64_NIST256 *P, const FP64_NIST256 *c);
+/**	@brief Converts an ECP_NIST256 point to ECP64 form
+ *
+	@param P ECP64 instance, on exit the same point as Q
+	@param Q ECP_NIST256 instance
+ */
+extern void ECP64_NIST256_fromECP(ECP64_NIST256 *P, ECP_NIST256 *Q);
+/**	@brief Converts an ECP64 point to ECP_NIST256 form
+ *
+	@param P ECP_NIST256 instance, on exit the same point as Q
+	@param Q ECP64 instance
+ */
+extern void ECP64_NIST256_toECP(ECP_NIST256 *P, const ECP64_NIST256 *Q);
+
+#endif
@@ -0,0 +1,291 @@
+/**
+ * ecpb_NIST256.c - Eight-lane batch NIST256 point arithmetic
+ *
+ * Addition, mixed addition and doubling are the same Algorithms 4, 5 and 6
+ * of Renes, Costello and Batina as in ecp64_NIST256.c, step for step, with
+ * each field operation acting on all eight lanes at once.
+ */
+
+#include "ecpb_NIST256.h"
+#include "ecgen_NIST256.h"
+#include "ecbatch_NIST256.h"
+
+#define L8(x) {x, x, x, x, x, x, x, x}
+
+/* Curve constant b, in every lane, in FPB Montgomery form */
+static const FPB_NIST256 B = {{L8(0xDF6229C4BDDFDULL), L8(0xCA8843090D89CULL), L8(0x212ED6ACF005CULL), L8(0x83415A220ABF7ULL), L8(0x0C30061DD4874ULL)}};
+
+void ECPB_NIST256_inf(ECPB_NIST256 *P)
+{
+    FPB_NIST256_zero(&P->x);
+    FPB_NIST256_one(&P->y);
+    FPB_NIST256_zero(&P->z);
+}
+
+void ECPB_NIST256_copy(ECPB_NIST256 *P, const ECPB_NIST256 *Q)
+{
+    FPB_NIST256_copy(&P->x, &Q->x);
+    FPB_NIST256_copy(&P->y, &Q->y);
+    FPB_NIST256_copy(&P->z, &Q->z);
+}
+
+void ECPB_NIST256_cmove(ECPB_NIST256 *P, const ECPB_NIST256 *Q, const unsign64 *mask)
+{
+    FPB_NIST256_cmove(&P->x, &Q->x, mask);
+    FPB_NIST256_cmove(&P->y, &Q->y, mask);
+    FPB_NIST256_cmove(&P->z, &Q->z, mask);
+}
+
+void ECPB_NIST256_set(ECPB_NIST256 *P, int i, const ECP64_NIST256 *Q)
+{
+    FPB_NIST256_set(&P->x, i, &Q->x);
+    FPB_NIST256_set(&P->y, i, &Q->y);
+    FPB_NIST256_set(&P->z, i, &Q->z);
+}
+
+void ECPB_NIST256_get(ECP64_NIST256 *Q, const ECPB_NIST256 *P, int i)
+{
+    FPB_NIST256_get(&Q->x, &P->x, i);
+    FPB_NIST256_get(&Q->y, &P->y, i);
+    FPB_NIST256_get(&Q->z, &P->z, i);
+}
+
+void ECPB_NIST256_dbl(ECPB_NIST256 *P)
+{
+    FPB_NIST256 t0, t1, t2, t3, x3, y3, z3;
+
+    FPB_NIST256_sqr(&t0, &P->x);          /* 1 */
+    FPB_NIST256_sqr(&t1, &P->y);          /* 2 */
+    FPB_NIST256_sqr(&t2, &P->z);          /* 3 */
+    FPB_NIST256_mul(&t3, &P->x, &P->y);   /* 4 */
+    FPB_NIST256_add(&t3, &t3, &t3);       /* 5 */
+    FPB_NIST256_mul(&z3, &P->x, &P->z);   /* 6 */
+    FPB_NIST256_add(&z3, &z3, &z3);       /* 7 */
+    FPB_NIST256_mul(&y3, &B, &t2);        /* 8 */
+    FPB_NIST256_sub(&y3, &y3, &z3);       /* 9 */
+    FPB_NIST256_add(&x3, &y3, &y3);       /* 10 */
+    FPB_NIST256_add(&y3, &x3, &y3);       /* 11 */
+    FPB_NIST256_sub(&x3, &t1, &y3);       /* 12 */
+    FPB_NIST256_add(&y3, &t1, &y3);       /* 13 */
+    FPB_NIST256_mul(&y3, &x3, &y3);       /* 14 */
+    FPB_NIST256_mul(&x3, &x3, &t3);       /* 15 */
+    FPB_NIST256_add(&t3, &t2, &t2);       /* 16 */
+    FPB_NIST256_add(&t2, &t2, &t3);       /* 17 */
+    FPB_NIST256_mul(&z3, &B, &z3);        /* 18 */
+    FPB_NIST256_sub(&z3, &z3, &t2);       /* 19 */
+    FPB_NIST256_sub(&z3, &z3, &t0);       /* 20 */
+    FPB_NIST256_add(&t3, &z3, &z3);       /* 21 */
+    FPB_NIST256_add(&z3, &z3, &t3);       /* 22 */
+    FPB_NIST256_add(&t3, &t0, &t0);       /* 23 */
+    FPB_NIST256_add(&t0, &t3, &t0);       /* 24 */
+    FPB_NIST256_sub(&t0, &t0, &t2);       /* 25 */
+    FPB_NIST256_mul(&t0, &t0, &z3);       /* 26 */
+    FPB_NIST256_add(&y3, &y3, &t0);       /* 27 */
+    FPB_NIST256_mul(&t0, &P->y, &P->z);   /* 28 */
+    FPB_NIST256_add(&t0, &t0, &t0);       /* 29 */
+    FPB_NIST256_mul(&z3, &t0, &z3);       /* 30 */
+    FPB_NIST256_sub(&P->x, &x3, &z3);     /* 31 */
+    FPB_NIST256_mul(&z3, &t0, &t1);       /* 32 */
+    FPB_NIST256_add(&z3, &z3, &z3);       /* 33 */
+    FPB_NIST256_add(&z3, &z3, &z3);       /* 34 */
+    FPB_NIST256_copy(&P->y, &y3);
+    FPB_NIST256_copy(&P->z, &z3);
+}
+
+void ECPB_NIST256_add(ECPB_NIST256 *P, const ECPB_NIST256 *Q)
+{
+    FPB_NIST256 t0, t1, t2, t3, t4, x3, y3, z3;
+
+    FPB_NIST256_mul(&t0, &P->x, &Q->x);   /* 1 */
+    FPB_NIST256_mul(&t1, &P->y, &Q->y);   /* 2 */
+    FPB_NIST256_mul(&t2, &P->z, &Q->z);   /* 3 */
+    FPB_NIST256_add(&t3, &P->x, &P->y);   /* 4 */
+    FPB_NIST256_add(&t4, &Q->x, &Q->y);   /* 5 */
+    FPB_NIST256_mul(&t3, &t3, &t4);       /* 6 */
+    FPB_NIST256_add(&t4, &t0, &t1);       /* 7 */
+    FPB_NIST256_sub(&t3, &t3, &t4);       /* 8 */
+    FPB_NIST256_add(&t4, &P->y, &P->z);   /* 9 */
+    FPB_NIST256_add(&x3, &Q->y, &Q->z);   /* 10 */
+    FPB_NIST256_mul(&t4, &t4, &x3);       /* 11 */
+    FPB_NIST256_add(&x3, &t1, &t2);       /* 12 */
+    FPB_NIST256_sub(&t4, &t4, &x3);       /* 13 */
+    FPB_NIST256_add(&x3, &P->x, &P->z);   /* 14 */
+    FPB_NIST256_add(&y3, &Q->x, &Q->z);   /* 15 */
+    FPB_NIST256_mul(&x3, &x3, &y3);       /* 16 */
+    FPB_NIST256_add(&y3, &t0, &t2);       /* 17 */
+    FPB_NIST256_sub(&y3, &x3, &y3);       /* 18 */
+    FPB_NIST256_mul(&z3, &B, &t2);        /* 19 */
+    FPB_NIST256_sub(&x3, &y3, &z3);       /* 20 */
+    FPB_NIST256_add(&z3, &x3, &x3);       /* 21 */
+    FPB_NIST256_add(&x3, &x3, &z3);       /* 22 */
+    FPB_NIST256_sub(&z3, &t1, &x3);       /* 23 */
+    FPB_NIST256_add(&x3, &t1, &x3);       /* 24 */
+    FPB_NIST256_mul(&y3, &B, &y3);        /* 25 */
+    FPB_NIST256_add(&t1, &t2, &t2);       /* 26 */
+    FPB_NIST256_add(&t2, &t1, &t2);       /* 27 */
+    FPB_NIST256_sub(&y3, &y3, &t2);       /* 28 */
+    FPB_NIST256_sub(&y3, &y3, &t0);       /* 29 */
+    FPB_NIST256_add(&t1, &y3, &y3);       /* 30 */
+    FPB_NIST256_add(&y3, &t1, &y3);       /* 31 */
+    FPB_NIST256_add(&t1, &t0, &t0);       /* 32 */
+    FPB_NIST256_add(&t0, &t1, &t0);       /* 33 */
+    FPB_NIST256_sub(&t0, &t0, &t2);       /* 34 */
+    FPB_NIST256_mul(&t1, &t4, &y3);       /* 35 */
+    FPB_NIST256_mul(&t2, &t0, &y3);       /* 36 */
+    FPB_NIST256_mul(&y3, &x3, &z3);       /* 37 */
+    FPB_NIST256_add(&P->y, &y3, &t2);     /* 38 */
+    FPB_NIST256_mul(&x3, &t3, &x3);       /* 39 */
+    FPB_NIST256_sub(&P->x, &x3, &t1);     /* 40 */
+    FPB_NIST256_mul(&z3, &t4, &z3);       /* 41 */
+    FPB_NIST256_mul(&t1, &t3, &t0);       /* 42 */
+    FPB_NIST256_add(&P->z, &z3, &t1);     /* 43 */
+}
+
+void ECPB_NIST256_add_affine(ECPB_NIST256 *P, const ECPB_NIST256_AFFINE *Q)
+{
+    FPB_NIST256 t0, t1, t2, t3, t4, x3, y3, z3;
+
+    FPB_NIST256_mul(&t0, &P->x, &Q->x);   /* 1 */
+    FPB_NIST256_mul(&t1, &P->y, &Q->y);   /* 2 */
+    FPB_NIST256_add(&t3, &Q->x, &Q->y);   /* 3 */
+    FPB_NIST256_add(&t4, &P->x, &P->y);   /* 4 */
+    FPB_NIST256_mul(&t3, &t3, &t4);       /* 5 */
+    FPB_NIST256_add(&t4, &t0, &t1);       /* 6 */
+    FPB_NIST256_sub(&t3, &t3, &t4);       /* 7 */
+    FPB_NIST256_mul(&t4, &Q->y, &P->z);   /* 8 */
+    FPB_NIST256_add(&t4, &t4, &P->y);     /* 9 */
+    FPB_NIST256_mul(&y3, &Q->x, &P->z);   /* 10 */
+    FPB_NIST256_add(&y3, &y3, &P->x);     /* 11 */
+    FPB_NIST256_mul(&z3, &B, &P->z);      /* 12 */
+    FPB_NIST256_sub(&x3, &y3, &z3);       /* 13 */
+    FPB_NIST256_add(&z3, &x3, &x3);       /* 14 */
+    FPB_NIST256_add(&x3, &x3, &z3);       /* 15 */
+    FPB_NIST256_sub(&z3, &t1, &x3);       /* 16 */
+    FPB_NIST256_add(&x3, &t1, &x3);       /* 17 */
+    FPB_NIST256_mul(&y3, &B, &y3);        /* 18 */
+    FPB_NIST256_add(&t1, &P->z, &P->z);   /* 19 */
+    FPB_NIST256_add(&t2, &t1, &P->z);     /* 20 */
+    FPB_NIST256_sub(&y3, &y3, &t2);       /* 21 */
+    FPB_NIST256_sub(&y3, &y3, &t0);       /* 22 */
+    FPB_NIST256_add(&t1, &y3, &y3);       /* 23 */
+    FPB_NIST256_add(&y3, &t1, &y3);       /* 24 */
+    FPB_NIST256_add(&t1, &t0, &t0);       /* 25 */
+    FPB_NIST256_add(&t0, &t1, &t0);       /* 26 */
+    FPB_NIST256_sub(&t0, &t0, &t2);       /* 27 */
+    FPB_NIST256_mul(&t1, &t4, &y3);       /* 28 */
+    FPB_NIST256_mul(&t2, &t0, &y3);       /* 29 */
+    FPB_NIST256_mul(&y3, &x3, &z3);       /* 30 */
+    FPB_NIST256_add(&P->y, &y3, &t2);     /* 31 */
+    FPB_NIST256_mul(&x3, &t3, &x3);       /* 32 */
+    FPB_NIST256_sub(&P->x, &x3, &t1);     /* 33 */
+    FPB_NIST256_mul(&z3, &t4, &z3);       /* 34 */
+    FPB_NIST256_mul(&t1, &t3, &t0);       /* 35 */
+    FPB_NIST256_add(&P->z, &z3, &t1);     /* 36 */
+}
+
+void ECPB_NIST256_select(ECPB_NIST256 *P, const ECPB_NIST256 T[], const sign32 *d)
+{
+    FPB_NIST256 ny;
+    unsign64 neg[FPB_NIST256_LANES];
+
+    for (int i = 0; i < FPB_NIST256_LANES; i++)
+    {
+        const ECPB_NIST256 *Q = &T[d[i] == 0 ? 0 : (d[i] < 0 ? -d[i] : d[i]) - 1];
+
+        for (int j = 0; j < FPB_NIST256_LIMBS; j++)
+        {
+            P->x.v[j][i] = Q->x.v[j][i];
+            P->y.v[j][i] = Q->y.v[j][i];
+            P->z.v[j][i] = Q->z.v[j][i];
+        }
+        neg[i] = d[i] < 0 ? ~(unsign64)0 : 0;
+    }
+    FPB_NIST256_neg(&ny, &P->y);
+    FPB_NIST256_cmove(&P->y, &ny, neg);
+}
+
+void ECPB_NIST256_affine(ECPB_NIST256 *P)
+{
+    ECPB_NIST256 A;
+    FPB_NIST256 zi;
+    unsign64 inf[FPB_NIST256_LANES];
+
+    FPB_NIST256_iszilch(inf, &P->z);
+    FPB_NIST256_inv(&zi, &P->z);
+    FPB_NIST256_mul(&A.x, &P->x, &zi);
+    FPB_NIST256_mul(&A.y, &P->y, &zi);
+    FPB_NIST256_one(&A.z);
+    for (int i = 0; i < FPB_NIST256_LANES; i++) inf[i] = ~inf[i];
+    ECPB_NIST256_cmove(P, &A, inf);
+}
+
+void ECPB_NIST256_mulgen(ECPB_NIST256 *P, BIG_256_56 e[])
+{
+    char b[MODBYTES_256_56];
+    sign32 d[ECGEN_NIST256_WINDOWS][FPB_NIST256_LANES];
+    ECPB_NIST256_AFFINE T;
+    ECPB_NIST256 S;
+    ECP64_NIST256_AFFINE G;
+    unsign64 nz[FPB_NIST256_LANES];
+
+    /* Signed 4-bit recoding of every scalar, as in ECP64_NIST256_mulgen */
+    for (int l = 0; l < FPB_NIST256_LANES; l++)
+    {
+        sign32 t, carry = 0;
+
+        BIG_256_56_toBytes(b, e[l]);
+        for (int i = 0; i < ECGEN_NIST256_WINDOWS - 1; i++)
+        {
+            t = ((b[MODBYTES_256_56 - 1 - i / 2] & 0xff) >> (4 * (i & 1))) & 0xf;
+            t += carry;
+            carry = (t + 8) >> 4;
+            d[i][l] = t - (carry << 4);
+        }
+        d[ECGEN_NIST256_WINDOWS - 1][l] = carry;
+    }
+
+    ECPB_NIST256_inf(P);
+    for (int i = 0; i < ECGEN_NIST256_WINDOWS; i++)
+    {
+        for (int l = 0; l < FPB_NIST256_LANES; l++)
+        {
+            ECP64_NIST256_gselect(&G, i, d[i][l]);
+            FPB_NIST256_set(&T.x, l, &G.x);
+            FPB_NIST256_set(&T.y, l, &G.y);
+            /* All ones unless the digit is zero */
+            nz[l] = 0 - (unsign64)(((unsign32)d[i][l] | (0 - (unsign32)d[i][l])) >> 31);
+        }
+        ECPB_NIST256_copy(&S, P);
+        ECPB_NIST256_add_affine(&S, &T);
+        ECPB_NIST256_cmove(P, &S, nz);
+    }
+
+    for (int i = 0; i < MODBYTES_256_56; i++) b[i] = 0;
+    for (int i = 0; i < ECGEN_NIST256_WINDOWS; i++)
+        for (int l = 0; l < FPB_NIST256_LANES; l++) d[i][l] = 0;
+}
+
+void ECP64_NIST256_mulgen_batch(int n, ECP64_NIST256 P[], BIG_256_56 e[])
+{
+    BIG_256_56 g[FPB_NIST256_LANES];
+    ECPB_NIST256 R;
+
+    if (!FPB_NIST256_simd_active())
+    {
+        for (int i = 0; i < n; i++) ECP64_NIST256_mulgen(&P[i], e[i]);
+        ECP64_NIST256_affine_batch(n, P);
+        return;
+    }
+
+    for (int i = 0; i < n; i += FPB_NIST256_LANES)
+    {
+        /* A short final group repeats its last scalar in the spare lanes */
+        for (int l = 0; l < FPB_NIST256_LANES; l++)
+            BIG_256_56_copy(g[l], e[i + l < n ? i + l : n - 1]);
+        ECPB_NIST256_mulgen(&R, g);
+        for (int l = 0; l < FPB_NIST256_LANES && i + l < n; l++) ECPB_NIST256_get(&P[i + l], &R, l);
+    }
+    ECP64_NIST256_affine_batch(n, P);
+
+    for (int l = 0; l < FPB_NIST256_LANES; l++) BIG_256_56_zero(g[l]);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file ecpb_NIST256.h
+ * @brief Eight-lane batch NIST256 point arithmetic over FPB_NIST256
+ *
+ * Eight independent points, each lane in the same homogeneous projective
+ * coordinates and complete Renes-Costello-Batina formulas as
+ * ECP64_NIST256. Because the formulas have no exceptional cases, every
+ * lane runs exactly the same sequence of field operations, whatever its
+ * point, so one FPB_NIST256 operation serves all eight.
+ */
+
+#ifndef ECPB_NIST256_H
+#define ECPB_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+#include "ecp64_NIST256.h"
+#include "fpb_NIST256.h"
+
+/**
+	@brief Eight NIST256 points in projective coordinates over FPB_NIST256
+*/
+typedef struct
+{
+    FPB_NIST256 x;  /**< x-coordinates of the points */
+    FPB_NIST256 y;  /**< y-coordinates of the points */
+    FPB_NIST256 z;  /**< z-coordinates of the points */
+} ECPB_NIST256;
+
+/**
+	@brief Eight affine NIST256 points, none the point at infinity
+*/
+typedef struct
+{
+    FPB_NIST256 x;  /**< x-coordinates of the points */
+    FPB_NIST256 y;  /**< y-coordinates of the points */
+} ECPB_NIST256_AFFINE;
+
+/**	@brief Set all lanes to point-at-infinity
+ *
+	@param P ECPB instance to be set to infinity
+ */
+extern void ECPB_NIST256_inf(ECPB_NIST256 *P);
+/**	@brief Copy ECPB points to another ECPB
+ *
+	@param P ECPB instance, on exit = Q
+	@param Q ECPB instance to be copied
+ */
+extern void ECPB_NIST256_copy(ECPB_NIST256 *P, const ECPB_NIST256 *Q);
+/**	@brief Per-lane conditional copy of ECPB points
+ *
+	Copies lane i of Q to P where mask[i] is all ones, without branching
+	@param P ECPB instance
+	@param Q another ECPB instance
+	@param mask per-lane masks, each 0 or all ones
+ */
+extern void ECPB_NIST256_cmove(ECPB_NIST256 *P, const ECPB_NIST256 *Q, const unsign64 *mask);
+/**	@brief Loads one lane from an ECP64 point
+ *
+	@param P ECPB instance, lane i on exit = Q
+	@param i the lane, 0 <= i < FPB_NIST256_LANES
+	@param Q ECP64 instance
+ */
+extern void ECPB_NIST256_set(ECPB_NIST256 *P, int i, const ECP64_NIST256 *Q);
+/**	@brief Reads one lane as an ECP64 point
+ *
+	@param Q ECP64 instance, on exit = lane i of P
+	@param P ECPB instance
+	@param i the lane, 0 <= i < FPB_NIST256_LANES
+ */
+extern void ECPB_NIST256_get(ECP64_NIST256 *Q, const ECPB_NIST256 *P, int i);
+/**	@brief Lane-wise doubling of an ECPB instance P
+ *
+	@param P ECPB instance, on exit =2*P
+ */
+extern void ECPB_NIST256_dbl(ECPB_NIST256 *P);
+/**	@brief Lane-wise addition of ECPB instance Q to ECPB instance P
+ *
+	@param P ECPB instance, on exit =P+Q
+	@param Q ECPB instance to be added to P
+ */
+extern void ECPB_NIST256_add(ECPB_NIST256 *P, const ECPB_NIST256 *Q);
+/**	@brief Lane-wise addition of affine points Q to ECPB instance P
+ *
+	Mixed addition, cheaper than ECPB_NIST256_add. Complete for any P.
+	@param P ECPB instance, on exit =P+Q
+	@param Q affine points to be added to P, none infinity
+ */
+extern void ECPB_NIST256_add_affine(ECPB_NIST256 *P, const ECPB_NIST256_AFFINE *Q);
+/**	@brief Lane-wise signed lookup in tables of small multiples, variable time
+ *
+	For public digits only: the table index depends on d[i].
+	@param P ECPB instance, on exit lane i = d[i].Q, or an arbitrary table point if d[i] = 0
+	@param T table with T[k] = (k+1).Q in each lane, for 0 <= k < max |d[i]|
+	@param d per-lane signed digits
+ */
+extern void ECPB_NIST256_select(ECPB_NIST256 *P, const ECPB_NIST256 T[], const sign32 *d);
+/**	@brief Converts all lanes from Projective to affine coordinates
+ *
+	One FPB_NIST256_inv for all eight lanes. Lanes at infinity are left as they are.
+	@param P ECPB instance to be converted to affine form
+ */
+extern void ECPB_NIST256_affine(ECPB_NIST256 *P);
+/**	@brief Multiplies the curve generator by eight scalars, P[i]=e[i]*G, side-channel resistant
+ *
+	The fixed-base comb of ECP64_NIST256_mulgen, with lane i driven by e[i].
+	@param P ECPB instance, on exit lane i =e[i]*G
+	@param e FPB_NIST256_LANES BIG number multipliers, each 0 <= e[i] < 2^256
+ */
+extern void ECPB_NIST256_mulgen(ECPB_NIST256 *P, BIG_256_56 e[]);
+/**	@brief Multiplies the curve generator by n scalars, P[i]=e[i]*G, side-channel resistant
+ *
+	Runs ECPB_NIST256_mulgen eight scalars at a time when the IFMA kernels
+	are in use. Otherwise calls ECP64_NIST256_mulgen for each scalar, which
+	is faster than the portable lanes. Either way the affine conversion is
+	one ECP64_NIST256_affine_batch, a single inversion for all n points.
+	@param n the number of scalars
+	@param P array of n ECP64 instances, on exit P[i] =e[i]*G in affine form
+	@param e array of n BIG number multipliers, each 0 <= e[i] < 2^256
+ */
+extern void ECP64_NIST256_mulgen_batch(int n, ECP64_NIST256 P[], BIG_256_56 e[]);
+
+#endif
@@ -0,0 +1,79 @@
+/**
+ * ecpool_NIST256.c - Pool of pre-generated NIST256 ephemeral key pairs
+ *
+ * Each ring entry is a private key followed by its uncompressed public key.
+ */
+
+#include <string.h>
+
+#include "ecpool_NIST256.h"
+#include "ecc_NIST256.h"
+
+#define ECC_NIST256_POOL_WLEN (2 * EFS_NIST256 + 1)
+#define ECC_NIST256_POOL_ENTRY (EGS_NIST256 + ECC_NIST256_POOL_WLEN)
+
+static int ECC_NIST256_POOL_fill(void *arg, csprng *R, int n, char *out)
+{
+    char s[ECC_NIST256_RING_BATCH * EGS_NIST256], w[ECC_NIST256_RING_BATCH * ECC_NIST256_POOL_WLEN];
+    octet S = {0, sizeof(s), s};
+    octet W = {0, sizeof(w), w};
+    int i, res;
+
+    (void)arg;
+    res = ECC_NIST256_KEY_PAIR_GENERATE_BATCH(R, n, &S, &W);
+    if (res == 0)
+    {
+        for (i = 0; i < n; i++)
+        {
+            memcpy(&out[i * ECC_NIST256_POOL_ENTRY], &s[i * EGS_NIST256], EGS_NIST256);
+            memcpy(&out[i * ECC_NIST256_POOL_ENTRY + EGS_NIST256], &w[i * ECC_NIST256_POOL_WLEN], ECC_NIST256_POOL_WLEN);
+        }
+    }
+    memset(s, 0, sizeof(s));
+    return res;
+}
+
+ECC_NIST256_POOL *ECC_NIST256_POOL_NEW(csprng *R, int size)
+{
+    return ECC_NIST256_RING_NEW(R, size, ECC_NIST256_POOL_ENTRY, ECC_NIST256_POOL_fill, NULL);
+}
+
+void ECC_NIST256_POOL_FREE(ECC_NIST256_POOL *P)
+{
+    ECC_NIST256_RING_FREE(P);
+}
+
+int ECC_NIST256_POOL_KEY_PAIR(ECC_NIST256_POOL *P, csprng *R, octet *S, octet *W)
+{
+    char e[ECC_NIST256_POOL_ENTRY];
+
+    if (P != NULL && ECC_NIST256_RING_TAKE(P, e))
+    {
+        S->len = EGS_NIST256;
+        W->len = ECC_NIST256_POOL_WLEN;
+        memcpy(S->val, e, EGS_NIST256);
+        memcpy(W->val, &e[EGS_NIST256], ECC_NIST256_POOL_WLEN);
+        memset(e, 0, sizeof(e));
+        return 0;
+    }
+    if (R == NULL) return ECDH_ERROR;
+    return ECC_NIST256_KEY_PAIR_GENERATE(R, S, W);
+}
+
+int ECC_NIST256_POOL_ECDH_ES(ECC_NIST256_POOL *P, csprng *R, octet *WD, octet *Z, octet *E)
+{
+    char s[EGS_NIST256];
+    octet S = {0, sizeof(s), s};
+    int res;
+
+    res = ECC_NIST256_POOL_KEY_PAIR(P, R, &S, E);
+    if (res == 0) res = ECP_NIST256_SVDP_DH(&S, WD, Z, 0);
+
+    OCT_clear(&S);
+    return res;
+}
+
+void ECC_NIST256_POOL_GET_STATS(ECC_NIST256_POOL *P, ECC_NIST256_POOL_STATS *S)
+{
+    ECC_NIST256_RING_GET_STATS(P, S);
+}
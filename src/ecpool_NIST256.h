@@ -0,0 +1,83 @@
+/**
+ * @file ecpool_NIST256.h
+ * @brief Pool of pre-generated NIST256 ephemeral key pairs
+ *
+ * ECDH-ES (JWE) and HPKE senders need a fresh ephemeral key pair for
+ * every message, and generating it inline puts a fixed-base scalar
+ * multiplication on the request path. A pool is an ECC_NIST256_RING of
+ * ready key pairs that its thread refills with
+ * ECC_NIST256_KEY_PAIR_GENERATE_BATCH, so a sender only pays for the
+ * shared-secret computation. Each key pair is handed out exactly once,
+ * also across fork(), whose child refills the pool afresh rather than
+ * share the parent's keys; when the pool is empty the caller's RNG
+ * generates one inline.
+ *
+ * cjose generates its ECDH-ES ephemeral key inside cjose_jwe_encrypt,
+ * with no way to supply one, so a pool serves callers that do the key
+ * agreement through ECC_NIST256_POOL_ECDH_ES.
+ */
+
+#ifndef ECPOOL_NIST256_H
+#define ECPOOL_NIST256_H
+
+#include "core.h"
+#include "ecdh_NIST256.h"
+#include "ecring_NIST256.h"
+
+/**
+	@brief Pool of NIST256 ephemeral key pairs, opaque
+*/
+typedef struct ECC_NIST256_RING ECC_NIST256_POOL;
+
+/**
+	@brief Snapshot of a pool's counters
+*/
+typedef ECC_NIST256_RING_STATS ECC_NIST256_POOL_STATS;
+
+/**	@brief Create a pool and start its refill thread
+ *
+	The pool's own RNG is seeded from R, which is only used during this call.
+	@param R is a pointer to a cryptographically secure random number generator
+	@param size the capacity of the pool, rounded up to a power of 2
+	@return the new pool, or NULL on failure
+ */
+extern ECC_NIST256_POOL *ECC_NIST256_POOL_NEW(csprng *R, int size);
+/**	@brief Stop the refill thread, wipe every key pair left and free the pool
+ *
+	No other thread may be using the pool.
+	@param P the pool, may be NULL
+ */
+extern void ECC_NIST256_POOL_FREE(ECC_NIST256_POOL *P);
+/**	@brief Take an ephemeral key pair from the pool
+ *
+	Same outputs as ECC_NIST256_KEY_PAIR_GENERATE(R, s, W). If the pool is
+	empty, the key pair is generated inline with R instead.
+	@param P the pool, or NULL to always generate inline
+	@param R is a pointer to a cryptographically secure random number generator, used only on a miss
+	@param s the output private key
+	@param W the output public key
+	@return 0, or ECDH_ERROR if the pool is empty and R=NULL
+ */
+extern int ECC_NIST256_POOL_KEY_PAIR(ECC_NIST256_POOL *P, csprng *R, octet *s, octet *W);
+/**	@brief ECDH-ES sender side with a pooled ephemeral key
+ *
+	Takes a key pair as ECC_NIST256_POOL_KEY_PAIR does, computes the shared
+	secret with ECP_NIST256_SVDP_DH and wipes the private key.
+	@param P the pool, or NULL to always generate inline
+	@param R is a pointer to a cryptographically secure random number generator, used only on a miss
+	@param WD the recipient's public key
+	@param Z the output shared secret, the x-coordinate of s.WD
+	@param E the output ephemeral public key, for the "epk" header
+	@return 0 or an error code
+ */
+extern int ECC_NIST256_POOL_ECDH_ES(ECC_NIST256_POOL *P, csprng *R, octet *WD, octet *Z, octet *E);
+/**	@brief Read a pool's counters
+ *
+	The fields are read one at a time while other threads keep running,
+	so they are consistent only to within a few operations.
+	@param P the pool
+	@param S on exit the counters
+ */
+extern void ECC_NIST256_POOL_GET_STATS(ECC_NIST256_POOL *P, ECC_NIST256_POOL_STATS *S);
+
+#endif
@@ -0,0 +1,332 @@
+/**
+ * ecring_NIST256.c - Background-refilled ring of single-use precomputed values
+ *
+ * The ring is a bounded queue with one producer, the refill thread, and
+ * any number of consumers. Each slot carries a sequence number: a slot
+ * holds the entry for position pos when seq = pos+1, and is free for
+ * position pos when seq = pos. A consumer claims position head by a
+ * compare-and-swap on head, copies and wipes the slot, then releases it
+ * for position head+size. A position is claimed by one consumer only, so
+ * no entry is handed out twice.
+ *
+ * A child of fork() inherits every ready entry, the refill thread's RNG
+ * state but not the thread, and possibly a locked mutex. A pthread_atfork
+ * handler counts forks in the child, and a ring made before the last fork
+ * is reset on its next use there: entries wiped, RNG reseeded from
+ * /dev/urandom, lock and thread made anew. Without fresh entropy the ring
+ * stays empty, so every take misses to the caller's RNG.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "ecring_NIST256.h"
+
+#define ECC_NIST256_RING_SEED 128   /* Seed bytes for the ring's own RNG, from the caller's or after fork() from the OS */
+#define ECC_NIST256_RING_WAIT 10    /* Milliseconds the refill thread sleeps when the ring is full or a fill fails */
+
+struct ECC_NIST256_RING
+{
+    char *slots;        /* size slots of stride bytes, each a sequence number then the entry */
+    char *buf;          /* The refill thread's output buffer */
+    size_t stride;
+    unsign64 mask;
+    unsign64 head;      /* Next position to take, advanced by consumers */
+    unsign64 tail;      /* Next position to fill, advanced by the refill thread */
+    unsign64 hits;
+    unsign64 misses;
+    unsign64 filled;
+    unsign64 forks;     /* ECC_NIST256_RING_forks when the ring was made or last reset */
+    int size;
+    int len;
+    int running;
+    int refilling;      /* 1 if this process has a refill thread for the ring */
+    ECC_NIST256_RING_FILL fill;
+    void *arg;
+    csprng rng;         /* Used by the refill thread only */
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+};
+
+/* Counted up in the child at each fork() once a ring exists; a ring holding an older count was inherited */
+static unsign64 ECC_NIST256_RING_forks = 0;
+static pthread_once_t ECC_NIST256_RING_once = PTHREAD_ONCE_INIT;
+/* Held across fork() so that no ring is mid-reset in the child */
+static pthread_mutex_t ECC_NIST256_RING_forklock = PTHREAD_MUTEX_INITIALIZER;
+
+static void ECC_NIST256_RING_prepare(void)
+{
+    pthread_mutex_lock(&ECC_NIST256_RING_forklock);
+}
+
+static void ECC_NIST256_RING_parent(void)
+{
+    pthread_mutex_unlock(&ECC_NIST256_RING_forklock);
+}
+
+static void ECC_NIST256_RING_child(void)
+{
+    ECC_NIST256_RING_forks++;
+    pthread_mutex_unlock(&ECC_NIST256_RING_forklock);
+}
+
+static void ECC_NIST256_RING_atfork(void)
+{
+    pthread_atfork(ECC_NIST256_RING_prepare, ECC_NIST256_RING_parent, ECC_NIST256_RING_child);
+}
+
+static unsign64 *ECC_NIST256_RING_seq(ECC_NIST256_RING *Q, unsign64 pos)
+{
+    return (unsign64 *)(Q->slots + (size_t)(pos & Q->mask) * Q->stride);
+}
+
+static unsign64 ECC_NIST256_RING_depth(ECC_NIST256_RING *Q)
+{
+    unsign64 h = __atomic_load_n(&Q->head, __ATOMIC_ACQUIRE);
+    unsign64 t = __atomic_load_n(&Q->tail, __ATOMIC_ACQUIRE);
+    return t > h ? t - h : 0;
+}
+
+/* Produce up to ECC_NIST256_RING_BATCH entries into free slots, returns the number added, or -1 if the fill failed */
+static int ECC_NIST256_RING_refill_batch(ECC_NIST256_RING *Q)
+{
+    unsign64 pos = Q->tail;
+    int i, n = 0;
+
+    /* Only this thread advances tail, so free slots stay free until it fills them */
+    while (n < ECC_NIST256_RING_BATCH && __atomic_load_n(ECC_NIST256_RING_seq(Q, pos + n), __ATOMIC_ACQUIRE) == pos + n) n++;
+    if (n == 0) return 0;
+
+    if (Q->fill(Q->arg, &Q->rng, n, Q->buf) != 0)
+    {
+        memset(Q->buf, 0, (size_t)n * Q->len);
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        unsign64 *seq = ECC_NIST256_RING_seq(Q, pos + i);
+        memcpy(seq + 1, Q->buf + (size_t)i * Q->len, Q->len);
+        __atomic_store_n(seq, pos + i + 1, __ATOMIC_RELEASE);
+    }
+    __atomic_store_n(&Q->tail, pos + n, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&Q->filled, (unsign64)n, __ATOMIC_RELAXED);
+
+    memset(Q->buf, 0, (size_t)n * Q->len);
+    return n;
+}
+
+static void *ECC_NIST256_RING_refill(void *arg)
+{
+    ECC_NIST256_RING *Q = (ECC_NIST256_RING *)arg;
+    struct timespec t;
+    int n;
+
+    while (__atomic_load_n(&Q->running, __ATOMIC_ACQUIRE))
+    {
+        n = ECC_NIST256_RING_refill_batch(Q);
+        if (n > 0) continue;
+
+        /* Full: sleep until a consumer drains it to half, or the timeout. After a failed
+           fill only the timeout ends the sleep, as misses would wake it straight away */
+        clock_gettime(CLOCK_REALTIME, &t);
+        t.tv_nsec += ECC_NIST256_RING_WAIT * 1000000L;
+        if (t.tv_nsec >= 1000000000L)
+        {
+            t.tv_sec++;
+            t.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&Q->lock);
+        if (n < 0)
+        {
+            while (__atomic_load_n(&Q->running, __ATOMIC_ACQUIRE) && pthread_cond_timedwait(&Q->wake, &Q->lock, &t) == 0) continue;
+        }
+        else if (__atomic_load_n(&Q->running, __ATOMIC_ACQUIRE) && ECC_NIST256_RING_depth(Q) > (unsign64)Q->size / 2)
+            pthread_cond_timedwait(&Q->wake, &Q->lock, &t);
+        pthread_mutex_unlock(&Q->lock);
+    }
+    return NULL;
+}
+
+/* Seeds the ring's RNG afresh from the OS, returns 1 on success */
+static int ECC_NIST256_RING_reseed(ECC_NIST256_RING *Q)
+{
+    char seed[ECC_NIST256_RING_SEED];
+    ssize_t r;
+    int fd, got = 0;
+
+    fd = open("/dev/urandom", O_RDONLY);
+    if (fd < 0) return 0;
+    while (got < ECC_NIST256_RING_SEED)
+    {
+        r = read(fd, seed + got, (size_t)(ECC_NIST256_RING_SEED - got));
+        if (r > 0) got += (int)r;
+        else if (r == 0 || errno != EINTR) break;
+    }
+    close(fd);
+    if (got == ECC_NIST256_RING_SEED)
+    {
+        RAND_clean(&Q->rng);
+        RAND_seed(&Q->rng, ECC_NIST256_RING_SEED, seed);
+    }
+    memset(seed, 0, sizeof(seed));
+    return got == ECC_NIST256_RING_SEED;
+}
+
+/* In a child of fork(), reset a ring made before the fork, restarting its refill thread if restart is set */
+static void ECC_NIST256_RING_adopt(ECC_NIST256_RING *Q, int restart)
+{
+    unsign64 i, pos;
+
+    pthread_mutex_lock(&ECC_NIST256_RING_forklock);
+    if (Q->forks != ECC_NIST256_RING_forks)
+    {
+        /* No thread of this process can be using the ring yet: every use comes through here first */
+        pthread_mutex_init(&Q->lock, NULL);
+        pthread_cond_init(&Q->wake, NULL);
+        pos = Q->head;
+        memset(Q->slots, 0, (size_t)Q->size * Q->stride);
+        for (i = 0; i < (unsign64)Q->size; i++) *ECC_NIST256_RING_seq(Q, pos + i) = pos + i;
+        Q->tail = pos;
+        memset(Q->buf, 0, (size_t)ECC_NIST256_RING_BATCH * Q->len);
+        Q->hits = Q->misses = Q->filled = 0;
+
+        Q->refilling = 0;
+        if (restart && __atomic_load_n(&Q->running, __ATOMIC_ACQUIRE) && ECC_NIST256_RING_reseed(Q) &&
+                pthread_create(&Q->thread, NULL, ECC_NIST256_RING_refill, Q) == 0)
+            Q->refilling = 1;
+        __atomic_store_n(&Q->forks, ECC_NIST256_RING_forks, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&ECC_NIST256_RING_forklock);
+}
+
+static int ECC_NIST256_RING_stale(ECC_NIST256_RING *Q)
+{
+    return __atomic_load_n(&Q->forks, __ATOMIC_ACQUIRE) != __atomic_load_n(&ECC_NIST256_RING_forks, __ATOMIC_RELAXED);
+}
+
+ECC_NIST256_RING *ECC_NIST256_RING_NEW(csprng *R, int size, int len, ECC_NIST256_RING_FILL fill, void *arg)
+{
+    ECC_NIST256_RING *Q;
+    char seed[ECC_NIST256_RING_SEED];
+    int i, n = 1;
+
+    if (R == NULL || size <= 0 || len <= 0 || fill == NULL) return NULL;
+    if (pthread_once(&ECC_NIST256_RING_once, ECC_NIST256_RING_atfork) != 0) return NULL;
+    while (n < size) n <<= 1;
+
+    Q = (ECC_NIST256_RING *)calloc(1, sizeof(ECC_NIST256_RING));
+    if (Q == NULL) return NULL;
+    Q->stride = sizeof(unsign64) + (((size_t)len + sizeof(unsign64) - 1) & ~(sizeof(unsign64) - 1));
+    Q->slots = (char *)calloc((size_t)n, Q->stride);
+    Q->buf = (char *)malloc((size_t)ECC_NIST256_RING_BATCH * len);
+    if (Q->slots == NULL || Q->buf == NULL)
+    {
+        free(Q->slots);
+        free(Q->buf);
+        free(Q);
+        return NULL;
+    }
+    Q->size = n;
+    Q->len = len;
+    Q->mask = (unsign64)n - 1;
+    Q->fill = fill;
+    Q->arg = arg;
+    for (i = 0; i < n; i++) *ECC_NIST256_RING_seq(Q, (unsign64)i) = (unsign64)i;
+
+    for (i = 0; i < ECC_NIST256_RING_SEED; i++) seed[i] = (char)RAND_byte(R);
+    RAND_seed(&Q->rng, ECC_NIST256_RING_SEED, seed);
+    memset(seed, 0, sizeof(seed));
+
+    Q->forks = __atomic_load_n(&ECC_NIST256_RING_forks, __ATOMIC_RELAXED);
+    Q->running = 1;
+    Q->refilling = 1;
+    pthread_mutex_init(&Q->lock, NULL);
+    pthread_cond_init(&Q->wake, NULL);
+    if (pthread_create(&Q->thread, NULL, ECC_NIST256_RING_refill, Q) != 0)
+    {
+        pthread_cond_destroy(&Q->wake);
+        pthread_mutex_destroy(&Q->lock);
+        RAND_clean(&Q->rng);
+        free(Q->slots);
+        free(Q->buf);
+        free(Q);
+        return NULL;
+    }
+    return Q;
+}
+
+void ECC_NIST256_RING_FREE(ECC_NIST256_RING *Q)
+{
+    if (Q == NULL) return;
+    if (ECC_NIST256_RING_stale(Q)) ECC_NIST256_RING_adopt(Q, 0);
+
+    pthread_mutex_lock(&Q->lock);
+    __atomic_store_n(&Q->running, 0, __ATOMIC_RELEASE);
+    pthread_cond_signal(&Q->wake);
+    pthread_mutex_unlock(&Q->lock);
+    if (Q->refilling) pthread_join(Q->thread, NULL);
+
+    pthread_cond_destroy(&Q->wake);
+    pthread_mutex_destroy(&Q->lock);
+    RAND_clean(&Q->rng);
+    memset(Q->slots, 0, (size_t)Q->size * Q->stride);
+    free(Q->slots);
+    free(Q->buf);
+    free(Q);
+}
+
+int ECC_NIST256_RING_TAKE(ECC_NIST256_RING *Q, char *out)
+{
+    unsign64 pos, seq, *slot;
+
+    if (ECC_NIST256_RING_stale(Q)) ECC_NIST256_RING_adopt(Q, 1);
+    pos = __atomic_load_n(&Q->head, __ATOMIC_RELAXED);
+    for (;;)
+    {
+        slot = ECC_NIST256_RING_seq(Q, pos);
+        seq = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+        if (seq == pos + 1)
+        {
+            if (__atomic_compare_exchange_n(&Q->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        }
+        else if (seq < pos + 1)
+        {
+            /* Empty, so have the refill thread catch up */
+            __atomic_fetch_add(&Q->misses, 1, __ATOMIC_RELAXED);
+            pthread_cond_signal(&Q->wake);
+            return 0;
+        }
+        else pos = __atomic_load_n(&Q->head, __ATOMIC_RELAXED);
+    }
+
+    memcpy(out, slot + 1, Q->len);
+    memset(slot + 1, 0, Q->len);
+    __atomic_store_n(slot, pos + (unsign64)Q->size, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&Q->hits, 1, __ATOMIC_RELAXED);
+    /* Wake the refill thread once the ring is half empty */
+    if (ECC_NIST256_RING_depth(Q) <= (unsign64)Q->size / 2) pthread_cond_signal(&Q->wake);
+    return 1;
+}
+
+void ECC_NIST256_RING_GET_STATS(ECC_NIST256_RING *Q, ECC_NIST256_RING_STATS *S)
+{
+    unsign64 taken;
+
+    if (ECC_NIST256_RING_stale(Q)) ECC_NIST256_RING_adopt(Q, 1);
+    S->size = Q->size;
+    S->depth = (int)ECC_NIST256_RING_depth(Q);
+    S->hits = __atomic_load_n(&Q->hits, __ATOMIC_RELAXED);
+    S->misses = __atomic_load_n(&Q->misses, __ATOMIC_RELAXED);
+    S->filled = __atomic_load_n(&Q->filled, __ATOMIC_RELAXED);
+    taken = S->hits + S->misses;
+    S->miss_rate = taken ? (double)S->misses / (double)taken : 0.0;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ecring_NIST256.h
+ * @brief Background-refilled ring of single-use precomputed values
+ *
+ * Ephemeral ECDH key pairs and ECDSA nonce tuples depend on nothing but
+ * fresh randomness, so they can be computed ahead of time, off the
+ * request path. A ring holds such entries, each a fixed number of bytes,
+ * and a background thread with its own RNG keeps it topped up through a
+ * fill callback, several entries per call so the callback can batch.
+ *
+ * Taking an entry is lock-free and safe from any number of threads. Each
+ * entry is handed out exactly once and wiped as it is taken. When the
+ * ring is empty the take fails and the miss is counted, so the caller
+ * can compute the entry inline instead.
+ *
+ * Exactly once holds across fork() too. In the child, the first use of a
+ * ring made before the fork wipes every entry and the counters, reseeds
+ * the ring's RNG from /dev/urandom and starts a new refill thread; if the
+ * reseed fails the ring stays empty and every take misses.
+ */
+
+#ifndef ECRING_NIST256_H
+#define ECRING_NIST256_H
+
+#include "core.h"
+
+#define ECC_NIST256_RING_BATCH 16  /**< Most entries produced per fill call */
+
+/**
+	@brief Fill callback: writes n entries one after another into out
+	@param arg the pointer given to ECC_NIST256_RING_NEW
+	@param R the refill thread's RNG
+	@param n the number of entries, 1 <= n <= ECC_NIST256_RING_BATCH
+	@param out n times the entry length bytes
+	@return 0, or an error code if no entry could be produced
+*/
+typedef int (*ECC_NIST256_RING_FILL)(void *arg, csprng *R, int n, char *out);
+
+/**
+	@brief Ring of precomputed entries, opaque
+*/
+typedef struct ECC_NIST256_RING ECC_NIST256_RING;
+
+/**
+	@brief Snapshot of a ring's counters
+*/
+typedef struct
+{
+    int size;         /**< Capacity of the ring */
+    int depth;        /**< Entries ready to be taken */
+    unsign64 hits;    /**< Entries taken from the ring */
+    unsign64 misses;  /**< Takes that found the ring empty */
+    unsign64 filled;  /**< Entries produced by the refill thread */
+    double miss_rate; /**< misses/(hits+misses), or 0 before the first take */
+} ECC_NIST256_RING_STATS;
+
+/**	@brief Create a ring and start its refill thread
+ *
+	The ring's own RNG is seeded from R, which is only used during this call.
+	@param R is a pointer to a cryptographically secure random number generator
+	@param size the capacity of the ring, rounded up to a power of 2
+	@param len the length of an entry in bytes
+	@param fill the callback that produces entries
+	@param arg passed to fill, and must outlive the ring
+	@return the new ring, or NULL on failure
+ */
+extern ECC_NIST256_RING *ECC_NIST256_RING_NEW(csprng *R, int size, int len, ECC_NIST256_RING_FILL fill, void *arg);
+/**	@brief Stop the refill thread, wipe every entry left and free the ring
+ *
+	No other thread may be using the ring.
+	@param Q the ring, may be NULL
+ */
+extern void ECC_NIST256_RING_FREE(ECC_NIST256_RING *Q);
+/**	@brief Take the oldest entry from the ring
+ *
+	@param Q the ring
+	@param out on exit the entry, if there was one
+	@return 1 if an entry was taken, 0 if the ring was empty
+ */
+extern int ECC_NIST256_RING_TAKE(ECC_NIST256_RING *Q, char *out);
+/**	@brief Read a ring's counters
+ *
+	The fields are read one at a time while other threads keep running,
+	so they are consistent only to within a few operations.
+	@param Q the ring
+	@param S on exit the counters
+ */
+extern void ECC_NIST256_RING_GET_STATS(ECC_NIST256_RING *Q, ECC_NIST256_RING_STATS *S);
+
+#endif
@@ -0,0 +1,504 @@
+/**
+ * fp64_NIST256.c - Full-radix Montgomery arithmetic modulo the P-256 prime
+ *
+ * p = 2^256 - 2^224 + 2^192 + 2^96 - 1 has limbs
+ *   p0 = 2^64-1, p1 = 2^32-1, p2 = 0, p3 = 2^64-2^32+1
+ * and -1/p = 1 mod 2^64. A Montgomery step on limb t_i therefore uses
+ * m = t_i, and t_i + m.p0 = m.2^64 exactly: the limb clears and m carries
+ * into the next one. Only m.p1 and m.p3 remain as real products.
+ */
+
+#include "fp64_NIST256.h"
+#ifdef NIST256_SAFEGCD
+#include "safegcd_NIST256.h"
+#endif
+
+#if defined(__x86_64__) && !defined(FP64_NIST256_NOASM)
+#define FP64_NIST256_ASM
+#include <cpuid.h>
+#endif
+
+typedef unsigned __int128 u128;
+
+static const unsign64 P[4] = {0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFFULL, 0x0000000000000000ULL, 0xFFFFFFFF00000001ULL};
+
+/* 2^256 mod p, the Montgomery form of 1 */
+static const unsign64 ONE[4] = {0x0000000000000001ULL, 0xFFFFFFFF00000000ULL, 0xFFFFFFFFFFFFFFFFULL, 0x00000000FFFFFFFEULL};
+
+/* 2^512 mod p, converts into Montgomery form */
+static const unsign64 R2[4] = {0x0000000000000003ULL, 0xFFFFFFFBFFFFFFFFULL, 0xFFFFFFFFFFFFFFFEULL, 0x00000004FFFFFFFDULL};
+
+#ifdef NIST256_SAFEGCD
+/* 2^768 mod p, takes the plain inverse of a Montgomery residue back into Montgomery form */
+static const FP64_NIST256 R3 = {{0xFFFFFFFD0000000AULL, 0xFFFFFFEDFFFFFFF7ULL, 0x00000005FFFFFFFCULL, 0x0000001800000001ULL}};
+#endif
+
+/* r = (r + top.2^256) mod p, for r + top.2^256 < 2p */
+static void FP64_NIST256_csub(unsign64 *r, unsign64 top)
+{
+    unsign64 s[4], b = 0, mask;
+    u128 x;
+
+    for (int i = 0; i < 4; i++)
+    {
+        x = (u128)r[i] - P[i] - b;
+        s[i] = (unsign64)x;
+        b = (unsign64)(x >> 64) & 1;
+    }
+    /* r >= p exactly when the subtraction did not borrow, or there was a carry out */
+    mask = (top ^ b) - 1;
+    for (int i = 0; i < 4; i++) r[i] = (s[i] & mask) | (r[i] & ~mask);
+}
+
+/* r = t/2^256 mod p, for t < p.2^256 */
+static void FP64_NIST256_redc(unsign64 *r, unsign64 *t)
+{
+    unsign64 m, c, top = 0;
+    u128 x;
+
+    for (int i = 0; i < 4; i++)
+    {
+        m = t[i];
+        x = (u128)m * P[1] + t[i + 1] + m;
+        t[i + 1] = (unsign64)x;
+        c = (unsign64)(x >> 64);
+        x = (u128)t[i + 2] + c;
+        t[i + 2] = (unsign64)x;
+        c = (unsign64)(x >> 64);
+        x = (u128)m * P[3] + t[i + 3] + c;
+        t[i + 3] = (unsign64)x;
+        c = (unsign64)(x >> 64);
+        for (int j = i + 4; j < 8; j++)
+        {
+            x = (u128)t[j] + c;
+            t[j] = (unsign64)x;
+            c = (unsign64)(x >> 64);
+        }
+        top += c;
+    }
+    for (int i = 0; i < 4; i++) r[i] = t[i + 4];
+    FP64_NIST256_csub(r, top);
+}
+
+/* t = a.b, 512-bit product */
+static void FP64_NIST256_mul4_c(unsign64 *t, const unsign64 *a, const unsign64 *b)
+{
+    unsign64 c;
+    u128 x;
+
+    for (int i = 0; i < 8; i++) t[i] = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        c = 0;
+        for (int j = 0; j < 4; j++)
+        {
+            x = (u128)a[j] * b[i] + t[i + j] + c;
+            t[i + j] = (unsign64)x;
+            c = (unsign64)(x >> 64);
+        }
+        t[i + 4] = c;
+    }
+}
+
+/* t = a^2, cross products once and doubled, then the squares on the diagonal */
+static void FP64_NIST256_sqr4_c(unsign64 *t, const unsign64 *a)
+{
+    unsign64 c;
+    u128 x;
+
+    for (int i = 0; i < 8; i++) t[i] = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        c = 0;
+        for (int j = i + 1; j < 4; j++)
+        {
+            x = (u128)a[i] * a[j] + t[i + j] + c;
+            t[i + j] = (unsign64)x;
+            c = (unsign64)(x >> 64);
+        }
+        t[i + 4] = c;
+    }
+
+    c = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        unsign64 w = t[i];
+        t[i] = (w << 1) | c;
+        c = w >> 63;
+    }
+
+    c = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        x = (u128)a[i] * a[i] + t[2 * i] + c;
+        t[2 * i] = (unsign64)x;
+        x = (u128)t[2 * i + 1] + (unsign64)(x >> 64);
+        t[2 * i + 1] = (unsign64)x;
+        c = (unsign64)(x >> 64);
+    }
+}
+
+#ifdef FP64_NIST256_ASM
+
+/* t = a.b with MULX, carries of low halves on OF (ADOX) and of high halves on CF (ADCX) */
+static void FP64_NIST256_mul4_adx(unsign64 *t, const unsign64 *a, const unsign64 *b)
+{
+    __asm__ volatile(
+        "movq 0(%[b]), %%rdx\n\t"
+        "mulx 0(%[a]), %%r8, %%r9\n\t"
+        "mulx 8(%[a]), %%rax, %%r10\n\t"
+        "addq %%rax, %%r9\n\t"
+        "mulx 16(%[a]), %%rax, %%r11\n\t"
+        "adcq %%rax, %%r10\n\t"
+        "mulx 24(%[a]), %%rax, %%r12\n\t"
+        "adcq %%rax, %%r11\n\t"
+        "adcq $0, %%r12\n\t"
+
+        "movq 8(%[b]), %%rdx\n\t"
+        "xorl %%eax, %%eax\n\t"
+        "mulx 0(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r9\n\t"
+        "adcx %%rcx, %%r10\n\t"
+        "mulx 8(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r10\n\t"
+        "adcx %%rcx, %%r11\n\t"
+        "mulx 16(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r11\n\t"
+        "adcx %%rcx, %%r12\n\t"
+        "mulx 24(%[a]), %%rax, %%r13\n\t"
+        "adox %%rax, %%r12\n\t"
+        "movl $0, %%eax\n\t"
+        "adcx %%rax, %%r13\n\t"
+        "adox %%rax, %%r13\n\t"
+
+        "movq 16(%[b]), %%rdx\n\t"
+        "xorl %%eax, %%eax\n\t"
+        "mulx 0(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r10\n\t"
+        "adcx %%rcx, %%r11\n\t"
+        "mulx 8(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r11\n\t"
+        "adcx %%rcx, %%r12\n\t"
+        "mulx 16(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r12\n\t"
+        "adcx %%rcx, %%r13\n\t"
+        "mulx 24(%[a]), %%rax, %%r14\n\t"
+        "adox %%rax, %%r13\n\t"
+        "movl $0, %%eax\n\t"
+        "adcx %%rax, %%r14\n\t"
+        "adox %%rax, %%r14\n\t"
+
+        "movq 24(%[b]), %%rdx\n\t"
+        "xorl %%eax, %%eax\n\t"
+        "mulx 0(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r11\n\t"
+        "adcx %%rcx, %%r12\n\t"
+        "mulx 8(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r12\n\t"
+        "adcx %%rcx, %%r13\n\t"
+        "mulx 16(%[a]), %%rax, %%rcx\n\t"
+        "adox %%rax, %%r13\n\t"
+        "adcx %%rcx, %%r14\n\t"
+        "mulx 24(%[a]), %%rax, %%r15\n\t"
+        "adox %%rax, %%r14\n\t"
+        "movl $0, %%eax\n\t"
+        "adcx %%rax, %%r15\n\t"
+        "adox %%rax, %%r15\n\t"
+
+        "movq %%r8, 0(%[t])\n\t"
+        "movq %%r9, 8(%[t])\n\t"
+        "movq %%r10, 16(%[t])\n\t"
+        "movq %%r11, 24(%[t])\n\t"
+        "movq %%r12, 32(%[t])\n\t"
+        "movq %%r13, 40(%[t])\n\t"
+        "movq %%r14, 48(%[t])\n\t"
+        "movq %%r15, 56(%[t])\n\t"
+        :
+        : [t] "r"(t), [a] "r"(a), [b] "r"(b)
+        : "rax", "rcx", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "cc", "memory");
+}
+
+static void FP64_NIST256_sqr4_adx(unsign64 *t, const unsign64 *a)
+{
+    FP64_NIST256_mul4_adx(t, a, a);
+}
+
+static void FP64_NIST256_mul4_init(unsign64 *t, const unsign64 *a, const unsign64 *b);
+static void FP64_NIST256_sqr4_init(unsign64 *t, const unsign64 *a);
+
+/*
+ * Resolved on first use. Every thread that races here stores the same
+ * values, and each pointer is valid on its own, so relaxed atomics suffice
+ */
+static void (*FP64_NIST256_mul4p)(unsign64 *, const unsign64 *, const unsign64 *) = FP64_NIST256_mul4_init;
+static void (*FP64_NIST256_sqr4p)(unsign64 *, const unsign64 *) = FP64_NIST256_sqr4_init;
+
+#define FP64_NIST256_mul4 (__atomic_load_n(&FP64_NIST256_mul4p, __ATOMIC_RELAXED))
+#define FP64_NIST256_sqr4 (__atomic_load_n(&FP64_NIST256_sqr4p, __ATOMIC_RELAXED))
+
+static void FP64_NIST256_select(void)
+{
+    unsigned int eax, ebx = 0, ecx, edx;
+    int adx = __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & (1u << 8)) && (ebx & (1u << 19));
+
+    /* BMI2 for MULX, ADX for ADCX/ADOX */
+    __atomic_store_n(&FP64_NIST256_mul4p, adx ? FP64_NIST256_mul4_adx : FP64_NIST256_mul4_c, __ATOMIC_RELAXED);
+    __atomic_store_n(&FP64_NIST256_sqr4p, adx ? FP64_NIST256_sqr4_adx : FP64_NIST256_sqr4_c, __ATOMIC_RELAXED);
+}
+
+static void FP64_NIST256_mul4_init(unsign64 *t, const unsign64 *a, const unsign64 *b)
+{
+    FP64_NIST256_select();
+    FP64_NIST256_mul4(t, a, b);
+}
+
+static void FP64_NIST256_sqr4_init(unsign64 *t, const unsign64 *a)
+{
+    FP64_NIST256_select();
+    FP64_NIST256_sqr4(t, a);
+}
+
+#else
+
+#define FP64_NIST256_mul4 FP64_NIST256_mul4_c
+#define FP64_NIST256_sqr4 FP64_NIST256_sqr4_c
+
+#endif
+
+void FP64_NIST256_zero(FP64_NIST256 *x)
+{
+    for (int i = 0; i < 4; i++) x->v[i] = 0;
+}
+
+void FP64_NIST256_one(FP64_NIST256 *x)
+{
+    for (int i = 0; i < 4; i++) x->v[i] = ONE[i];
+}
+
+void FP64_NIST256_copy(FP64_NIST256 *y, const FP64_NIST256 *x)
+{
+    for (int i = 0; i < 4; i++) y->v[i] = x->v[i];
+}
+
+int FP64_NIST256_iszilch(const FP64_NIST256 *x)
+{
+    unsign64 d = x->v[0] | x->v[1] | x->v[2] | x->v[3];
+    return (int)(((d | (0 - d)) >> 63) ^ 1);
+}
+
+int FP64_NIST256_equals(const FP64_NIST256 *x, const FP64_NIST256 *y)
+{
+    unsign64 d = 0;
+    for (int i = 0; i < 4; i++) d |= x->v[i] ^ y->v[i];
+    return (int)(((d | (0 - d)) >> 63) ^ 1);
+}
+
+void FP64_NIST256_cmove(FP64_NIST256 *x, const FP64_NIST256 *y, int s)
+{
+    unsign64 mask = 0 - (unsign64)(s != 0);
+    for (int i = 0; i < 4; i++) x->v[i] ^= (x->v[i] ^ y->v[i]) & mask;
+}
+
+void FP64_NIST256_mul(FP64_NIST256 *x, const FP64_NIST256 *y, const FP64_NIST256 *z)
+{
+    unsign64 t[8];
+    FP64_NIST256_mul4(t, y->v, z->v);
+    FP64_NIST256_redc(x->v, t);
+}
+
+void FP64_NIST256_sqr(FP64_NIST256 *x, const FP64_NIST256 *y)
+{
+    unsign64 t[8];
+    FP64_NIST256_sqr4(t, y->v);
+    FP64_NIST256_redc(x->v, t);
+}
+
+void FP64_NIST256_add(FP64_NIST256 *x, const FP64_NIST256 *y, const FP64_NIST256 *z)
+{
+    unsign64 c = 0;
+    u128 s;
+
+    for (int i = 0; i < 4; i++)
+    {
+        s = (u128)y->v[i] + z->v[i] + c;
+        x->v[i] = (unsign64)s;
+        c = (unsign64)(s >> 64);
+    }
+    FP64_NIST256_csub(x->v, c);
+}
+
+void FP64_NIST256_sub(FP64_NIST256 *x, const FP64_NIST256 *y, const FP64_NIST256 *z)
+{
+    unsign64 b = 0, c = 0, mask;
+    u128 s;
+
+    for (int i = 0; i < 4; i++)
+    {
+        s = (u128)y->v[i] - z->v[i] - b;
+        x->v[i] = (unsign64)s;
+        b = (unsign64)(s >> 64) & 1;
+    }
+
+    /* Add p back if it went negative */
+    mask = 0 - b;
+    for (int i = 0; i < 4; i++)
+    {
+        s = (u128)x->v[i] + (P[i] & mask) + c;
+        x->v[i] = (unsign64)s;
+        c = (unsign64)(s >> 64);
+    }
+}
+
+void FP64_NIST256_neg(FP64_NIST256 *x, const FP64_NIST256 *y)
+{
+    FP64_NIST256 z;
+    FP64_NIST256_zero(&z);
+    FP64_NIST256_sub(x, &z, y);
+}
+
+/* x = y^(2^n) */
+static void FP64_NIST256_nsqr(FP64_NIST256 *x, const FP64_NIST256 *y, int n)
+{
+    FP64_NIST256_sqr(x, y);
+    for (int i = 1; i < n; i++) FP64_NIST256_sqr(x, x);
+}
+
+/* p = 3 mod 4, so a root is y^((p+1)/4), with (p+1)/4 = (2^32-1).2^222 + 2^190 + 2^94 */
+int FP64_NIST256_sqrt(FP64_NIST256 *x, const FP64_NIST256 *y)
+{
+    FP64_NIST256 x2, x4, x8, x16, t;
+
+    FP64_NIST256_sqr(&t, y);
+    FP64_NIST256_mul(&x2, &t, y);      /* 2^2-1 */
+    FP64_NIST256_nsqr(&t, &x2, 2);
+    FP64_NIST256_mul(&x4, &t, &x2);    /* 2^4-1 */
+    FP64_NIST256_nsqr(&t, &x4, 4);
+    FP64_NIST256_mul(&x8, &t, &x4);    /* 2^8-1 */
+    FP64_NIST256_nsqr(&t, &x8, 8);
+    FP64_NIST256_mul(&x16, &t, &x8);   /* 2^16-1 */
+    FP64_NIST256_nsqr(&t, &x16, 16);
+    FP64_NIST256_mul(&t, &t, &x16);    /* 2^32-1 */
+
+    FP64_NIST256_nsqr(&t, &t, 32);
+    FP64_NIST256_mul(&t, &t, y);       /* + 2^190, once shifted */
+    FP64_NIST256_nsqr(&t, &t, 96);
+    FP64_NIST256_mul(&t, &t, y);       /* + 2^94, once shifted */
+    FP64_NIST256_nsqr(&t, &t, 94);
+
+    /* y is a square exactly when the candidate squares back to it */
+    FP64_NIST256_sqr(&x2, &t);
+    FP64_NIST256_copy(x, &t);
+    return FP64_NIST256_equals(&x2, y);
+}
+
+#ifdef NIST256_SAFEGCD
+
+/* y holds a.2^256, safegcd gives 1/(a.2^256), and a Montgomery product with 2^768 makes that 2^256/a */
+void FP64_NIST256_inv(FP64_NIST256 *x, const FP64_NIST256 *y)
+{
+    FP64_NIST256 t;
+
+    SAFEGCD_NIST256_modp(t.v, y->v);
+    FP64_NIST256_mul(x, &t, &R3);
+}
+
+#else
+
+/* p-2 = FFFFFFFF 00000001 00000000 00000000 00000000 FFFFFFFF FFFFFFFF FFFFFFFD, in 32-bit words */
+void FP64_NIST256_inv(FP64_NIST256 *x, const FP64_NIST256 *y)
+{
+    FP64_NIST256 x2, x4, x8, x16, x30, x32, t;
+
+    FP64_NIST256_sqr(&t, y);
+    FP64_NIST256_mul(&x2, &t, y);      /* 2^2-1 */
+    FP64_NIST256_nsqr(&t, &x2, 2);
+    FP64_NIST256_mul(&x4, &t, &x2);    /* 2^4-1 */
+    FP64_NIST256_nsqr(&t, &x4, 4);
+    FP64_NIST256_mul(&x8, &t, &x4);    /* 2^8-1 */
+    FP64_NIST256_nsqr(&t, &x8, 8);
+    FP64_NIST256_mul(&x16, &t, &x8);   /* 2^16-1 */
+    FP64_NIST256_nsqr(&t, &x16, 8);
+    FP64_NIST256_mul(&t, &t, &x8);     /* 2^24-1 */
+    FP64_NIST256_nsqr(&t, &t, 4);
+    FP64_NIST256_mul(&t, &t, &x4);     /* 2^28-1 */
+    FP64_NIST256_nsqr(&t, &t, 2);
+    FP64_NIST256_mul(&x30, &t, &x2);   /* 2^30-1 */
+    FP64_NIST256_nsqr(&t, &x30, 2);
+    FP64_NIST256_mul(&x32, &t, &x2);   /* 2^32-1 */
+
+    FP64_NIST256_nsqr(&t, &x32, 32);
+    FP64_NIST256_mul(&t, &t, y);       /* FFFFFFFF 00000001 */
+    FP64_NIST256_nsqr(&t, &t, 96);     /* three zero words */
+    FP64_NIST256_nsqr(&t, &t, 32);
+    FP64_NIST256_mul(&t, &t, &x32);
+    FP64_NIST256_nsqr(&t, &t, 32);
+    FP64_NIST256_mul(&t, &t, &x32);
+    FP64_NIST256_nsqr(&t, &t, 30);
+    FP64_NIST256_mul(&t, &t, &x30);    /* FFFFFFFC */
+    FP64_NIST256_nsqr(&t, &t, 2);
+    FP64_NIST256_mul(x, &t, y);        /* FFFFFFFD */
+}
+
+#endif
+
+/* Plain integer limbs of x */
+static void FP64_NIST256_redc1(unsign64 *r, const FP64_NIST256 *x)
+{
+    unsign64 t[8];
+    for (int i = 0; i < 4; i++)
+    {
+        t[i] = x->v[i];
+        t[i + 4] = 0;
+    }
+    FP64_NIST256_redc(r, t);
+}
+
+int FP64_NIST256_parity(const FP64_NIST256 *x)
+{
+    unsign64 r[4];
+    FP64_NIST256_redc1(r, x);
+    return (int)(r[0] & 1);
+}
+
+void FP64_NIST256_fromBytes(FP64_NIST256 *x, const char *b)
+{
+    FP64_NIST256 a, r2;
+
+    for (int i = 0; i < 4; i++)
+    {
+        unsign64 w = 0;
+        for (int j = 0; j < 8; j++) w = (w << 8) | (unsign64)(unsigned char)b[8 * (3 - i) + j];
+        a.v[i] = w;
+    }
+    for (int i = 0; i < 4; i++) r2.v[i] = R2[i];
+    FP64_NIST256_mul(x, &a, &r2);
+}
+
+void FP64_NIST256_toBytes(char *b, const FP64_NIST256 *x)
+{
+    unsign64 r[4];
+
+    FP64_NIST256_redc1(r, x);
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 8; j++) b[8 * (3 - i) + j] = (char)(r[i] >> (56 - 8 * j));
+}
+
+void FP64_NIST256_fromFP(FP64_NIST256 *x, FP_NIST256 *y)
+{
+    BIG_256_56 a;
+    char b[MODBYTES_256_56];
+
+    FP_NIST256_redc(a, y);
+    BIG_256_56_toBytes(b, a);
+    FP64_NIST256_fromBytes(x, b);
+}
+
+void FP64_NIST256_toFP(FP_NIST256 *x, const FP64_NIST256 *y)
+{
+    BIG_256_56 a;
+    char b[MODBYTES_256_56];
+
+    FP64_NIST256_toBytes(b, y);
+    BIG_256_56_fromBytes(a, b);
+    FP_NIST256_nres(x, a);
+}
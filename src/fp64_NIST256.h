@@ -0,0 +1,156 @@
+/**
+ * @file fp64_NIST256.h
+ * @brief Full-radix arithmetic modulo the NIST P-256 prime
+ *
+ * MIRACL Core builds the NIST256 field as MODTYPE NOT_SPECIAL on 5x56-bit
+ * limbs, so every product goes through the generic BIG_256_56_monty. This
+ * backend keeps residues in four 64-bit limbs, Montgomery form with
+ * R = 2^256, and exploits p = 2^256 - 2^224 + 2^192 + 2^96 - 1: since
+ * -1/p = 1 mod 2^64, each reduction step needs no multiplication to find
+ * its quotient digit, and the zero limb of p drops out entirely.
+ *
+ * On x86-64 CPUs with BMI2 and ADX the 4x4 limb product runs as MULX with
+ * two independent ADCX/ADOX carry chains, chosen at run time. Elsewhere, or
+ * when built with -DFP64_NIST256_NOASM, a portable 128-bit version is used.
+ * Every function runs in constant time, apart from FP64_NIST256_equals and
+ * FP64_NIST256_iszilch, whose result is the only thing that depends on the data.
+ */
+
+#ifndef FP64_NIST256_H
+#define FP64_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+#include "fp_NIST256.h"
+
+#define FP64_NIST256_LIMBS 4  /**< 64-bit limbs per residue */
+
+/**
+	@brief Residue modulo p in Montgomery form, fully reduced to [0, p)
+*/
+typedef struct
+{
+    unsign64 v[FP64_NIST256_LIMBS];  /**< Little-endian limbs of x.2^256 mod p */
+} FP64_NIST256;
+
+/* Field function prototypes */
+
+/**	@brief Set to zero
+ *
+	@param x FP64 number to be set to 0
+ */
+extern void FP64_NIST256_zero(FP64_NIST256 *x);
+/**	@brief Set to one
+ *
+	@param x FP64 number to be set to 1
+ */
+extern void FP64_NIST256_one(FP64_NIST256 *x);
+/**	@brief Copy an FP64 number
+ *
+	@param y FP64 number to be copied to
+	@param x FP64 number to be copied from
+ */
+extern void FP64_NIST256_copy(FP64_NIST256 *y, const FP64_NIST256 *x);
+/**	@brief Tests for FP64 equal to zero
+ *
+	@param x FP64 number to be tested
+	@return 1 if zero, else returns 0
+ */
+extern int FP64_NIST256_iszilch(const FP64_NIST256 *x);
+/**	@brief Tests for equality of two FP64s
+ *
+	@param x FP64 instance to be compared
+	@param y FP64 instance to be compared
+	@return 1 if x=y, else returns 0
+ */
+extern int FP64_NIST256_equals(const FP64_NIST256 *x, const FP64_NIST256 *y);
+/**	@brief Conditional copy of FP64 number
+ *
+	Conditionally copies second parameter to the first (without branching)
+	@param x FP64 instance, set to y if s!=0
+	@param y another FP64 instance
+	@param s copy only takes place if not equal to 0
+ */
+extern void FP64_NIST256_cmove(FP64_NIST256 *x, const FP64_NIST256 *y, int s);
+/**	@brief Modular multiplication of two FP64s
+ *
+	@param x FP64 instance, on exit = y*z mod p
+	@param y FP64 instance
+	@param z FP64 instance
+ */
+extern void FP64_NIST256_mul(FP64_NIST256 *x, const FP64_NIST256 *y, const FP64_NIST256 *z);
+/**	@brief Modular squaring of an FP64
+ *
+	@param x FP64 instance, on exit = y^2 mod p
+	@param y FP64 instance
+ */
+extern void FP64_NIST256_sqr(FP64_NIST256 *x, const FP64_NIST256 *y);
+/**	@brief Modular addition of two FP64s
+ *
+	@param x FP64 instance, on exit = y+z mod p
+	@param y FP64 instance
+	@param z FP64 instance
+ */
+extern void FP64_NIST256_add(FP64_NIST256 *x, const FP64_NIST256 *y, const FP64_NIST256 *z);
+/**	@brief Modular subtraction of two FP64s
+ *
+	@param x FP64 instance, on exit = y-z mod p
+	@param y FP64 instance
+	@param z FP64 instance
+ */
+extern void FP64_NIST256_sub(FP64_NIST256 *x, const FP64_NIST256 *y, const FP64_NIST256 *z);
+/**	@brief Modular negation of an FP64
+ *
+	@param x FP64 instance, on exit = -y mod p
+	@param y FP64 instance
+ */
+extern void FP64_NIST256_neg(FP64_NIST256 *x, const FP64_NIST256 *y);
+/**	@brief Inverse Modular Exponentiation of an FP64, 1/y mod p
+ *
+	Fermat inversion y^(p-2) along a fixed addition chain, or safegcd
+	when built with -DNIST256_SAFEGCD. Both are constant time.
+	@param x FP64 instance, on exit = 1/y mod p
+	@param y FP64 instance
+ */
+extern void FP64_NIST256_inv(FP64_NIST256 *x, const FP64_NIST256 *y);
+/**	@brief Square root of an FP64, sqrt(y) mod p
+ *
+	y^((p+1)/4) along a fixed addition chain of 253 squarings and 7
+	multiplications, constant time.
+	@param x FP64 instance, on exit a square root of y if there is one
+	@param y FP64 instance
+	@return 1 if y is a square, else 0
+ */
+extern int FP64_NIST256_sqrt(FP64_NIST256 *x, const FP64_NIST256 *y);
+/**	@brief Tests parity of the (non-Montgomery) value
+ *
+	@param x FP64 instance
+	@return 1 if odd, else 0
+ */
+extern int FP64_NIST256_parity(const FP64_NIST256 *x);
+/**	@brief Converts a 32-byte big-endian integer to an FP64 residue
+ *
+	@param x FP64 instance, on exit = b mod p in Montgomery form
+	@param b input byte array
+ */
+extern void FP64_NIST256_fromBytes(FP64_NIST256 *x, const char *b);
+/**	@brief Converts an FP64 residue to a 32-byte big-endian integer
+ *
+	@param b output byte array
+	@param x FP64 instance
+ */
+extern void FP64_NIST256_toBytes(char *b, const FP64_NIST256 *x);
+/**	@brief Converts a MIRACL FP_NIST256 residue to FP64 form
+ *
+	@param x FP64 instance, on exit the same value as y
+	@param y FP_NIST256 instance
+ */
+extern void FP64_NIST256_fromFP(FP64_NIST256 *x, FP_NIST256 *y);
+/**	@brief Converts an FP64 residue to MIRACL FP_NIST256 form
+ *
+	@param x FP_NIST256 instance, on exit the same value as y
+	@param y FP64 instance
+ */
+extern void FP64_NIST256_toFP(FP_NIST256 *x, const FP64_NIST256 *y);
+
+#endif
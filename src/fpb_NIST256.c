@@ -0,0 +1,425 @@
+/**
+ * fpb_NIST256.c - Eight-lane batch arithmetic modulo the P-256 prime
+ *
+ * In radix 2^52, p has limbs
+ *   p0 = 2^52-1, p1 = 2^44-1, p2 = 0, p3 = 2^36, p4 = 2^48-2^16
+ * A Montgomery step takes m = t0 mod 2^52 (as -1/p = 1 mod 2^52), adds
+ * m.p, and shifts one limb down. Products are split into low and high
+ * 52-bit halves, added into 64-bit accumulators, which have room for the
+ * few extra carry bits until the final normalisation.
+ *
+ * The portable kernels compute each lane with the same splits and the
+ * same order of additions as the IFMA ones, so both give identical limbs.
+ */
+
+#include "fpb_NIST256.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(FPB_NIST256_NOSIMD)
+#define FPB_NIST256_IFMA
+#include <immintrin.h>
+#endif
+
+#define M52 0xFFFFFFFFFFFFFULL
+
+typedef unsigned __int128 u128;
+
+static const unsign64 P[5] = {0xFFFFFFFFFFFFFULL, 0x00FFFFFFFFFFFULL, 0x0000000000000ULL, 0x0001000000000ULL, 0x0FFFFFFFF0000ULL};
+
+/* 2^260 mod p, the Montgomery form of 1 */
+static const unsign64 ONE[5] = {0x0000000000010ULL, 0xF000000000000ULL, 0xFFFFFFFFFFFFFULL, 0xFFEFFFFFFFFFFULL, 0x00000000FFFFFULL};
+
+/* Portable kernels, one lane at a time */
+
+static void FPB_NIST256_reduce_c(FPB_NIST256 *x)
+{
+    for (int i = 0; i < FPB_NIST256_LANES; i++)
+    {
+        unsign64 c = 0, s[5], mask;
+        sign64 b = 0;
+
+        for (int j = 0; j < 5; j++)
+        {
+            unsign64 t = x->v[j][i] + c;
+            x->v[j][i] = t & M52;
+            c = t >> 52;
+        }
+        for (int j = 0; j < 5; j++)
+        {
+            sign64 t = (sign64)x->v[j][i] - (sign64)P[j] + b;
+            b = t >> 52;
+            s[j] = (unsign64)t & M52;
+        }
+        /* Keep x where x-p borrowed */
+        mask = (unsign64)b;
+        for (int j = 0; j < 5; j++) x->v[j][i] = (x->v[j][i] & mask) | (s[j] & ~mask);
+    }
+}
+
+static void FPB_NIST256_add_c(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    for (int j = 0; j < 5; j++)
+        for (int i = 0; i < FPB_NIST256_LANES; i++) x->v[j][i] = y->v[j][i] + z->v[j][i];
+    FPB_NIST256_reduce_c(x);
+}
+
+static void FPB_NIST256_sub_c(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    for (int i = 0; i < FPB_NIST256_LANES; i++)
+    {
+        unsign64 d[5], c = 0, mask;
+        sign64 b = 0;
+
+        for (int j = 0; j < 5; j++)
+        {
+            sign64 t = (sign64)y->v[j][i] - (sign64)z->v[j][i] + b;
+            b = t >> 52;
+            d[j] = (unsign64)t & M52;
+        }
+        /* Add p back where it went negative */
+        mask = (unsign64)b;
+        for (int j = 0; j < 5; j++)
+        {
+            unsign64 t = d[j] + (P[j] & mask) + c;
+            x->v[j][i] = t & M52;
+            c = t >> 52;
+        }
+    }
+}
+
+static void FPB_NIST256_mul_c(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    for (int i = 0; i < FPB_NIST256_LANES; i++)
+    {
+        unsign64 t[6] = {0, 0, 0, 0, 0, 0}, m;
+        u128 pr;
+
+        for (int k = 0; k < 5; k++)
+        {
+            for (int j = 0; j < 5; j++)
+            {
+                pr = (u128)y->v[j][i] * z->v[k][i];
+                t[j] += (unsign64)pr & M52;
+                t[j + 1] += (unsign64)(pr >> 52);
+            }
+            m = t[0] & M52;
+            for (int j = 0; j < 5; j++)
+            {
+                if (j == 2) continue;  /* p2 = 0 */
+                pr = (u128)m * P[j];
+                t[j] += (unsign64)pr & M52;
+                t[j + 1] += (unsign64)(pr >> 52);
+            }
+            t[1] += t[0] >> 52;
+            for (int j = 0; j < 5; j++) t[j] = t[j + 1];
+            t[5] = 0;
+        }
+        for (int j = 0; j < 5; j++) x->v[j][i] = t[j];
+    }
+    FPB_NIST256_reduce_c(x);
+}
+
+#ifdef FPB_NIST256_IFMA
+
+#define FPB_TARGET __attribute__((target("avx512f,avx512ifma")))
+
+FPB_TARGET static void FPB_NIST256_reduce_v(__m512i *v)
+{
+    const __m512i mask = _mm512_set1_epi64((long long)M52);
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i c = zero, b = zero, s[5];
+    __mmask8 k;
+
+    for (int j = 0; j < 5; j++)
+    {
+        __m512i t = _mm512_add_epi64(v[j], c);
+        v[j] = _mm512_and_si512(t, mask);
+        c = _mm512_srli_epi64(t, 52);
+    }
+    for (int j = 0; j < 5; j++)
+    {
+        __m512i t = _mm512_add_epi64(_mm512_sub_epi64(v[j], _mm512_set1_epi64((long long)P[j])), b);
+        b = _mm512_srai_epi64(t, 52);
+        s[j] = _mm512_and_si512(t, mask);
+    }
+    k = _mm512_cmplt_epi64_mask(b, zero);
+    for (int j = 0; j < 5; j++) v[j] = _mm512_mask_blend_epi64(k, s[j], v[j]);
+}
+
+FPB_TARGET static void FPB_NIST256_reduce_ifma(FPB_NIST256 *x)
+{
+    __m512i v[5];
+    for (int j = 0; j < 5; j++) v[j] = _mm512_loadu_si512(x->v[j]);
+    FPB_NIST256_reduce_v(v);
+    for (int j = 0; j < 5; j++) _mm512_storeu_si512(x->v[j], v[j]);
+}
+
+FPB_TARGET static void FPB_NIST256_add_ifma(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    __m512i v[5];
+    for (int j = 0; j < 5; j++) v[j] = _mm512_add_epi64(_mm512_loadu_si512(y->v[j]), _mm512_loadu_si512(z->v[j]));
+    FPB_NIST256_reduce_v(v);
+    for (int j = 0; j < 5; j++) _mm512_storeu_si512(x->v[j], v[j]);
+}
+
+FPB_TARGET static void FPB_NIST256_sub_ifma(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    const __m512i mask = _mm512_set1_epi64((long long)M52);
+    __m512i d[5], b = _mm512_setzero_si512(), c = _mm512_setzero_si512();
+
+    for (int j = 0; j < 5; j++)
+    {
+        __m512i t = _mm512_add_epi64(_mm512_sub_epi64(_mm512_loadu_si512(y->v[j]), _mm512_loadu_si512(z->v[j])), b);
+        b = _mm512_srai_epi64(t, 52);
+        d[j] = _mm512_and_si512(t, mask);
+    }
+    for (int j = 0; j < 5; j++)
+    {
+        __m512i t = _mm512_add_epi64(_mm512_add_epi64(d[j], _mm512_and_si512(_mm512_set1_epi64((long long)P[j]), b)), c);
+        _mm512_storeu_si512(x->v[j], _mm512_and_si512(t, mask));
+        c = _mm512_srli_epi64(t, 52);
+    }
+}
+
+FPB_TARGET static void FPB_NIST256_mul_ifma(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    const __m512i mask = _mm512_set1_epi64((long long)M52);
+    const __m512i p0 = _mm512_set1_epi64((long long)P[0]);
+    const __m512i p1 = _mm512_set1_epi64((long long)P[1]);
+    const __m512i p3 = _mm512_set1_epi64((long long)P[3]);
+    const __m512i p4 = _mm512_set1_epi64((long long)P[4]);
+    __m512i a[5], t[6], m, bk;
+
+    for (int j = 0; j < 5; j++) a[j] = _mm512_loadu_si512(y->v[j]);
+    for (int j = 0; j < 6; j++) t[j] = _mm512_setzero_si512();
+
+    for (int k = 0; k < 5; k++)
+    {
+        bk = _mm512_loadu_si512(z->v[k]);
+        for (int j = 0; j < 5; j++)
+        {
+            t[j] = _mm512_madd52lo_epu64(t[j], a[j], bk);
+            t[j + 1] = _mm512_madd52hi_epu64(t[j + 1], a[j], bk);
+        }
+
+        m = _mm512_and_si512(t[0], mask);
+        t[0] = _mm512_madd52lo_epu64(t[0], m, p0);
+        t[1] = _mm512_madd52hi_epu64(t[1], m, p0);
+        t[1] = _mm512_madd52lo_epu64(t[1], m, p1);
+        t[2] = _mm512_madd52hi_epu64(t[2], m, p1);
+        t[3] = _mm512_madd52lo_epu64(t[3], m, p3);
+        t[4] = _mm512_madd52hi_epu64(t[4], m, p3);
+        t[4] = _mm512_madd52lo_epu64(t[4], m, p4);
+        t[5] = _mm512_madd52hi_epu64(t[5], m, p4);
+
+        t[1] = _mm512_add_epi64(t[1], _mm512_srli_epi64(t[0], 52));
+        for (int j = 0; j < 5; j++) t[j] = t[j + 1];
+        t[5] = _mm512_setzero_si512();
+    }
+
+    FPB_NIST256_reduce_v(t);
+    for (int j = 0; j < 5; j++) _mm512_storeu_si512(x->v[j], t[j]);
+}
+
+#endif
+
+typedef void (*FPB_NIST256_op)(FPB_NIST256 *, const FPB_NIST256 *, const FPB_NIST256 *);
+
+typedef struct
+{
+    void (*reduce)(FPB_NIST256 *);
+    FPB_NIST256_op add, sub, mul;
+} FPB_NIST256_kernels;
+
+/* The kernels of each level: 0 portable, 1 IFMA */
+static const FPB_NIST256_kernels FPB_NIST256_levels[] = {
+    {FPB_NIST256_reduce_c, FPB_NIST256_add_c, FPB_NIST256_sub_c, FPB_NIST256_mul_c},
+#ifdef FPB_NIST256_IFMA
+    {FPB_NIST256_reduce_ifma, FPB_NIST256_add_ifma, FPB_NIST256_sub_ifma, FPB_NIST256_mul_ifma},
+#endif
+};
+
+static int FPB_NIST256_active = -1;
+
+int FPB_NIST256_simd(int on)
+{
+    int k = 0;
+
+#ifdef FPB_NIST256_IFMA
+    __builtin_cpu_init();
+    if (on && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma")) k = 1;
+#else
+    (void)on;
+#endif
+    return DISPATCH_set(&FPB_NIST256_active, k);
+}
+
+int FPB_NIST256_simd_active(void)
+{
+    return DISPATCH_get(&FPB_NIST256_active, FPB_NIST256_simd, 1);
+}
+
+static inline const FPB_NIST256_kernels *FPB_NIST256_kernel(void)
+{
+    return &FPB_NIST256_levels[FPB_NIST256_simd_active()];
+}
+
+void FPB_NIST256_zero(FPB_NIST256 *x)
+{
+    for (int j = 0; j < 5; j++)
+        for (int i = 0; i < FPB_NIST256_LANES; i++) x->v[j][i] = 0;
+}
+
+void FPB_NIST256_one(FPB_NIST256 *x)
+{
+    for (int j = 0; j < 5; j++)
+        for (int i = 0; i < FPB_NIST256_LANES; i++) x->v[j][i] = ONE[j];
+}
+
+void FPB_NIST256_copy(FPB_NIST256 *y, const FPB_NIST256 *x)
+{
+    *y = *x;
+}
+
+void FPB_NIST256_iszilch(unsign64 *mask, const FPB_NIST256 *x)
+{
+    for (int i = 0; i < FPB_NIST256_LANES; i++)
+    {
+        unsign64 d = 0;
+        for (int j = 0; j < 5; j++) d |= x->v[j][i];
+        mask[i] = ((d | (0 - d)) >> 63) - 1;
+    }
+}
+
+void FPB_NIST256_cmove(FPB_NIST256 *x, const FPB_NIST256 *y, const unsign64 *mask)
+{
+    for (int j = 0; j < 5; j++)
+        for (int i = 0; i < FPB_NIST256_LANES; i++) x->v[j][i] ^= (x->v[j][i] ^ y->v[j][i]) & mask[i];
+}
+
+/* FP64 holds x.2^256 and FPB holds x.2^260, so going in multiplies by 16 */
+void FPB_NIST256_set(FPB_NIST256 *x, int i, const FP64_NIST256 *y)
+{
+    FP64_NIST256 z;
+    const unsign64 *w = z.v;
+
+    FP64_NIST256_add(&z, y, y);
+    FP64_NIST256_add(&z, &z, &z);
+    FP64_NIST256_add(&z, &z, &z);
+    FP64_NIST256_add(&z, &z, &z);
+
+    x->v[0][i] = w[0] & M52;
+    x->v[1][i] = ((w[0] >> 52) | (w[1] << 12)) & M52;
+    x->v[2][i] = ((w[1] >> 40) | (w[2] << 24)) & M52;
+    x->v[3][i] = ((w[2] >> 28) | (w[3] << 36)) & M52;
+    x->v[4][i] = w[3] >> 16;
+}
+
+/* ...and coming out is a Montgomery product with 2^252, which divides by 16 */
+void FPB_NIST256_get(FP64_NIST256 *y, const FPB_NIST256 *x, int i)
+{
+    FP64_NIST256 z, c = {{0, 0, 0, 1ULL << 60}};
+
+    z.v[0] = x->v[0][i] | (x->v[1][i] << 52);
+    z.v[1] = (x->v[1][i] >> 12) | (x->v[2][i] << 40);
+    z.v[2] = (x->v[2][i] >> 24) | (x->v[3][i] << 28);
+    z.v[3] = (x->v[3][i] >> 36) | (x->v[4][i] << 16);
+    FP64_NIST256_mul(y, &z, &c);
+}
+
+void FPB_NIST256_reduce(FPB_NIST256 *x)
+{
+    FPB_NIST256_kernel()->reduce(x);
+}
+
+void FPB_NIST256_add(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    FPB_NIST256_kernel()->add(x, y, z);
+}
+
+void FPB_NIST256_sub(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    FPB_NIST256_kernel()->sub(x, y, z);
+}
+
+void FPB_NIST256_neg(FPB_NIST256 *x, const FPB_NIST256 *y)
+{
+    FPB_NIST256 z;
+    FPB_NIST256_zero(&z);
+    FPB_NIST256_sub(x, &z, y);
+}
+
+void FPB_NIST256_mul(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z)
+{
+    FPB_NIST256_kernel()->mul(x, y, z);
+}
+
+void FPB_NIST256_sqr(FPB_NIST256 *x, const FPB_NIST256 *y)
+{
+    FPB_NIST256_kernel()->mul(x, y, y);
+}
+
+/* x = y^(2^n) */
+static void FPB_NIST256_nsqr(FPB_NIST256 *x, const FPB_NIST256 *y, int n)
+{
+    FPB_NIST256_sqr(x, y);
+    for (int i = 1; i < n; i++) FPB_NIST256_sqr(x, x);
+}
+
+/* p = 3 mod 4, so a root is y^((p+1)/4): the addition chain of FP64_NIST256_sqrt */
+void FPB_NIST256_sqrt(FPB_NIST256 *x, const FPB_NIST256 *y)
+{
+    FPB_NIST256 x2, x4, x8, x16, t;
+
+    FPB_NIST256_sqr(&t, y);
+    FPB_NIST256_mul(&x2, &t, y);
+    FPB_NIST256_nsqr(&t, &x2, 2);
+    FPB_NIST256_mul(&x4, &t, &x2);
+    FPB_NIST256_nsqr(&t, &x4, 4);
+    FPB_NIST256_mul(&x8, &t, &x4);
+    FPB_NIST256_nsqr(&t, &x8, 8);
+    FPB_NIST256_mul(&x16, &t, &x8);
+    FPB_NIST256_nsqr(&t, &x16, 16);
+    FPB_NIST256_mul(&t, &t, &x16);
+
+    FPB_NIST256_nsqr(&t, &t, 32);
+    FPB_NIST256_mul(&t, &t, y);
+    FPB_NIST256_nsqr(&t, &t, 96);
+    FPB_NIST256_mul(&t, &t, y);
+    FPB_NIST256_nsqr(x, &t, 94);
+}
+
+/* Same addition chain for p-2 as FP64_NIST256_inv */
+void FPB_NIST256_inv(FPB_NIST256 *x, const FPB_NIST256 *y)
+{
+    FPB_NIST256 x2, x4, x8, x16, x30, x32, t;
+
+    FPB_NIST256_sqr(&t, y);
+    FPB_NIST256_mul(&x2, &t, y);
+    FPB_NIST256_nsqr(&t, &x2, 2);
+    FPB_NIST256_mul(&x4, &t, &x2);
+    FPB_NIST256_nsqr(&t, &x4, 4);
+    FPB_NIST256_mul(&x8, &t, &x4);
+    FPB_NIST256_nsqr(&t, &x8, 8);
+    FPB_NIST256_mul(&x16, &t, &x8);
+    FPB_NIST256_nsqr(&t, &x16, 8);
+    FPB_NIST256_mul(&t, &t, &x8);
+    FPB_NIST256_nsqr(&t, &t, 4);
+    FPB_NIST256_mul(&t, &t, &x4);
+    FPB_NIST256_nsqr(&t, &t, 2);
+    FPB_NIST256_mul(&x30, &t, &x2);
+    FPB_NIST256_nsqr(&t, &x30, 2);
+    FPB_NIST256_mul(&x32, &t, &x2);
+
+    FPB_NIST256_nsqr(&t, &x32, 32);
+    FPB_NIST256_mul(&t, &t, y);
+    FPB_NIST256_nsqr(&t, &t, 96);
+    FPB_NIST256_nsqr(&t, &t, 32);
+    FPB_NIST256_mul(&t, &t, &x32);
+    FPB_NIST256_nsqr(&t, &t, 32);
+    FPB_NIST256_mul(&t, &t, &x32);
+    FPB_NIST256_nsqr(&t, &t, 30);
+    FPB_NIST256_mul(&t, &t, &x30);
+    FPB_NIST256_nsqr(&t, &t, 2);
+    FPB_NIST256_mul(x, &t, y);
+}
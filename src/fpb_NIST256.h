@@ -0,0 +1,156 @@
+/**
+ * @file fpb_NIST256.h
+ * @brief Eight-lane batch arithmetic modulo the NIST P-256 prime
+ *
+ * An FPB_NIST256 holds eight independent residues in structure-of-arrays
+ * form: limb j of every lane is contiguous, so one 512-bit register holds
+ * the same limb of all eight. Limbs are 52 bits wide, five per residue,
+ * in Montgomery form with R = 2^260, which is the layout AVX-512 IFMA's
+ * 52x52-bit multiply-accumulate wants. As for FP64_NIST256, the low limb
+ * of p is 2^52-1, so -1/p = 1 mod 2^52 and each Montgomery quotient digit
+ * is just the low limb of the accumulator.
+ *
+ * The IFMA kernels are chosen at run time. AVX2 has no 64-bit multiplier,
+ * so there is no 4-lane AVX2 kernel; without IFMA, or when built with
+ * -DFPB_NIST256_NOSIMD, a portable C loop over the lanes computes exactly
+ * the same limbs. Every function runs in constant time.
+ */
+
+#ifndef FPB_NIST256_H
+#define FPB_NIST256_H
+
+#include "core.h"
+#include "fp64_NIST256.h"
+
+#define FPB_NIST256_LANES 8  /**< Residues per batch */
+#define FPB_NIST256_LIMBS 5  /**< 52-bit limbs per residue */
+
+/**
+	@brief Eight residues modulo p, limb-major, each fully reduced to [0, p)
+*/
+typedef struct
+{
+    unsign64 v[FPB_NIST256_LIMBS][FPB_NIST256_LANES];  /**< v[j][i] is limb j of lane i */
+} FPB_NIST256;
+
+/* Batch field function prototypes */
+
+/**	@brief Selects the IFMA kernels, if the CPU has them, or the portable ones
+ *
+	Kernels are chosen automatically, and thread-safely, on first use; this
+	overrides the choice, for comparing the two. Both give identical limbs,
+	so arithmetic in other threads stays correct across the switch.
+	@param on 1 to use IFMA when available, 0 to force portable C
+	@return 1 if the IFMA kernels are now in use, else 0
+ */
+extern int FPB_NIST256_simd(int on);
+/**	@brief Tests which kernels are in use
+ *
+	Batch callers use this to decide whether eight lanes beat eight
+	scalar FP64_NIST256 calls, which they only do with IFMA.
+	@return 1 if the IFMA kernels are in use, else 0
+ */
+extern int FPB_NIST256_simd_active(void);
+/**	@brief Set all lanes to zero
+ *
+	@param x FPB number to be set to 0
+ */
+extern void FPB_NIST256_zero(FPB_NIST256 *x);
+/**	@brief Set all lanes to one
+ *
+	@param x FPB number to be set to 1
+ */
+extern void FPB_NIST256_one(FPB_NIST256 *x);
+/**	@brief Copy an FPB number
+ *
+	@param y FPB number to be copied to
+	@param x FPB number to be copied from
+ */
+extern void FPB_NIST256_copy(FPB_NIST256 *y, const FPB_NIST256 *x);
+/**	@brief Per-lane test for zero
+ *
+	@param mask per-lane outputs, all ones where the lane of x is zero, else 0
+	@param x FPB number to be tested
+ */
+extern void FPB_NIST256_iszilch(unsign64 *mask, const FPB_NIST256 *x);
+/**	@brief Per-lane conditional copy of FPB number
+ *
+	Copies lane i of y to x where mask[i] is all ones, without branching
+	@param x FPB instance
+	@param y another FPB instance
+	@param mask per-lane masks, each 0 or all ones
+ */
+extern void FPB_NIST256_cmove(FPB_NIST256 *x, const FPB_NIST256 *y, const unsign64 *mask);
+/**	@brief Loads one lane from an FP64 residue
+ *
+	@param x FPB instance, lane i on exit = y
+	@param i the lane, 0 <= i < FPB_NIST256_LANES
+	@param y FP64 instance
+ */
+extern void FPB_NIST256_set(FPB_NIST256 *x, int i, const FP64_NIST256 *y);
+/**	@brief Reads one lane as an FP64 residue
+ *
+	@param y FP64 instance, on exit = lane i of x
+	@param x FPB instance
+	@param i the lane, 0 <= i < FPB_NIST256_LANES
+ */
+extern void FPB_NIST256_get(FP64_NIST256 *y, const FPB_NIST256 *x, int i);
+/**	@brief Reduces every lane into [0, p)
+ *
+	Normalises the limbs of x and subtracts p once where needed. Inputs
+	may be any value below 2p with limbs of up to 63 bits.
+	@param x FPB instance, reduced on exit
+ */
+extern void FPB_NIST256_reduce(FPB_NIST256 *x);
+/**	@brief Lane-wise modular addition of two FPBs
+ *
+	@param x FPB instance, on exit = y+z mod p
+	@param y FPB instance
+	@param z FPB instance
+ */
+extern void FPB_NIST256_add(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z);
+/**	@brief Lane-wise modular subtraction of two FPBs
+ *
+	@param x FPB instance, on exit = y-z mod p
+	@param y FPB instance
+	@param z FPB instance
+ */
+extern void FPB_NIST256_sub(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z);
+/**	@brief Lane-wise modular negation of an FPB
+ *
+	@param x FPB instance, on exit = -y mod p
+	@param y FPB instance
+ */
+extern void FPB_NIST256_neg(FPB_NIST256 *x, const FPB_NIST256 *y);
+/**	@brief Lane-wise modular multiplication of two FPBs
+ *
+	@param x FPB instance, on exit = y*z mod p
+	@param y FPB instance
+	@param z FPB instance
+ */
+extern void FPB_NIST256_mul(FPB_NIST256 *x, const FPB_NIST256 *y, const FPB_NIST256 *z);
+/**	@brief Lane-wise modular squaring of an FPB
+ *
+	@param x FPB instance, on exit = y^2 mod p
+	@param y FPB instance
+ */
+extern void FPB_NIST256_sqr(FPB_NIST256 *x, const FPB_NIST256 *y);
+/**	@brief Lane-wise square root, y^((p+1)/4) mod p
+ *
+	The addition chain of FP64_NIST256_sqrt, all eight lanes at the cost
+	of one. A lane that is not a square gets a root of -y instead, so the
+	caller checks x^2 = y.
+	@param x FPB instance, on exit a square root of y where there is one
+	@param y FPB instance
+ */
+extern void FPB_NIST256_sqrt(FPB_NIST256 *x, const FPB_NIST256 *y);
+/**	@brief Lane-wise inverse, 1/y mod p
+ *
+	Fermat inversion y^(p-2), all eight lanes at the cost of one. A zero
+	lane gives zero.
+	@param x FPB instance, on exit = 1/y mod p
+	@param y FPB instance
+ */
+extern void FPB_NIST256_inv(FPB_NIST256 *x, const FPB_NIST256 *y);
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * fr64_NIST256.c - Full-radix Montgomery arithmetic modulo the P-256 group order
+ *
+ * r = FFFFFFFF 00000000 FFFFFFFF FFFFFFFF BCE6FAAD A7179E84 F3B9CAC2 FC632551
+ * Each Montgomery step takes m = t_i.n0 mod 2^64 with n0 = -1/r, adds m.r,
+ * which clears limb t_i, and moves on to the next limb.
+ */
+
+#include "fr64_NIST256.h"
+#ifdef NIST256_SAFEGCD
+#include "safegcd_NIST256.h"
+#endif
+
+typedef unsigned __int128 u128;
+
+static const unsign64 R[4] = {0xF3B9CAC2FC632551ULL, 0xBCE6FAADA7179E84ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL};
+
+/* -1/r mod 2^64 */
+static const unsign64 N0 = 0xCCD1C8AAEE00BC4FULL;
+
+/* 2^256 mod r, the Montgomery form of 1 */
+static const unsign64 ONE[4] = {0x0C46353D039CDAAFULL, 0x4319055258E8617BULL, 0x0000000000000000ULL, 0x00000000FFFFFFFFULL};
+
+/* 2^512 mod r, converts into Montgomery form */
+static const FR64_NIST256 R2 = {{0x83244C95BE79EEA2ULL, 0x4699799C49BD6FA6ULL, 0x2845B2392B6BEC59ULL, 0x66E12D94F3D95620ULL}};
+
+/* 2^768 mod r, converts the top half of a 512-bit value */
+static const FR64_NIST256 R3 = {{0xAC8EBEC90B65A624ULL, 0x111F28AE0C0555C9ULL, 0x2543B9246BA5E93FULL, 0x503A54E76407BE65ULL}};
+
+/* x = (x + top.2^256) mod r, for x + top.2^256 < 2r */
+static void FR64_NIST256_csub(unsign64 *x, unsign64 top)
+{
+    unsign64 s[4], b = 0, mask;
+    u128 t;
+
+    for (int i = 0; i < 4; i++)
+    {
+        t = (u128)x[i] - R[i] - b;
+        s[i] = (unsign64)t;
+        b = (unsign64)(t >> 64) & 1;
+    }
+    /* x >= r exactly when the subtraction did not borrow, or there was a carry out */
+    mask = (top ^ b) - 1;
+    for (int i = 0; i < 4; i++) x[i] = (s[i] & mask) | (x[i] & ~mask);
+}
+
+/* x = t/2^256 mod r, for t < r.2^256 */
+static void FR64_NIST256_redc(unsign64 *x, unsign64 *t)
+{
+    unsign64 m, c, top = 0;
+    u128 s;
+
+    for (int i = 0; i < 4; i++)
+    {
+        m = t[i] * N0;
+        c = 0;
+        for (int j = 0; j < 4; j++)
+        {
+            s = (u128)m * R[j] + t[i + j] + c;
+            t[i + j] = (unsign64)s;
+            c = (unsign64)(s >> 64);
+        }
+        for (int j = i + 4; j < 8; j++)
+        {
+            s = (u128)t[j] + c;
+            t[j] = (unsign64)s;
+            c = (unsign64)(s >> 64);
+        }
+        top += c;
+    }
+    for (int i = 0; i < 4; i++) x[i] = t[i + 4];
+    FR64_NIST256_csub(x, top);
+}
+
+void FR64_NIST256_zero(FR64_NIST256 *x)
+{
+    for (int i = 0; i < 4; i++) x->v[i] = 0;
+}
+
+void FR64_NIST256_one(FR64_NIST256 *x)
+{
+    for (int i = 0; i < 4; i++) x->v[i] = ONE[i];
+}
+
+void FR64_NIST256_copy(FR64_NIST256 *y, const FR64_NIST256 *x)
+{
+    for (int i = 0; i < 4; i++) y->v[i] = x->v[i];
+}
+
+int FR64_NIST256_iszilch(const FR64_NIST256 *x)
+{
+    unsign64 d = x->v[0] | x->v[1] | x->v[2] | x->v[3];
+    return (int)(((d | (0 - d)) >> 63) ^ 1);
+}
+
+int FR64_NIST256_equals(const FR64_NIST256 *x, const FR64_NIST256 *y)
+{
+    unsign64 d = 0;
+    for (int i = 0; i < 4; i++) d |= x->v[i] ^ y->v[i];
+    return (int)(((d | (0 - d)) >> 63) ^ 1);
+}
+
+void FR64_NIST256_cmove(FR64_NIST256 *x, const FR64_NIST256 *y, int s)
+{
+    unsign64 mask = 0 - (unsign64)(s != 0);
+    for (int i = 0; i < 4; i++) x->v[i] ^= (x->v[i] ^ y->v[i]) & mask;
+}
+
+void FR64_NIST256_mul(FR64_NIST256 *x, const FR64_NIST256 *y, const FR64_NIST256 *z)
+{
+    unsign64 t[8], c;
+    u128 s;
+
+    for (int i = 0; i < 8; i++) t[i] = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        c = 0;
+        for (int j = 0; j < 4; j++)
+        {
+            s = (u128)y->v[j] * z->v[i] + t[i + j] + c;
+            t[i + j] = (unsign64)s;
+            c = (unsign64)(s >> 64);
+        }
+        t[i + 4] = c;
+    }
+    FR64_NIST256_redc(x->v, t);
+}
+
+void FR64_NIST256_sqr(FR64_NIST256 *x, const FR64_NIST256 *y)
+{
+    FR64_NIST256_mul(x, y, y);
+}
+
+void FR64_NIST256_add(FR64_NIST256 *x, const FR64_NIST256 *y, const FR64_NIST256 *z)
+{
+    unsign64 c = 0;
+    u128 s;
+
+    for (int i = 0; i < 4; i++)
+    {
+        s = (u128)y->v[i] + z->v[i] + c;
+        x->v[i] = (unsign64)s;
+        c = (unsign64)(s >> 64);
+    }
+    FR64_NIST256_csub(x->v, c);
+}
+
+void FR64_NIST256_sub(FR64_NIST256 *x, const FR64_NIST256 *y, const FR64_NIST256 *z)
+{
+    unsign64 b = 0, c = 0, mask;
+    u128 s;
+
+    for (int i = 0; i < 4; i++)
+    {
+        s = (u128)y->v[i] - z->v[i] - b;
+        x->v[i] = (unsign64)s;
+        b = (unsign64)(s >> 64) & 1;
+    }
+
+    /* Add r back if it went negative */
+    mask = 0 - b;
+    for (int i = 0; i < 4; i++)
+    {
+        s = (u128)x->v[i] + (R[i] & mask) + c;
+        x->v[i] = (unsign64)s;
+        c = (unsign64)(s >> 64);
+    }
+}
+
+void FR64_NIST256_neg(FR64_NIST256 *x, const FR64_NIST256 *y)
+{
+    FR64_NIST256 z;
+    FR64_NIST256_zero(&z);
+    FR64_NIST256_sub(x, &z, y);
+}
+
+#ifdef NIST256_SAFEGCD
+
+/* y holds a.2^256, safegcd gives 1/(a.2^256), and a Montgomery product with 2^768 makes that 2^256/a */
+void FR64_NIST256_inv(FR64_NIST256 *x, const FR64_NIST256 *y)
+{
+    FR64_NIST256 t;
+
+    SAFEGCD_NIST256_modr(t.v, y->v);
+    FR64_NIST256_mul(x, &t, &R3);
+}
+
+#else
+
+/* y^(r-2), left to right over 4-bit windows. The exponent is public, so the table index may depend on it */
+void FR64_NIST256_inv(FR64_NIST256 *x, const FR64_NIST256 *y)
+{
+    static const unsign64 E[4] = {0xF3B9CAC2FC63254FULL, 0xBCE6FAADA7179E84ULL, 0xFFFFFFFFFFFFFFFFULL, 0xFFFFFFFF00000000ULL};
+    FR64_NIST256 T[16], t;
+
+    FR64_NIST256_one(&T[0]);
+    FR64_NIST256_copy(&T[1], y);
+    for (int i = 2; i < 16; i++) FR64_NIST256_mul(&T[i], &T[i - 1], y);
+
+    FR64_NIST256_one(&t);
+    for (int i = 63; i >= 0; i--)
+    {
+        for (int j = 0; j < 4; j++) FR64_NIST256_sqr(&t, &t);
+        FR64_NIST256_mul(&t, &t, &T[(E[i / 16] >> (4 * (i % 16))) & 0xf]);
+    }
+    FR64_NIST256_copy(x, &t);
+}
+
+#endif
+
+void FR64_NIST256_fromBytes(FR64_NIST256 *x, const char *b)
+{
+    FR64_NIST256 a;
+
+    for (int i = 0; i < 4; i++)
+    {
+        unsign64 w = 0;
+        for (int j = 0; j < 8; j++) w = (w << 8) | (unsign64)(unsigned char)b[8 * (3 - i) + j];
+        a.v[i] = w;
+    }
+    FR64_NIST256_mul(x, &a, &R2);
+}
+
+/* b = hi.2^256 + lo, and (hi.2^256 + lo).2^256 = hi.2^768/2^256 + lo.2^512/2^256 */
+void FR64_NIST256_fromBytesLen(FR64_NIST256 *x, const char *b, int len)
+{
+    char w[64];
+    FR64_NIST256 hi, lo;
+
+    for (int i = 0; i < 64 - len; i++) w[i] = 0;
+    for (int i = 0; i < len; i++) w[64 - len + i] = b[i];
+
+    FR64_NIST256_fromBytes(&lo, &w[32]);
+    for (int i = 0; i < 4; i++)
+    {
+        unsign64 v = 0;
+        for (int j = 0; j < 8; j++) v = (v << 8) | (unsign64)(unsigned char)w[8 * (3 - i) + j];
+        hi.v[i] = v;
+    }
+    FR64_NIST256_mul(&hi, &hi, &R3);
+    FR64_NIST256_add(x, &hi, &lo);
+
+    for (int i = 0; i < 64; i++) w[i] = 0;
+}
+
+void FR64_NIST256_toBytes(char *b, const FR64_NIST256 *x)
+{
+    unsign64 t[8], r[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        t[i] = x->v[i];
+        t[i + 4] = 0;
+    }
+    FR64_NIST256_redc(r, t);
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 8; j++) b[8 * (3 - i) + j] = (char)(r[i] >> (56 - 8 * j));
+}
+
+void FR64_NIST256_fromBIG(FR64_NIST256 *x, BIG_256_56 y)
+{
+    char b[MODBYTES_256_56];
+
+    BIG_256_56_toBytes(b, y);
+    FR64_NIST256_fromBytes(x, b);
+    for (int i = 0; i < MODBYTES_256_56; i++) b[i] = 0;
+}
+
+void FR64_NIST256_toBIG(BIG_256_56 x, const FR64_NIST256 *y)
+{
+    char b[MODBYTES_256_56];
+
+    FR64_NIST256_toBytes(b, y);
+    BIG_256_56_fromBytes(x, b);
+    for (int i = 0; i < MODBYTES_256_56; i++) b[i] = 0;
+}
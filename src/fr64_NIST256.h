@@ -0,0 +1,146 @@
+/**
+ * @file fr64_NIST256.h
+ * @brief Full-radix arithmetic modulo the NIST P-256 group order
+ *
+ * ECDSA's scalar work is done modulo the group order r, which MIRACL Core
+ * handles with BIG_256_56_modmul: a full 512-bit product followed by a
+ * long division. This backend keeps scalars in four 64-bit limbs in
+ * Montgomery form with R = 2^256, like FP64_NIST256 does for the field.
+ * r has no special shape, so each reduction step computes its quotient
+ * digit with one multiplication by -1/r mod 2^64.
+ *
+ * Inversion is Fermat exponentiation x^(r-2) over fixed 4-bit windows,
+ * or safegcd when built with -DNIST256_SAFEGCD. Every function runs in
+ * constant time, apart from FR64_NIST256_equals and FR64_NIST256_iszilch,
+ * whose result is the only thing that depends on the data.
+ */
+
+#ifndef FR64_NIST256_H
+#define FR64_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+
+#define FR64_NIST256_LIMBS 4  /**< 64-bit limbs per scalar */
+
+/**
+	@brief Scalar modulo r in Montgomery form, fully reduced to [0, r)
+*/
+typedef struct
+{
+    unsign64 v[FR64_NIST256_LIMBS];  /**< Little-endian limbs of x.2^256 mod r */
+} FR64_NIST256;
+
+/* Scalar field function prototypes */
+
+/**	@brief Set to zero
+ *
+	@param x FR64 number to be set to 0
+ */
+extern void FR64_NIST256_zero(FR64_NIST256 *x);
+/**	@brief Set to one
+ *
+	@param x FR64 number to be set to 1
+ */
+extern void FR64_NIST256_one(FR64_NIST256 *x);
+/**	@brief Copy an FR64 number
+ *
+	@param y FR64 number to be copied to
+	@param x FR64 number to be copied from
+ */
+extern void FR64_NIST256_copy(FR64_NIST256 *y, const FR64_NIST256 *x);
+/**	@brief Tests for FR64 equal to zero
+ *
+	@param x FR64 number to be tested
+	@return 1 if zero, else returns 0
+ */
+extern int FR64_NIST256_iszilch(const FR64_NIST256 *x);
+/**	@brief Tests for equality of two FR64s
+ *
+	@param x FR64 instance to be compared
+	@param y FR64 instance to be compared
+	@return 1 if x=y, else returns 0
+ */
+extern int FR64_NIST256_equals(const FR64_NIST256 *x, const FR64_NIST256 *y);
+/**	@brief Conditional copy of FR64 number
+ *
+	Conditionally copies second parameter to the first (without branching)
+	@param x FR64 instance, set to y if s!=0
+	@param y another FR64 instance
+	@param s copy only takes place if not equal to 0
+ */
+extern void FR64_NIST256_cmove(FR64_NIST256 *x, const FR64_NIST256 *y, int s);
+/**	@brief Modular multiplication of two FR64s
+ *
+	@param x FR64 instance, on exit = y*z mod r
+	@param y FR64 instance
+	@param z FR64 instance
+ */
+extern void FR64_NIST256_mul(FR64_NIST256 *x, const FR64_NIST256 *y, const FR64_NIST256 *z);
+/**	@brief Modular squaring of an FR64
+ *
+	@param x FR64 instance, on exit = y^2 mod r
+	@param y FR64 instance
+ */
+extern void FR64_NIST256_sqr(FR64_NIST256 *x, const FR64_NIST256 *y);
+/**	@brief Modular addition of two FR64s
+ *
+	@param x FR64 instance, on exit = y+z mod r
+	@param y FR64 instance
+	@param z FR64 instance
+ */
+extern void FR64_NIST256_add(FR64_NIST256 *x, const FR64_NIST256 *y, const FR64_NIST256 *z);
+/**	@brief Modular subtraction of two FR64s
+ *
+	@param x FR64 instance, on exit = y-z mod r
+	@param y FR64 instance
+	@param z FR64 instance
+ */
+extern void FR64_NIST256_sub(FR64_NIST256 *x, const FR64_NIST256 *y, const FR64_NIST256 *z);
+/**	@brief Modular negation of an FR64
+ *
+	@param x FR64 instance, on exit = -y mod r
+	@param y FR64 instance
+ */
+extern void FR64_NIST256_neg(FR64_NIST256 *x, const FR64_NIST256 *y);
+/**	@brief Inverse of an FR64, 1/y mod r
+ *
+	@param x FR64 instance, on exit = 1/y mod r, or 0 if y = 0
+	@param y FR64 instance
+ */
+extern void FR64_NIST256_inv(FR64_NIST256 *x, const FR64_NIST256 *y);
+/**	@brief Converts a 32-byte big-endian integer to an FR64 scalar
+ *
+	@param x FR64 instance, on exit = b mod r in Montgomery form
+	@param b input byte array
+ */
+extern void FR64_NIST256_fromBytes(FR64_NIST256 *x, const char *b);
+/**	@brief Converts a big-endian integer of up to 64 bytes to an FR64 scalar
+ *
+	For hash digests: two Montgomery multiplications reduce the full
+	512-bit value, with no long division.
+	@param x FR64 instance, on exit = b mod r in Montgomery form
+	@param b input byte array
+	@param len the length of b in bytes, 0 <= len <= 64
+ */
+extern void FR64_NIST256_fromBytesLen(FR64_NIST256 *x, const char *b, int len);
+/**	@brief Converts an FR64 scalar to a 32-byte big-endian integer
+ *
+	@param b output byte array
+	@param x FR64 instance
+ */
+extern void FR64_NIST256_toBytes(char *b, const FR64_NIST256 *x);
+/**	@brief Converts a MIRACL BIG to an FR64 scalar
+ *
+	@param x FR64 instance, on exit = y mod r in Montgomery form
+	@param y BIG number, 0 <= y < 2^256
+ */
+extern void FR64_NIST256_fromBIG(FR64_NIST256 *x, BIG_256_56 y);
+/**	@brief Converts an FR64 scalar to a MIRACL BIG
+ *
+	@param x BIG number, on exit the value of y, 0 <= x < r
+	@param y FR64 instance
+ */
+extern void FR64_NIST256_toBIG(BIG_256_56 x, const FR64_NIST256 *y);
+
+#endif
@@ -0,0 +1,478 @@
+/**
+ * gcm.c - Bulk AES-GCM on MIRACL Core's gcm state, with PCLMULQDQ GHASH
+ *
+ * GHASH works on bit-reflected blocks. The kernels byte-reverse each
+ * block as they load it, so that a register holds the block as a
+ * polynomial over GF(2), only with its bits reflected: the carry-less
+ * product of two is then one bit short, and is shifted left once before
+ * reduction modulo x^128 + x^7 + x^2 + x + 1, as in Gueron and Kounavis's
+ * white paper on carry-less multiplication. Both steps are linear, so the
+ * products of eight blocks with H^8..H are summed first and shifted and
+ * reduced once.
+ *
+ * The GHASH state, stateX, stays byte-reversed in a register through a
+ * call. The counter block, a.f, is held byte-reversed as in aes.c, and
+ * incremented before each block as GCM_add_plain does.
+ */
+
+#include <string.h>
+
+#include "gcm.h"
+#include "aes.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(AES_NOSIMD)
+#define GCM_X86
+#include <immintrin.h>
+#endif
+
+static int GCM_active = -1;
+
+#ifdef GCM_X86
+
+#define CLMUL_TARGET __attribute__((target("aes,pclmul,sse4.1")))
+
+/* The 128 x 128-bit carry-less product of a and b, summed into lo, mid and hi */
+#define GCM_MULACC(a, b)                                                \
+    do                                                                  \
+    {                                                                   \
+        lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(a, b, 0x00));       \
+        hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(a, b, 0x11));       \
+        mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(a, b, 0x01));     \
+        mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(a, b, 0x10));     \
+    } while (0)
+
+/* One round f with key k on each of the eight blocks x0..x7 */
+#define GCM_ROUND8(f, k)    \
+    do                      \
+    {                       \
+        x0 = f(x0, k);      \
+        x1 = f(x1, k);      \
+        x2 = f(x2, k);      \
+        x3 = f(x3, k);      \
+        x4 = f(x4, k);      \
+        x5 = f(x5, k);      \
+        x6 = f(x6, k);      \
+        x7 = f(x7, k);      \
+    } while (0)
+
+/* The GHASH product from the sums of GCM_MULACC: shift left one bit, then reduce */
+CLMUL_TARGET static inline __m128i GCM_reduce(__m128i lo, __m128i mid, __m128i hi)
+{
+    __m128i a, b, c;
+
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    a = _mm_srli_epi32(lo, 31);
+    b = _mm_srli_epi32(hi, 31);
+    c = _mm_srli_si128(a, 12);
+    lo = _mm_or_si128(_mm_slli_epi32(lo, 1), _mm_slli_si128(a, 4));
+    hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(hi, 1), _mm_slli_si128(b, 4)), c);
+
+    a = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    b = _mm_srli_si128(a, 4);
+    lo = _mm_xor_si128(lo, _mm_slli_si128(a, 12));
+    a = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    lo = _mm_xor_si128(lo, _mm_xor_si128(a, b));
+    return _mm_xor_si128(hi, lo);
+}
+
+/* A row of the table, its words big-endian as MIRACL keeps H in the first row, byte-reversed */
+CLMUL_TARGET static inline __m128i GCM_row(const unsign32 *t)
+{
+    return _mm_set_epi32((int)t[0], (int)t[1], (int)t[2], (int)t[3]);
+}
+
+/* hp[i] = H^(i+1) for i < 8, from the first row of the table */
+CLMUL_TARGET static void GCM_powers(__m128i *hp, const unsign32 *t)
+{
+    __m128i lo, mid, hi;
+
+    hp[0] = GCM_row(t);
+    for (int i = 1; i < 8; i++)
+    {
+        lo = mid = hi = _mm_setzero_si128();
+        GCM_MULACC(hp[i - 1], hp[0]);
+        hp[i] = GCM_reduce(lo, mid, hi);
+    }
+}
+
+/* hp = H..H^8 as GCM_init_bulk keeps them in rows 0..7. A gcm from GCM_init has MIRACL's H.x
+   in row 1 instead, row 0 shifted right a bit and reduced, and gets its powers computed afresh */
+CLMUL_TARGET static void GCM_load_powers(__m128i *hp, const gcm *G)
+{
+    const unsign32 *h = G->table[0], *r = G->table[1];
+
+    if (r[0] == (h[0] >> 1 ^ (h[3] & 1 ? 0xE1000000 : 0)) && r[1] == (h[1] >> 1 | h[0] << 31) &&
+            r[2] == (h[2] >> 1 | h[1] << 31) && r[3] == (h[3] >> 1 | h[2] << 31))
+    {
+        GCM_powers(hp, h);
+        return;
+    }
+    for (int i = 0; i < 8; i++) hp[i] = GCM_row(G->table[i]);
+}
+
+/* GHASH of n whole blocks b into x, with hp = H..H^8, or just H if n < 8 */
+CLMUL_TARGET static __m128i GCM_ghash_clmul(__m128i x, const __m128i *hp, const unsigned char *b, int n)
+{
+    const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i d, lo, mid, hi;
+
+    for (; n >= 8; n -= 8, b += 8 * AES_BLOCK)
+    {
+        lo = mid = hi = _mm_setzero_si128();
+        for (int i = 0; i < 8; i++)
+        {
+            d = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(b + 16 * i)), rev);
+            if (i == 0) d = _mm_xor_si128(d, x);
+            GCM_MULACC(d, hp[7 - i]);
+        }
+        x = GCM_reduce(lo, mid, hi);
+    }
+    for (; n > 0; n--, b += AES_BLOCK)
+    {
+        d = _mm_xor_si128(_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)b), rev), x);
+        lo = mid = hi = _mm_setzero_si128();
+        GCM_MULACC(d, hp[0]);
+        x = GCM_reduce(lo, mid, hi);
+    }
+    return x;
+}
+
+/* GHASH of n bytes b into x, the last block padded with zeros */
+CLMUL_TARGET static __m128i GCM_ghash_bytes(__m128i x, const __m128i *hp, const char *b, int n)
+{
+    unsigned char d[AES_BLOCK] = {0};
+
+    x = GCM_ghash_clmul(x, hp, (const unsigned char *)b, n / AES_BLOCK);
+    if (n % AES_BLOCK == 0) return x;
+    memcpy(d, b + n - n % AES_BLOCK, (size_t)(n % AES_BLOCK));
+    return GCM_ghash_clmul(x, hp, d, 1);
+}
+
+/*
+ * n whole blocks of GCM, encrypting (dec = 0) or decrypting from counter
+ * block ctr, which is advanced, and hashing the ciphertext into x. The
+ * ciphertext of eight blocks is hashed during the AES rounds of the next
+ * eight when encrypting, and of the same eight when decrypting.
+ */
+CLMUL_TARGET static __m128i GCM_crypt_clmul(const unsign32 *key, int nr, unsigned char *ctr, __m128i x, const __m128i *hp,
+                                            unsigned char *out, const unsigned char *in, int n, int dec)
+{
+    const __m128i rev = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i rk[15], g[8], x0, x1, x2, x3, x4, x5, x6, x7, lo, mid, hi, d;
+    __m128i c = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)ctr), rev);
+    int pend = 0;
+
+    for (int r = 0; r <= nr; r++) rk[r] = _mm_loadu_si128((const __m128i *)(key + 4 * r));
+    for (int i = 0; i < 8; i++) g[i] = _mm_setzero_si128();
+    for (; n >= 8; n -= 8, in += 8 * AES_BLOCK, out += 8 * AES_BLOCK)
+    {
+        x0 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 1)), rev);
+        x1 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 2)), rev);
+        x2 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 3)), rev);
+        x3 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 4)), rev);
+        x4 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 5)), rev);
+        x5 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 6)), rev);
+        x6 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 7)), rev);
+        x7 = _mm_shuffle_epi8(_mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 8)), rev);
+        c = _mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 8));
+        if (dec)
+        {
+            for (int i = 0; i < 8; i++) g[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 16 * i)), rev);
+            g[0] = _mm_xor_si128(g[0], x);
+            pend = 1;
+        }
+
+        /* At least ten rounds, so one block of GHASH alongside each of the first eight after the whitening */
+        lo = mid = hi = _mm_setzero_si128();
+        GCM_ROUND8(_mm_xor_si128, rk[0]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[1]);
+        GCM_MULACC(g[0], hp[7]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[2]);
+        GCM_MULACC(g[1], hp[6]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[3]);
+        GCM_MULACC(g[2], hp[5]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[4]);
+        GCM_MULACC(g[3], hp[4]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[5]);
+        GCM_MULACC(g[4], hp[3]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[6]);
+        GCM_MULACC(g[5], hp[2]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[7]);
+        GCM_MULACC(g[6], hp[1]);
+        GCM_ROUND8(_mm_aesenc_si128, rk[8]);
+        GCM_MULACC(g[7], hp[0]);
+        for (int r = 9; r < nr; r++) GCM_ROUND8(_mm_aesenc_si128, rk[r]);
+        GCM_ROUND8(_mm_aesenclast_si128, rk[nr]);
+        if (pend) x = GCM_reduce(lo, mid, hi);
+
+        x0 = _mm_xor_si128(x0, _mm_loadu_si128((const __m128i *)in));
+        x1 = _mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)(in + 16)));
+        x2 = _mm_xor_si128(x2, _mm_loadu_si128((const __m128i *)(in + 32)));
+        x3 = _mm_xor_si128(x3, _mm_loadu_si128((const __m128i *)(in + 48)));
+        x4 = _mm_xor_si128(x4, _mm_loadu_si128((const __m128i *)(in + 64)));
+        x5 = _mm_xor_si128(x5, _mm_loadu_si128((const __m128i *)(in + 80)));
+        x6 = _mm_xor_si128(x6, _mm_loadu_si128((const __m128i *)(in + 96)));
+        x7 = _mm_xor_si128(x7, _mm_loadu_si128((const __m128i *)(in + 112)));
+        _mm_storeu_si128((__m128i *)out, x0);
+        _mm_storeu_si128((__m128i *)(out + 16), x1);
+        _mm_storeu_si128((__m128i *)(out + 32), x2);
+        _mm_storeu_si128((__m128i *)(out + 48), x3);
+        _mm_storeu_si128((__m128i *)(out + 64), x4);
+        _mm_storeu_si128((__m128i *)(out + 80), x5);
+        _mm_storeu_si128((__m128i *)(out + 96), x6);
+        _mm_storeu_si128((__m128i *)(out + 112), x7);
+        if (!dec)
+        {
+            g[0] = _mm_xor_si128(_mm_shuffle_epi8(x0, rev), x);
+            g[1] = _mm_shuffle_epi8(x1, rev);
+            g[2] = _mm_shuffle_epi8(x2, rev);
+            g[3] = _mm_shuffle_epi8(x3, rev);
+            g[4] = _mm_shuffle_epi8(x4, rev);
+            g[5] = _mm_shuffle_epi8(x5, rev);
+            g[6] = _mm_shuffle_epi8(x6, rev);
+            g[7] = _mm_shuffle_epi8(x7, rev);
+            pend = 1;
+        }
+    }
+    if (!dec && pend)
+    {
+        lo = mid = hi = _mm_setzero_si128();
+        for (int i = 0; i < 8; i++) GCM_MULACC(g[i], hp[7 - i]);
+        x = GCM_reduce(lo, mid, hi);
+    }
+
+    for (; n > 0; n--, in += AES_BLOCK, out += AES_BLOCK)
+    {
+        c = _mm_add_epi32(c, _mm_set_epi32(0, 0, 0, 1));
+        x0 = _mm_xor_si128(_mm_shuffle_epi8(c, rev), rk[0]);
+        for (int r = 1; r < nr; r++) x0 = _mm_aesenc_si128(x0, rk[r]);
+        d = _mm_loadu_si128((const __m128i *)in);
+        x0 = _mm_xor_si128(_mm_aesenclast_si128(x0, rk[nr]), d);
+        _mm_storeu_si128((__m128i *)out, x0);
+        d = _mm_xor_si128(_mm_shuffle_epi8(dec ? d : x0, rev), x);
+        lo = mid = hi = _mm_setzero_si128();
+        GCM_MULACC(d, hp[0]);
+        x = GCM_reduce(lo, mid, hi);
+    }
+    _mm_storeu_si128((__m128i *)ctr, _mm_shuffle_epi8(c, rev));
+    return x;
+}
+
+/* The GHASH state of G, byte-reversed */
+CLMUL_TARGET static inline __m128i GCM_state(const gcm *G)
+{
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)G->stateX),
+                            _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+CLMUL_TARGET static inline void GCM_set_state(gcm *G, __m128i x)
+{
+    _mm_storeu_si128((__m128i *)G->stateX, _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));
+}
+
+/* GHASH of the final block of lengths in bits, len(A) then len(C) */
+CLMUL_TARGET static __m128i GCM_wrap_clmul(__m128i x, const __m128i *hp, const unsign32 *la, const unsign32 *lc)
+{
+    __m128i lo, mid, hi;
+    unsign64 a = ((unsign64)la[0] << 32 | la[1]) << 3, c = ((unsign64)lc[0] << 32 | lc[1]) << 3;
+
+    x = _mm_xor_si128(x, _mm_set_epi64x((long long)a, (long long)c));
+    lo = mid = hi = _mm_setzero_si128();
+    GCM_MULACC(x, hp[0]);
+    return GCM_reduce(lo, mid, hi);
+}
+
+CLMUL_TARGET static void GCM_init_clmul(gcm *G, int nk, char *k, int n, char *iv)
+{
+    __m128i hp[8], x;
+    unsigned char h[AES_BLOCK] = {0};
+    unsign32 z[2] = {0, 0}, ln[2] = {0, (unsign32)n};
+
+    AES_init_encrypt(&G->a, ECB, nk, k, NULL);
+    AES_ecb_encrypt_blocks(&G->a, h, 1);
+    for (int i = 0; i < 4; i++)
+        G->table[0][i] = (unsign32)h[4 * i] << 24 | (unsign32)h[4 * i + 1] << 16 | (unsign32)h[4 * i + 2] << 8 | h[4 * i + 3];
+    /* H^2..H^8 after it, computed once per key rather than on every call */
+    GCM_powers(hp, G->table[0]);
+    for (int i = 1; i < 8; i++) _mm_storeu_si128((__m128i *)G->table[i], _mm_shuffle_epi32(hp[i], 0x1B));
+    memset(G->stateX, 0, sizeof(G->stateX));
+    G->lenA[0] = G->lenA[1] = G->lenC[0] = G->lenC[1] = 0;
+    if (n == 12)
+    {
+        memcpy(G->a.f, iv, 12);
+        G->a.f[12] = G->a.f[13] = G->a.f[14] = 0;
+        G->a.f[15] = 1;
+    }
+    else
+    {
+        /* Y_0 = GHASH(IV) with len(A) = 0 */
+        x = GCM_ghash_bytes(_mm_setzero_si128(), hp, iv, n);
+        GCM_set_state(G, GCM_wrap_clmul(x, hp, z, ln));
+        memcpy(G->a.f, G->stateX, AES_BLOCK);
+        memset(G->stateX, 0, sizeof(G->stateX));
+    }
+    memcpy(G->Y_0, G->a.f, AES_BLOCK);
+    G->status = GCM_ACCEPTING_HEADER;
+    memset(h, 0, sizeof(h));
+}
+
+CLMUL_TARGET static int GCM_header_clmul(gcm *G, char *b, int n)
+{
+    __m128i hp[8];
+
+    if (G->status != GCM_ACCEPTING_HEADER) return 0;
+    GCM_load_powers(hp, G);
+    GCM_set_state(G, GCM_ghash_bytes(GCM_state(G), hp, b, n));
+    G->lenA[1] += (unsign32)n;
+    if (G->lenA[1] < (unsign32)n) G->lenA[0]++;
+    if (n % AES_BLOCK != 0) G->status = GCM_ACCEPTING_CIPHER;
+    return 1;
+}
+
+CLMUL_TARGET static int GCM_crypt_bulk(gcm *G, char *out, char *in, int n, int dec)
+{
+    __m128i hp[8], x;
+    unsigned char k[AES_BLOCK], d[AES_BLOCK] = {0}, *f = (unsigned char *)G->a.f;
+    int m = n / AES_BLOCK, r = n % AES_BLOCK;
+
+    if (G->status == GCM_ACCEPTING_HEADER) G->status = GCM_ACCEPTING_CIPHER;
+    if (G->status != GCM_ACCEPTING_CIPHER) return 0;
+    GCM_load_powers(hp, G);
+    x = GCM_crypt_clmul(G->a.fkey, G->a.Nr, f, GCM_state(G), hp, (unsigned char *)out, (const unsigned char *)in, m, dec);
+    if (r != 0)
+    {
+        for (int j = AES_BLOCK - 1; j >= AES_BLOCK - 4; j--)
+            if (++f[j] != 0) break;
+        memcpy(k, f, AES_BLOCK);
+        AES_ecb_encrypt_blocks(&G->a, k, 1);
+        for (int i = 0, j = n - r; i < r; i++, j++)
+        {
+            unsigned char v = (unsigned char)in[j];
+            out[j] = (char)(v ^ k[i]);
+            d[i] = dec ? v : (unsigned char)out[j];
+        }
+        x = GCM_ghash_clmul(x, hp, d, 1);
+        G->status = GCM_NOT_ACCEPTING_MORE;
+        memset(k, 0, sizeof(k));
+    }
+    GCM_set_state(G, x);
+    G->lenC[1] += (unsign32)n;
+    if (G->lenC[1] < (unsign32)n) G->lenC[0]++;
+    return 1;
+}
+
+CLMUL_TARGET static void GCM_finish_clmul(gcm *G, char *t)
+{
+    __m128i hp[1];
+    unsigned char e[AES_BLOCK];
+
+    /* H alone, which is in row 0 of either table */
+    hp[0] = GCM_row(G->table[0]);
+    GCM_set_state(G, GCM_wrap_clmul(GCM_state(G), hp, G->lenA, G->lenC));
+    if (t != NULL)
+    {
+        memcpy(e, G->Y_0, AES_BLOCK);
+        AES_ecb_encrypt_blocks(&G->a, e, 1);
+        for (int i = 0; i < AES_BLOCK; i++) t[i] = (char)(e[i] ^ G->stateX[i]);
+        memset(e, 0, sizeof(e));
+    }
+    AES_end(&G->a);
+    G->status = GCM_FINISHED;
+}
+
+#endif
+
+int GCM_simd(int max)
+{
+    int k = GCM_SIMD_NONE;
+
+#ifdef GCM_X86
+    __builtin_cpu_init();
+    if (max >= GCM_SIMD_CLMUL && __builtin_cpu_supports("aes") && __builtin_cpu_supports("pclmul") &&
+            __builtin_cpu_supports("sse4.1"))
+        k = GCM_SIMD_CLMUL;
+#else
+    (void)max;
+#endif
+    return DISPATCH_set(&GCM_active, k);
+}
+
+int GCM_simd_active(void)
+{
+    return DISPATCH_get(&GCM_active, GCM_simd, GCM_SIMD_CLMUL);
+}
+
+void GCM_init_bulk(gcm *G, int nk, char *k, int n, char *iv)
+{
+#ifdef GCM_X86
+    if (GCM_simd_active() == GCM_SIMD_CLMUL)
+    {
+        GCM_init_clmul(G, nk, k, n, iv);
+        return;
+    }
+#endif
+    GCM_init(G, nk, k, n, iv);
+}
+
+int GCM_add_header_bulk(gcm *G, char *b, int n)
+{
+#ifdef GCM_X86
+    if (GCM_simd_active() == GCM_SIMD_CLMUL) return GCM_header_clmul(G, b, n);
+#endif
+    return GCM_add_header(G, b, n);
+}
+
+int GCM_add_plain_bulk(gcm *G, char *c, char *p, int n)
+{
+#ifdef GCM_X86
+    if (GCM_simd_active() == GCM_SIMD_CLMUL) return GCM_crypt_bulk(G, c, p, n, 0);
+#endif
+    return GCM_add_plain(G, c, p, n);
+}
+
+int GCM_add_cipher_bulk(gcm *G, char *p, char *c, int n)
+{
+#ifdef GCM_X86
+    if (GCM_simd_active() == GCM_SIMD_CLMUL) return GCM_crypt_bulk(G, p, c, n, 1);
+#endif
+    return GCM_add_cipher(G, p, c, n);
+}
+
+void GCM_finish_bulk(gcm *G, char *t)
+{
+#ifdef GCM_X86
+    if (GCM_simd_active() == GCM_SIMD_CLMUL)
+    {
+        GCM_finish_clmul(G, t);
+        return;
+    }
+#endif
+    GCM_finish(G, t);
+}
+
+void AES_GCM_ENCRYPT_bulk(octet *K, octet *IV, octet *H, octet *P, octet *C, octet *T)
+{
+    gcm g;
+
+    GCM_init_bulk(&g, K->len, K->val, IV->len, IV->val);
+    GCM_add_header_bulk(&g, H->val, H->len);
+    GCM_add_plain_bulk(&g, C->val, P->val, P->len);
+    C->len = P->len;
+    GCM_finish_bulk(&g, T->val);
+    T->len = 16;
+}
+
+void AES_GCM_DECRYPT_bulk(octet *K, octet *IV, octet *H, octet *C, octet *P, octet *T)
+{
+    gcm g;
+
+    GCM_init_bulk(&g, K->len, K->val, IV->len, IV->val);
+    GCM_add_header_bulk(&g, H->val, H->len);
+    GCM_add_cipher_bulk(&g, P->val, C->val, C->len);
+    P->len = C->len;
+    GCM_finish_bulk(&g, T->val);
+    T->len = 16;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file gcm.h
+ * @brief Bulk AES-GCM on MIRACL Core's gcm state, with PCLMULQDQ GHASH
+ *
+ * GCM_add_plain and GCM_add_cipher encrypt a block at a time through the
+ * AES tables, then multiply the GHASH state by H one bit at a time from
+ * the 2 KB table of H.x^i that GCM_init builds for the key. The functions
+ * here continue the same gcm state, but on a CPU with AES-NI and
+ * PCLMULQDQ multiply with carry-less multiplication instead: eight blocks
+ * of ciphertext are multiplied by H^8..H and their products summed before
+ * a single reduction, while the AES rounds of the next eight counter
+ * blocks run in the same loop, so the two units work side by side.
+ *
+ * GCM_init_bulk expands only the encryption key schedule, and with
+ * PCLMULQDQ computes H..H^8 once, into the first eight rows of the table,
+ * big-endian word by word as MIRACL keeps H in the first row; the rest of
+ * the table is left unfilled. A gcm from it must be continued with the
+ * _bulk functions, under the same kernel. A gcm from GCM_init works with
+ * these functions too: its second row is H.x, not H^2, and from that its
+ * powers are recognised as missing and computed on each call instead.
+ *
+ * Output is the same as from the MIRACL functions, whose rules on status
+ * and on calls with partial blocks also apply. The kernel is chosen at
+ * run time; without AES-NI and PCLMULQDQ, or built with -DAES_NOSIMD
+ * (make NOSIMD=1), the _bulk functions call the MIRACL ones.
+ */
+
+#ifndef GCM_H
+#define GCM_H
+
+#include "core.h"
+
+#define GCM_SIMD_NONE 0    /**< MIRACL's table-driven AES and GHASH */
+#define GCM_SIMD_CLMUL 1   /**< AES-NI and PCLMULQDQ, eight blocks at a time */
+
+/**	@brief Selects the fastest GCM kernel the CPU has, up to a limit
+ *
+	The choice is made automatically, and thread-safely, on first use; this
+	overrides it, for comparing the kernels. Not to be changed while a gcm
+	from GCM_init_bulk is in use, since the two fill its table differently.
+	@param max the fastest kernel allowed, GCM_SIMD_NONE or GCM_SIMD_CLMUL
+	@return the kernel now in use
+ */
+extern int GCM_simd(int max);
+/**	@brief Tests which GCM kernel is in use
+ *
+	@return GCM_SIMD_NONE or GCM_SIMD_CLMUL
+ */
+extern int GCM_simd_active(void);
+/**	@brief Initialise an instance of AES-GCM mode
+ *
+	Same state as GCM_init, except that when the kernel is GCM_SIMD_CLMUL
+	the table holds H..H^8 in its first eight rows and nothing after.
+	@param G an instance AES-GCM
+	@param nk is the key length in bytes, 16, 24 or 32
+	@param k the AES key as an array of 16 bytes
+	@param n the number of bytes in the Initialisation Vector (IV)
+	@param iv the IV
+ */
+extern void GCM_init_bulk(gcm *G, int nk, char *k, int n, char *iv);
+/**	@brief Add header (material to be authenticated but not encrypted)
+ *
+	Same as GCM_add_header.
+	@param G an instance AES-GCM
+	@param b is the header material to be added
+	@param n the number of bytes in the header
+	@return 0 if G is not accepting header, else 1
+ */
+extern int GCM_add_header_bulk(gcm *G, char *b, int n);
+/**	@brief Add plaintext and extract ciphertext
+ *
+	Same as GCM_add_plain.
+	@param G an instance AES-GCM
+	@param c is the ciphertext generated, which may be the same as p
+	@param p is the plaintext material to be added
+	@param n the number of bytes in the plaintext
+	@return 0 if G is not accepting plaintext, else 1
+ */
+extern int GCM_add_plain_bulk(gcm *G, char *c, char *p, int n);
+/**	@brief Add ciphertext and extract plaintext
+ *
+	Same as GCM_add_cipher.
+	@param G an instance AES-GCM
+	@param p is the plaintext generated, which may be the same as c
+	@param c is the ciphertext material to be added
+	@param n the number of bytes in the ciphertext
+	@return 0 if G is not accepting ciphertext, else 1
+ */
+extern int GCM_add_cipher_bulk(gcm *G, char *p, char *c, int n);
+/**	@brief Finish off and extract authentication tag (HMAC)
+ *
+	Same as GCM_finish.
+	@param G is an active instance AES-GCM
+	@param t is the output 16 byte authentication tag
+ */
+extern void GCM_finish_bulk(gcm *G, char *t);
+/**	@brief AES-GCM Encryption
+ *
+	Same output as AES_GCM_ENCRYPT.
+	@param K  AES key
+	@param IV Initialization vector
+	@param H Header
+	@param P Plaintext
+	@param C Ciphertext
+	@param T Checksum
+ */
+extern void AES_GCM_ENCRYPT_bulk(octet *K, octet *IV, octet *H, octet *P, octet *C, octet *T);
+/**	@brief AES-GCM Decryption
+ *
+	Same output as AES_GCM_DECRYPT.
+	@param K  AES key
+	@param IV Initialization vector
+	@param H Header
+	@param C Ciphertext
+	@param P Plaintext
+	@param T Checksum
+ */
+extern void AES_GCM_DECRYPT_bulk(octet *K, octet *IV, octet *H, octet *C, octet *P, octet *T);
+
+#endif
@@ -0,0 +1,440 @@
+/**
+ * hash256.c - Bulk SHA-256 on MIRACL Core's hash256 state
+ *
+ * HASH256_process keeps a partial block in H->w[0..15] as big-endian
+ * words, shifting each byte in from the right, and the message length in
+ * bits in H->length[1]:H->length[0]. A block is compressed as soon as it
+ * is full, so between calls the partial block holds 0 to 63 bytes.
+ * hash256c keeps its partial block as bytes instead.
+ *
+ * The SHA-NI kernel follows Intel's reference sequence: SHA256RNDS2 does
+ * two rounds on the state held as ABEF and CDGH, and SHA256MSG1/MSG2 do
+ * the message schedule four words at a time. The AVX2 kernel computes
+ * W[t]+K[t] for two blocks with vector sigma functions, then runs the
+ * rounds on general registers.
+ */
+
+#include <string.h>
+
+#include "hash256.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(HASH256_NOSIMD)
+#define HASH256_X86
+#include <immintrin.h>
+#endif
+
+const unsign32 HASH256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const unsign32 IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+#define ROR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define S0(x) (ROR32(x, 2) ^ ROR32(x, 13) ^ ROR32(x, 22))
+#define S1(x) (ROR32(x, 6) ^ ROR32(x, 11) ^ ROR32(x, 25))
+#define s0(x) (ROR32(x, 7) ^ ROR32(x, 18) ^ ((x) >> 3))
+#define s1(x) (ROR32(x, 17) ^ ROR32(x, 19) ^ ((x) >> 10))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+
+/* The 64 rounds, given W[t]+K[t] */
+static inline void HASH256_rounds(unsign32 *h, const unsign32 *wk)
+{
+    unsign32 a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7], t1, t2;
+
+    for (int t = 0; t < 64; t++)
+    {
+        t1 = k + S1(e) + CH(e, f, g) + wk[t];
+        t2 = S0(a) + MAJ(a, b, c);
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += k;
+}
+
+static void HASH256_blocks_c(unsign32 *h, const unsigned char *b, int n)
+{
+    unsign32 w[64];
+
+    for (; n > 0; n--, b += HASH256_BLOCK)
+    {
+        for (int t = 0; t < 16; t++)
+            w[t] = ((unsign32)b[4 * t] << 24) | ((unsign32)b[4 * t + 1] << 16) | ((unsign32)b[4 * t + 2] << 8) | (unsign32)b[4 * t + 3];
+        for (int t = 16; t < 64; t++)
+            w[t] = s1(w[t - 2]) + w[t - 7] + s0(w[t - 15]) + w[t - 16];
+        for (int t = 0; t < 64; t++) w[t] += HASH256_K[t];
+        HASH256_rounds(h, w);
+    }
+}
+
+#ifdef HASH256_X86
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define SHANI_TARGET __attribute__((target("sha,sse4.1")))
+
+AVX2_TARGET static inline __m256i HASH256_ror_avx2(__m256i x, int n)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+/* W[t+16..t+19] from x0 = W[t..t+3], ..., x3 = W[t+12..t+15], in each 128-bit half */
+AVX2_TARGET static inline __m256i HASH256_schedule_avx2(__m256i x0, __m256i x1, __m256i x2, __m256i x3)
+{
+    __m256i w15, w7, v, y;
+
+    w15 = _mm256_alignr_epi8(x1, x0, 4);
+    w7 = _mm256_alignr_epi8(x3, x2, 4);
+    v = _mm256_xor_si256(_mm256_xor_si256(HASH256_ror_avx2(w15, 7), HASH256_ror_avx2(w15, 18)), _mm256_srli_epi32(w15, 3));
+    y = _mm256_add_epi32(_mm256_add_epi32(x0, w7), v);
+
+    /* s1 of W[t+14], W[t+15] completes W[t+16], W[t+17] */
+    v = _mm256_shuffle_epi32(x3, 0xFE);
+    v = _mm256_xor_si256(_mm256_xor_si256(HASH256_ror_avx2(v, 17), HASH256_ror_avx2(v, 19)), _mm256_srli_epi32(v, 10));
+    y = _mm256_add_epi32(y, _mm256_blend_epi32(_mm256_setzero_si256(), v, 0x33));
+
+    /* and s1 of those completes W[t+18], W[t+19] */
+    v = _mm256_shuffle_epi32(y, 0x40);
+    v = _mm256_xor_si256(_mm256_xor_si256(HASH256_ror_avx2(v, 17), HASH256_ror_avx2(v, 19)), _mm256_srli_epi32(v, 10));
+    return _mm256_add_epi32(y, _mm256_blend_epi32(_mm256_setzero_si256(), v, 0xCC));
+}
+
+AVX2_TARGET static void HASH256_blocks_avx2(unsign32 *h, const unsigned char *b, int n)
+{
+    const __m256i swap = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+                                         12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    unsign32 wk[2][64];
+    __m256i x[4], y;
+
+    while (n > 0)
+    {
+        /* Block b in the low half, the next one (or b again) in the high half */
+        const unsigned char *c = n > 1 ? b + HASH256_BLOCK : b;
+
+        for (int j = 0; j < 4; j++)
+        {
+            y = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(b + 16 * j))),
+                                        _mm_loadu_si128((const __m128i *)(c + 16 * j)), 1);
+            x[j] = _mm256_shuffle_epi8(y, swap);
+        }
+        for (int t = 0; t < 64; t += 4)
+        {
+            y = _mm256_add_epi32(x[(t / 4) & 3], _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&HASH256_K[t])));
+            _mm_storeu_si128((__m128i *)&wk[0][t], _mm256_castsi256_si128(y));
+            _mm_storeu_si128((__m128i *)&wk[1][t], _mm256_extracti128_si256(y, 1));
+            if (t < 48)
+                x[(t / 4) & 3] = HASH256_schedule_avx2(x[(t / 4) & 3], x[(t / 4 + 1) & 3], x[(t / 4 + 2) & 3], x[(t / 4 + 3) & 3]);
+        }
+
+        HASH256_rounds(h, wk[0]);
+        if (n == 1) break;
+        HASH256_rounds(h, wk[1]);
+        b += 2 * HASH256_BLOCK;
+        n -= 2;
+    }
+}
+
+/* Rounds 4g to 4g+3 with cur = W[4g..4g+3]; next and prev are the groups after and before */
+#define HASH256_SHANI_ROUNDS(g, cur, next, prev)                                              \
+    v = _mm_add_epi32(cur, _mm_loadu_si128((const __m128i *)&HASH256_K[4 * (g)]));            \
+    st1 = _mm_sha256rnds2_epu32(st1, st0, v);                                                 \
+    if ((g) >= 3 && (g) <= 14)                                                                \
+        next = _mm_sha256msg2_epu32(_mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4)), cur); \
+    st0 = _mm_sha256rnds2_epu32(st0, st1, _mm_shuffle_epi32(v, 0x0E));                        \
+    if ((g) >= 1 && (g) <= 12) prev = _mm_sha256msg1_epu32(prev, cur)
+
+SHANI_TARGET static void HASH256_blocks_shani(unsign32 *h, const unsigned char *b, int n)
+{
+    const __m128i swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i st0, st1, abef, cdgh, m[4], v, t;
+
+    /* h[0..7] = ABCDEFGH into the ABEF, CDGH order SHA256RNDS2 wants */
+    t = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&h[0]), 0xB1);
+    st1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&h[4]), 0x1B);
+    st0 = _mm_alignr_epi8(t, st1, 8);
+    st1 = _mm_blend_epi16(st1, t, 0xF0);
+
+    for (; n > 0; n--, b += HASH256_BLOCK)
+    {
+        abef = st0;
+        cdgh = st1;
+        for (int j = 0; j < 4; j++) m[j] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(b + 16 * j)), swap);
+        HASH256_SHANI_ROUNDS(0, m[0], m[1], m[3]);
+        HASH256_SHANI_ROUNDS(1, m[1], m[2], m[0]);
+        HASH256_SHANI_ROUNDS(2, m[2], m[3], m[1]);
+        HASH256_SHANI_ROUNDS(3, m[3], m[0], m[2]);
+        HASH256_SHANI_ROUNDS(4, m[0], m[1], m[3]);
+        HASH256_SHANI_ROUNDS(5, m[1], m[2], m[0]);
+        HASH256_SHANI_ROUNDS(6, m[2], m[3], m[1]);
+        HASH256_SHANI_ROUNDS(7, m[3], m[0], m[2]);
+        HASH256_SHANI_ROUNDS(8, m[0], m[1], m[3]);
+        HASH256_SHANI_ROUNDS(9, m[1], m[2], m[0]);
+        HASH256_SHANI_ROUNDS(10, m[2], m[3], m[1]);
+        HASH256_SHANI_ROUNDS(11, m[3], m[0], m[2]);
+        HASH256_SHANI_ROUNDS(12, m[0], m[1], m[3]);
+        HASH256_SHANI_ROUNDS(13, m[1], m[2], m[0]);
+        HASH256_SHANI_ROUNDS(14, m[2], m[3], m[1]);
+        HASH256_SHANI_ROUNDS(15, m[3], m[0], m[2]);
+        st0 = _mm_add_epi32(st0, abef);
+        st1 = _mm_add_epi32(st1, cdgh);
+    }
+
+    t = _mm_shuffle_epi32(st0, 0x1B);
+    st1 = _mm_shuffle_epi32(st1, 0xB1);
+    _mm_storeu_si128((__m128i *)&h[0], _mm_blend_epi16(t, st1, 0xF0));
+    _mm_storeu_si128((__m128i *)&h[4], _mm_alignr_epi8(st1, t, 8));
+}
+
+#endif
+
+typedef void (*HASH256_kernel)(unsign32 *, const unsigned char *, int);
+
+/* The compression function of each level, indexed by HASH256_SIMD_* */
+static const HASH256_kernel HASH256_kernels[] = {
+    HASH256_blocks_c,
+#ifdef HASH256_X86
+    HASH256_blocks_avx2,
+    HASH256_blocks_shani,
+#endif
+};
+
+static int HASH256_active = -1;
+
+int HASH256_simd(int max)
+{
+    int k = HASH256_SIMD_NONE;
+
+#ifdef HASH256_X86
+    __builtin_cpu_init();
+    if (max >= HASH256_SIMD_SHANI && __builtin_cpu_supports("sha") && __builtin_cpu_supports("sse4.1"))
+        k = HASH256_SIMD_SHANI;
+    else if (max >= HASH256_SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+        k = HASH256_SIMD_AVX2;
+#else
+    (void)max;
+#endif
+    return DISPATCH_set(&HASH256_active, k);
+}
+
+int HASH256_simd_active(void)
+{
+    return DISPATCH_get(&HASH256_active, HASH256_simd, HASH256_SIMD_SHANI);
+}
+
+void HASH256_blocks(unsign32 h[8], const char *b, int n)
+{
+    if (n <= 0) return;
+    HASH256_kernels[HASH256_simd_active()](h, (const unsigned char *)b, n);
+}
+
+/* The byte path of HASH256_process, compressing the partial block once full */
+static void HASH256_byte(hash256 *H, int c)
+{
+    unsigned char blk[HASH256_BLOCK];
+    int cnt = (int)((H->length[0] / 32) % 16);
+
+    H->w[cnt] = (H->w[cnt] << 8) | (unsign32)(c & 0xFF);
+    H->length[0] += 8;
+    if (H->length[0] == 0) H->length[1]++;
+    if ((H->length[0] % 512) != 0) return;
+
+    for (int i = 0; i < 16; i++)
+    {
+        blk[4 * i] = (unsigned char)(H->w[i] >> 24);
+        blk[4 * i + 1] = (unsigned char)(H->w[i] >> 16);
+        blk[4 * i + 2] = (unsigned char)(H->w[i] >> 8);
+        blk[4 * i + 3] = (unsigned char)H->w[i];
+    }
+    HASH256_blocks(H->h, (const char *)blk, 1);
+}
+
+void HASH256_update(hash256 *H, const char *b, int len)
+{
+    unsign64 bits;
+    int n;
+
+    while (len > 0 && (H->length[0] % 512) != 0)
+    {
+        HASH256_byte(H, *b++);
+        len--;
+    }
+
+    n = len / HASH256_BLOCK;
+    if (n > 0)
+    {
+        HASH256_blocks(H->h, b, n);
+        bits = (((unsign64)H->length[1] << 32) | H->length[0]) + (unsign64)n * 512;
+        H->length[0] = (unsign32)bits;
+        H->length[1] = (unsign32)(bits >> 32);
+        b += n * HASH256_BLOCK;
+        len -= n * HASH256_BLOCK;
+    }
+
+    while (len-- > 0) HASH256_byte(H, *b++);
+}
+
+void HASH256C_init(hash256c *H)
+{
+    memcpy(H->h, IV, sizeof(H->h));
+    H->length[0] = H->length[1] = 0;
+    H->hlen = SHA256;
+}
+
+void HASH256C_update(hash256c *H, const char *b, int len)
+{
+    int used = (int)((H->length[0] / 8) % HASH256_BLOCK), n;
+    unsign64 bits;
+
+    if (len <= 0) return;
+    bits = (((unsign64)H->length[1] << 32) | H->length[0]) + (unsign64)len * 8;
+    H->length[0] = (unsign32)bits;
+    H->length[1] = (unsign32)(bits >> 32);
+    if (used > 0)
+    {
+        n = HASH256_BLOCK - used;
+        if (len < n)
+        {
+            memcpy(H->b + used, b, (size_t)len);
+            return;
+        }
+        memcpy(H->b + used, b, (size_t)n);
+        HASH256_blocks(H->h, (const char *)H->b, 1);
+        b += n;
+        len -= n;
+    }
+
+    n = len / HASH256_BLOCK;
+    HASH256_blocks(H->h, b, n);
+    b += n * HASH256_BLOCK;
+    len -= n * HASH256_BLOCK;
+    if (len > 0) memcpy(H->b, b, (size_t)len);
+}
+
+void HASH256C_hash(hash256c *H, char *h)
+{
+    int used = (int)((H->length[0] / 8) % HASH256_BLOCK), i;
+
+    H->b[used++] = 0x80;
+    if (used > HASH256_BLOCK - 8)
+    {
+        memset(H->b + used, 0, (size_t)(HASH256_BLOCK - used));
+        HASH256_blocks(H->h, (const char *)H->b, 1);
+        used = 0;
+    }
+    memset(H->b + used, 0, (size_t)(HASH256_BLOCK - 8 - used));
+    for (i = 0; i < 4; i++)
+    {
+        H->b[HASH256_BLOCK - 8 + i] = (unsigned char)(H->length[1] >> (24 - 8 * i));
+        H->b[HASH256_BLOCK - 4 + i] = (unsigned char)(H->length[0] >> (24 - 8 * i));
+    }
+    HASH256_blocks(H->h, (const char *)H->b, 1);
+
+    for (i = 0; i < SHA256; i++) h[i] = (char)(H->h[i / 4] >> (24 - 8 * (i % 4)));
+    HASH256C_init(H);
+}
+
+void HASH256_clone(hash256 *D, const hash256 *S)
+{
+    D->length[0] = S->length[0];
+    D->length[1] = S->length[1];
+    memcpy(D->h, S->h, sizeof(D->h));
+    memcpy(D->w, S->w, 16 * sizeof(D->w[0]));
+    D->hlen = S->hlen;
+}
+
+/* The exported form of chaining value h, length l1:l0 in bits and the partial block p */
+static int HASH256_pack(octet *O, const unsign32 *h, unsign32 l1, unsign32 l0, const unsigned char *p)
+{
+    int i, n = (int)((l0 / 8) % HASH256_BLOCK);
+    unsigned char *b = (unsigned char *)O->val;
+
+    if (O->max < 41 + n) return -1;
+    b[0] = 0x01;
+    for (i = 0; i < 32; i++) b[1 + i] = (unsigned char)(h[i / 4] >> (24 - 8 * (i % 4)));
+    for (i = 0; i < 4; i++)
+    {
+        b[33 + i] = (unsigned char)(l1 >> (24 - 8 * i));
+        b[37 + i] = (unsigned char)(l0 >> (24 - 8 * i));
+    }
+    if (n > 0) memcpy(b + 41, p, (size_t)n);
+    O->len = 41 + n;
+    return 0;
+}
+
+/* Reads an exported state into h, l[2] and p; -1 if it is malformed */
+static int HASH256_unpack(octet *O, unsign32 *h, unsign32 *l, unsigned char *p)
+{
+    const unsigned char *b = (const unsigned char *)O->val;
+    unsign32 l0 = 0, l1 = 0;
+    int i;
+
+    if (O->len < 41 || b[0] != 0x01) return -1;
+    for (i = 0; i < 4; i++)
+    {
+        l1 = (l1 << 8) | b[33 + i];
+        l0 = (l0 << 8) | b[37 + i];
+    }
+    if ((l0 & 7) != 0 || O->len != 41 + (int)((l0 / 8) % HASH256_BLOCK)) return -1;
+
+    for (i = 0; i < 8; i++)
+        h[i] = ((unsign32)b[1 + 4 * i] << 24) | ((unsign32)b[2 + 4 * i] << 16) | ((unsign32)b[3 + 4 * i] << 8) | b[4 + 4 * i];
+    l[0] = l0;
+    l[1] = l1;
+    if (O->len > 41) memcpy(p, b + 41, (size_t)(O->len - 41));
+    return 0;
+}
+
+int HASH256_export(const hash256 *H, octet *O)
+{
+    unsigned char p[HASH256_BLOCK];
+    int i, n = (int)((H->length[0] / 8) % HASH256_BLOCK), r = n % 4;
+
+    /* Whole words of the partial block are big-endian, the last r bytes sit low in w[n/4] */
+    for (i = 0; i < n - r; i++) p[i] = (unsigned char)(H->w[i / 4] >> (24 - 8 * (i % 4)));
+    for (i = 0; i < r; i++) p[n - r + i] = (unsigned char)(H->w[n / 4] >> (8 * (r - 1 - i)));
+    return HASH256_pack(O, H->h, H->length[1], H->length[0], p);
+}
+
+int HASH256_import(hash256 *H, octet *O)
+{
+    unsigned char p[HASH256_BLOCK];
+    int i;
+
+    if (HASH256_unpack(O, H->h, H->length, p) != 0) return -1;
+    for (i = 0; i < 16; i++) H->w[i] = 0;
+    for (i = 0; i < O->len - 41; i++) H->w[i / 4] = (H->w[i / 4] << 8) | p[i];
+    H->hlen = SHA256;
+    return 0;
+}
+
+int HASH256C_export(const hash256c *H, octet *O)
+{
+    return HASH256_pack(O, H->h, H->length[1], H->length[0], H->b);
+}
+
+int HASH256C_import(hash256c *H, octet *O)
+{
+    if (HASH256_unpack(O, H->h, H->length, H->b) != 0) return -1;
+    H->hlen = SHA256;
+    return 0;
+}
@@ -0,0 +1,145 @@
+/**
+ * @file hash256.h
+ * @brief Bulk SHA-256 on MIRACL Core's hash256 state
+ *
+ * HASH256_process takes one byte per call, shifting it into the message
+ * word and checking for a full block every time, so hashing a 4 KB JWS
+ * payload is 4096 calls before any compression. HASH256_update takes a
+ * whole buffer and compresses every complete 64-byte block straight from
+ * it, with only a partial block at either end going through the byte path.
+ *
+ * The compression function is chosen at run time: the SHA-NI instructions
+ * when the CPU has them, else AVX2, which computes the message schedules
+ * of two blocks at once in the two 128-bit halves, else portable C. Built
+ * with -DHASH256_NOSIMD (make NOSIMD=1), only portable C is compiled.
+ *
+ * Both functions work on the same hash256 state as HASH256_process, and
+ * can be mixed freely with it, HASH256_hash and HASH256_continuing_hash.
+ *
+ * hash256c is a compact SHA-256 state, as hash512c is for SHA-384/512:
+ * the chaining value, the length and the partial block as bytes, without
+ * the 64-word message schedule, so it is cheap to copy and its padding
+ * does not go through the byte path.
+ *
+ * A state part way through a message can be cloned, to hash a common
+ * prefix once and finish it for many messages, or exported as a short
+ * octet and imported again later or elsewhere. The exported form is the
+ * same for hash256 and hash256c: a 0x01 tag, the eight chaining words
+ * and the 64-bit length in bits, both big-endian, then the bytes of the
+ * partial block, 41 to 104 bytes in all.
+ */
+
+#ifndef HASH256_H
+#define HASH256_H
+
+#include "core.h"
+
+#define HASH256_BLOCK 64      /**< SHA-256 block size in bytes */
+
+#define HASH256_STATE_MAX 104  /**< Longest exported SHA-256 state */
+
+#define HASH256_SIMD_NONE 0   /**< Portable C compression */
+#define HASH256_SIMD_AVX2 1   /**< AVX2 message schedule, two blocks at a time */
+#define HASH256_SIMD_SHANI 2  /**< SHA-NI instructions */
+
+/**
+ * @brief Compact SHA-256 instance, without the message schedule */
+typedef struct
+{
+    unsign32 length[2];                 /**< 64-bit input length in bits */
+    unsign32 h[8];                      /**< Chaining value */
+    unsigned char b[HASH256_BLOCK];     /**< Partial block, length[0]/8 mod 64 bytes */
+    int hlen;                           /**< Hash length in bytes */
+} hash256c;
+
+/** SHA-256 round constants */
+extern const unsign32 HASH256_K[64];
+
+/**	@brief Selects the fastest compression function the CPU has, up to a limit
+ *
+	The choice is made automatically, and thread-safely, on first use; this
+	overrides it, for comparing the kernels. All give the same digests, so
+	hashing in other threads stays correct across the switch.
+	@param max the fastest kernel allowed, HASH256_SIMD_NONE, _AVX2 or _SHANI
+	@return the kernel now in use
+ */
+extern int HASH256_simd(int max);
+/**	@brief Tests which compression function is in use
+ *
+	@return HASH256_SIMD_NONE, HASH256_SIMD_AVX2 or HASH256_SIMD_SHANI
+ */
+extern int HASH256_simd_active(void);
+/**	@brief Compresses whole blocks into a SHA-256 chaining value
+ *
+	No padding and no length: the raw compression function, applied n times.
+	@param h the eight state words, updated in place
+	@param b n*HASH256_BLOCK bytes of message
+	@param n the number of blocks
+ */
+extern void HASH256_blocks(unsign32 h[8], const char *b, int n);
+/**	@brief Process an array of bytes
+ *
+	Same state as calling HASH256_process(H, b[i]) for each byte in turn.
+	@param H an instance SHA256
+	@param b the bytes to be included in hash
+	@param len the number of bytes
+ */
+extern void HASH256_update(hash256 *H, const char *b, int len);
+
+/**	@brief Initialise a compact instance of SHA256
+ *
+	@param H a compact instance
+ */
+extern void HASH256C_init(hash256c *H);
+/**	@brief Process an array of bytes
+ *
+	@param H a compact instance of SHA256
+	@param b the bytes to be included in hash
+	@param len the number of bytes
+ */
+extern void HASH256C_update(hash256c *H, const char *b, int len);
+/**	@brief Generate the 32-byte hash, and re-initialise
+ *
+	Same digest as HASH256_hash over the same bytes.
+	@param H a compact instance of SHA256
+	@param h is the output hash
+ */
+extern void HASH256C_hash(hash256c *H, char *h);
+
+/**	@brief Copies a SHA256 instance part way through a message
+ *
+	Copies only the live part of the state, not the message schedule.
+	@param D the copy
+	@param S the instance to copy
+ */
+extern void HASH256_clone(hash256 *D, const hash256 *S);
+/**	@brief Exports a SHA256 instance
+ *
+	@param H an instance SHA256
+	@param O the exported state, with room for HASH256_STATE_MAX bytes
+	@return 0 if OK, or -1 if O is too short
+ */
+extern int HASH256_export(const hash256 *H, octet *O);
+/**	@brief Imports a SHA256 instance
+ *
+	@param H the instance to set
+	@param O a state from HASH256_export or HASH256C_export
+	@return 0 if OK, or -1 if O is not an exported SHA-256 state
+ */
+extern int HASH256_import(hash256 *H, octet *O);
+/**	@brief Exports a compact SHA256 instance
+ *
+	@param H a compact instance
+	@param O the exported state, with room for HASH256_STATE_MAX bytes
+	@return 0 if OK, or -1 if O is too short
+ */
+extern int HASH256C_export(const hash256c *H, octet *O);
+/**	@brief Imports a compact SHA256 instance
+ *
+	@param H the compact instance to set
+	@param O a state from HASH256_export or HASH256C_export
+	@return 0 if OK, or -1 if O is not an exported SHA-256 state
+ */
+extern int HASH256C_import(hash256c *H, octet *O);
+
+#endif
@@ -0,0 +1,453 @@
+/**
+ * hash512.c - Bulk SHA-384/512, and a compact SHA-384/512 state
+ *
+ * HASH512_process keeps a partial block in H->w[0..15] as big-endian
+ * words, shifting each byte in from the right, and the message length in
+ * bits in H->length[1]:H->length[0]. SHA-384 is the same code from a
+ * different IV. hash512c keeps its partial block as bytes instead.
+ *
+ * The vector kernels compute W[t+16..t+19] from the previous sixteen
+ * words held in four registers while the rounds, on general registers,
+ * consume W[t..t+3]+K[t..t+3], so the schedule runs in the slack of the
+ * round dependency chain rather than ahead of it.
+ */
+
+#include <string.h>
+
+#include "hash512.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(HASH256_NOSIMD)
+#define HASH512_X86
+#include <immintrin.h>
+#endif
+
+static const unsign64 K[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static const unsign64 IV384[8] = {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+
+static const unsign64 IV512[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+#define ROR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#define S0(x) (ROR64(x, 28) ^ ROR64(x, 34) ^ ROR64(x, 39))
+#define S1(x) (ROR64(x, 14) ^ ROR64(x, 18) ^ ROR64(x, 41))
+#define s0(x) (ROR64(x, 1) ^ ROR64(x, 8) ^ ((x) >> 7))
+#define s1(x) (ROR64(x, 19) ^ ROR64(x, 61) ^ ((x) >> 6))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+
+/* Rounds t to t+3 on state v[0..7] = a..h, given W[t]+K[t] in wk[0..3] */
+static inline void HASH512_rounds4(unsign64 *v, const unsign64 *wk)
+{
+    unsign64 a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], k = v[7], t1, t2;
+
+    for (int t = 0; t < 4; t++)
+    {
+        t1 = k + S1(e) + CH(e, f, g) + wk[t];
+        t2 = S0(a) + MAJ(a, b, c);
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    v[0] = a;
+    v[1] = b;
+    v[2] = c;
+    v[3] = d;
+    v[4] = e;
+    v[5] = f;
+    v[6] = g;
+    v[7] = k;
+}
+
+/* The 80 rounds, given W[t]+K[t] */
+static inline void HASH512_rounds(unsign64 *h, const unsign64 *wk)
+{
+    unsign64 v[8];
+
+    for (int j = 0; j < 8; j++) v[j] = h[j];
+    for (int t = 0; t < 80; t += 4) HASH512_rounds4(v, wk + t);
+    for (int j = 0; j < 8; j++) h[j] += v[j];
+}
+
+static inline unsign64 HASH512_load(const unsigned char *b)
+{
+    unsign64 x = 0;
+
+    for (int i = 0; i < 8; i++) x = (x << 8) | b[i];
+    return x;
+}
+
+static void HASH512_blocks_c(unsign64 *h, const unsigned char *b, int n)
+{
+    unsign64 w[80];
+
+    for (; n > 0; n--, b += HASH512_BLOCK)
+    {
+        for (int t = 0; t < 16; t++) w[t] = HASH512_load(b + 8 * t);
+        for (int t = 16; t < 80; t++)
+            w[t] = s1(w[t - 2]) + w[t - 7] + s0(w[t - 15]) + w[t - 16];
+        for (int t = 0; t < 80; t++) w[t] += K[t];
+        HASH512_rounds(h, w);
+    }
+}
+
+#ifdef HASH512_X86
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx2,avx512f,avx512vl")))
+
+/*
+ * W[t+16..t+19] from x0 = W[t..t+3], ..., x3 = W[t+12..t+15]: s0 of
+ * W[t+1..t+4] and W[t+9..t+12] four at a time, then s1 of W[t+14..t+15]
+ * completes the first two words and s1 of those the last two. SIGMA0 and
+ * SIGMA1 are the vector s0 and s1 of each kernel.
+ */
+#define HASH512_SCHEDULE(x0, x1, x2, x3, SIGMA0, SIGMA1)                                  \
+    do                                                                                    \
+    {                                                                                     \
+        __m256i w15, w7, y, v;                                                            \
+        w15 = _mm256_alignr_epi8(_mm256_permute2x128_si256(x0, x1, 0x21), x0, 8);         \
+        w7 = _mm256_alignr_epi8(_mm256_permute2x128_si256(x2, x3, 0x21), x2, 8);          \
+        y = _mm256_add_epi64(_mm256_add_epi64(x0, w7), SIGMA0(w15));                      \
+        v = SIGMA1(_mm256_permute4x64_epi64(x3, 0xEE));                                   \
+        y = _mm256_add_epi64(y, _mm256_blend_epi32(_mm256_setzero_si256(), v, 0x0F));     \
+        v = SIGMA1(_mm256_permute4x64_epi64(y, 0x44));                                    \
+        x0 = _mm256_add_epi64(y, _mm256_blend_epi32(_mm256_setzero_si256(), v, 0xF0));    \
+    } while (0)
+
+/* Loads the 16 message words of b, schedules the rest and runs the rounds */
+#define HASH512_VECTOR_BLOCKS(SIGMA0, SIGMA1)                                                         \
+    const __m256i swap = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7,        \
+                                         8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7);       \
+    unsign64 wk[4], v[8];                                                                             \
+    __m256i x[4];                                                                                     \
+                                                                                                      \
+    for (; n > 0; n--, b += HASH512_BLOCK)                                                            \
+    {                                                                                                 \
+        for (int j = 0; j < 4; j++)                                                                   \
+            x[j] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(b + 32 * j)), swap);      \
+        for (int j = 0; j < 8; j++) v[j] = h[j];                                                      \
+        for (int t = 0; t < 80; t += 4)                                                               \
+        {                                                                                             \
+            _mm256_storeu_si256((__m256i *)wk,                                                        \
+                                _mm256_add_epi64(x[(t / 4) & 3], _mm256_loadu_si256((const __m256i *)&K[t]))); \
+            if (t < 64)                                                                               \
+                HASH512_SCHEDULE(x[(t / 4) & 3], x[(t / 4 + 1) & 3], x[(t / 4 + 2) & 3], x[(t / 4 + 3) & 3], \
+                                 SIGMA0, SIGMA1);                                                     \
+            HASH512_rounds4(v, wk);                                                                   \
+        }                                                                                             \
+        for (int j = 0; j < 8; j++) h[j] += v[j];                                                     \
+    }
+
+AVX2_TARGET static inline __m256i HASH512_ror_avx2(__m256i x, int n)
+{
+    return _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - n));
+}
+
+AVX2_TARGET static inline __m256i HASH512_s0_avx2(__m256i x)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(HASH512_ror_avx2(x, 1), HASH512_ror_avx2(x, 8)), _mm256_srli_epi64(x, 7));
+}
+
+AVX2_TARGET static inline __m256i HASH512_s1_avx2(__m256i x)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(HASH512_ror_avx2(x, 19), HASH512_ror_avx2(x, 61)), _mm256_srli_epi64(x, 6));
+}
+
+AVX2_TARGET static void HASH512_blocks_avx2(unsign64 *h, const unsigned char *b, int n)
+{
+    HASH512_VECTOR_BLOCKS(HASH512_s0_avx2, HASH512_s1_avx2)
+}
+
+AVX512_TARGET static inline __m256i HASH512_s0_avx512(__m256i x)
+{
+    return _mm256_ternarylogic_epi64(_mm256_ror_epi64(x, 1), _mm256_ror_epi64(x, 8), _mm256_srli_epi64(x, 7), 0x96);
+}
+
+AVX512_TARGET static inline __m256i HASH512_s1_avx512(__m256i x)
+{
+    return _mm256_ternarylogic_epi64(_mm256_ror_epi64(x, 19), _mm256_ror_epi64(x, 61), _mm256_srli_epi64(x, 6), 0x96);
+}
+
+AVX512_TARGET static void HASH512_blocks_avx512(unsign64 *h, const unsigned char *b, int n)
+{
+    HASH512_VECTOR_BLOCKS(HASH512_s0_avx512, HASH512_s1_avx512)
+}
+
+#endif
+
+typedef void (*HASH512_kernel)(unsign64 *, const unsigned char *, int);
+
+/* The compression function of each level, indexed by HASH512_SIMD_* */
+static const HASH512_kernel HASH512_kernels[] = {
+    HASH512_blocks_c,
+#ifdef HASH512_X86
+    HASH512_blocks_avx2,
+    HASH512_blocks_avx512,
+#endif
+};
+
+static int HASH512_active = -1;
+
+int HASH512_simd(int max)
+{
+    int k = HASH512_SIMD_NONE;
+
+#ifdef HASH512_X86
+    __builtin_cpu_init();
+    if (max >= HASH512_SIMD_AVX512 && __builtin_cpu_supports("avx512vl"))
+        k = HASH512_SIMD_AVX512;
+    else if (max >= HASH512_SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+        k = HASH512_SIMD_AVX2;
+#else
+    (void)max;
+#endif
+    return DISPATCH_set(&HASH512_active, k);
+}
+
+int HASH512_simd_active(void)
+{
+    return DISPATCH_get(&HASH512_active, HASH512_simd, HASH512_SIMD_AVX512);
+}
+
+void HASH512_blocks(unsign64 h[8], const char *b, int n)
+{
+    if (n <= 0) return;
+    HASH512_kernels[HASH512_simd_active()](h, (const unsigned char *)b, n);
+}
+
+/* Adds n bits to a 128-bit length */
+static void HASH512_count(unsign64 length[2], unsign64 n)
+{
+    length[0] += n;
+    if (length[0] < n) length[1]++;
+}
+
+/* The byte path of HASH512_process, compressing the partial block once full */
+static void HASH512_byte(hash512 *H, int c)
+{
+    unsigned char blk[HASH512_BLOCK];
+    int cnt = (int)((H->length[0] / 64) % 16);
+
+    H->w[cnt] = (H->w[cnt] << 8) | (unsign64)(c & 0xFF);
+    HASH512_count(H->length, 8);
+    if ((H->length[0] % 1024) != 0) return;
+
+    for (int i = 0; i < 16; i++)
+        for (int j = 0; j < 8; j++) blk[8 * i + j] = (unsigned char)(H->w[i] >> (56 - 8 * j));
+    HASH512_blocks(H->h, (const char *)blk, 1);
+}
+
+void HASH512_update(hash512 *H, const char *b, int len)
+{
+    int n;
+
+    while (len > 0 && (H->length[0] % 1024) != 0)
+    {
+        HASH512_byte(H, *b++);
+        len--;
+    }
+
+    n = len / HASH512_BLOCK;
+    if (n > 0)
+    {
+        HASH512_blocks(H->h, b, n);
+        HASH512_count(H->length, (unsign64)n * 1024);
+        b += n * HASH512_BLOCK;
+        len -= n * HASH512_BLOCK;
+    }
+
+    while (len-- > 0) HASH512_byte(H, *b++);
+}
+
+void HASH384_update(hash384 *H, const char *b, int len)
+{
+    HASH512_update(H, b, len);
+}
+
+static void HASH512C_start(hash512c *H, const unsign64 *iv, int hlen)
+{
+    memcpy(H->h, iv, sizeof(H->h));
+    H->length[0] = H->length[1] = 0;
+    H->hlen = hlen;
+}
+
+void HASH384C_init(hash512c *H)
+{
+    HASH512C_start(H, IV384, SHA384);
+}
+
+void HASH512C_init(hash512c *H)
+{
+    HASH512C_start(H, IV512, SHA512);
+}
+
+void HASH512C_update(hash512c *H, const char *b, int len)
+{
+    int used = (int)((H->length[0] / 8) % HASH512_BLOCK), n;
+
+    if (len <= 0) return;
+    HASH512_count(H->length, (unsign64)len * 8);
+    if (used > 0)
+    {
+        n = HASH512_BLOCK - used;
+        if (len < n)
+        {
+            memcpy(H->b + used, b, (size_t)len);
+            return;
+        }
+        memcpy(H->b + used, b, (size_t)n);
+        HASH512_blocks(H->h, (const char *)H->b, 1);
+        b += n;
+        len -= n;
+    }
+
+    n = len / HASH512_BLOCK;
+    HASH512_blocks(H->h, b, n);
+    b += n * HASH512_BLOCK;
+    len -= n * HASH512_BLOCK;
+    if (len > 0) memcpy(H->b, b, (size_t)len);
+}
+
+void HASH512C_hash(hash512c *H, char *h)
+{
+    int used = (int)((H->length[0] / 8) % HASH512_BLOCK), i;
+
+    H->b[used++] = 0x80;
+    if (used > HASH512_BLOCK - 16)
+    {
+        memset(H->b + used, 0, (size_t)(HASH512_BLOCK - used));
+        HASH512_blocks(H->h, (const char *)H->b, 1);
+        used = 0;
+    }
+    memset(H->b + used, 0, (size_t)(HASH512_BLOCK - 16 - used));
+    for (i = 0; i < 8; i++)
+    {
+        H->b[HASH512_BLOCK - 16 + i] = (unsigned char)(H->length[1] >> (56 - 8 * i));
+        H->b[HASH512_BLOCK - 8 + i] = (unsigned char)(H->length[0] >> (56 - 8 * i));
+    }
+    HASH512_blocks(H->h, (const char *)H->b, 1);
+
+    for (i = 0; i < H->hlen; i++) h[i] = (char)(H->h[i / 8] >> (56 - 8 * (i % 8)));
+    if (H->hlen == SHA384) HASH384C_init(H);
+    else HASH512C_init(H);
+}
+
+void HASH512_clone(hash512 *D, const hash512 *S)
+{
+    D->length[0] = S->length[0];
+    D->length[1] = S->length[1];
+    memcpy(D->h, S->h, sizeof(D->h));
+    memcpy(D->w, S->w, 16 * sizeof(D->w[0]));
+    D->hlen = S->hlen;
+}
+
+/* The exported form of chaining value h, length l[1]:l[0] in bits and the partial block p */
+static int HASH512_pack(octet *O, int hlen, const unsign64 *h, const unsign64 *l, const unsigned char *p)
+{
+    int i, n = (int)((l[0] / 8) % HASH512_BLOCK);
+    unsigned char *b = (unsigned char *)O->val;
+
+    if (O->max < 81 + n) return -1;
+    b[0] = hlen == SHA384 ? 0x02 : 0x03;
+    for (i = 0; i < 64; i++) b[1 + i] = (unsigned char)(h[i / 8] >> (56 - 8 * (i % 8)));
+    for (i = 0; i < 8; i++)
+    {
+        b[65 + i] = (unsigned char)(l[1] >> (56 - 8 * i));
+        b[73 + i] = (unsigned char)(l[0] >> (56 - 8 * i));
+    }
+    if (n > 0) memcpy(b + 81, p, (size_t)n);
+    O->len = 81 + n;
+    return 0;
+}
+
+/* Reads an exported state into h, l[2] and p, returning the hash length, or -1 if it is malformed */
+static int HASH512_unpack(octet *O, unsign64 *h, unsign64 *l, unsigned char *p)
+{
+    const unsigned char *b = (const unsigned char *)O->val;
+    unsign64 l0 = 0, l1 = 0;
+    int i;
+
+    if (O->len < 81 || (b[0] != 0x02 && b[0] != 0x03)) return -1;
+    for (i = 0; i < 8; i++)
+    {
+        l1 = (l1 << 8) | b[65 + i];
+        l0 = (l0 << 8) | b[73 + i];
+    }
+    if ((l0 & 7) != 0 || O->len != 81 + (int)((l0 / 8) % HASH512_BLOCK)) return -1;
+
+    for (i = 0; i < 8; i++) h[i] = HASH512_load(b + 1 + 8 * i);
+    l[0] = l0;
+    l[1] = l1;
+    if (O->len > 81) memcpy(p, b + 81, (size_t)(O->len - 81));
+    return b[0] == 0x02 ? SHA384 : SHA512;
+}
+
+int HASH512_export(const hash512 *H, octet *O)
+{
+    unsigned char p[HASH512_BLOCK];
+    int i, n = (int)((H->length[0] / 8) % HASH512_BLOCK), r = n % 8;
+
+    /* Whole words of the partial block are big-endian, the last r bytes sit low in w[n/8] */
+    for (i = 0; i < n - r; i++) p[i] = (unsigned char)(H->w[i / 8] >> (56 - 8 * (i % 8)));
+    for (i = 0; i < r; i++) p[n - r + i] = (unsigned char)(H->w[n / 8] >> (8 * (r - 1 - i)));
+    return HASH512_pack(O, H->hlen, H->h, H->length, p);
+}
+
+int HASH512_import(hash512 *H, octet *O)
+{
+    unsigned char p[HASH512_BLOCK];
+    int i, hlen = HASH512_unpack(O, H->h, H->length, p);
+
+    if (hlen < 0) return -1;
+    for (i = 0; i < 16; i++) H->w[i] = 0;
+    for (i = 0; i < O->len - 81; i++) H->w[i / 8] = (H->w[i / 8] << 8) | p[i];
+    H->hlen = hlen;
+    return 0;
+}
+
+int HASH512C_export(const hash512c *H, octet *O)
+{
+    return HASH512_pack(O, H->hlen, H->h, H->length, H->b);
+}
+
+int HASH512C_import(hash512c *H, octet *O)
+{
+    int hlen = HASH512_unpack(O, H->h, H->length, H->b);
+
+    if (hlen < 0) return -1;
+    H->hlen = hlen;
+    return 0;
+}
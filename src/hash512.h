@@ -0,0 +1,151 @@
+/**
+ * @file hash512.h
+ * @brief Bulk SHA-384/512, and a compact SHA-384/512 state
+ *
+ * HASH384_process and HASH512_process take one byte per call, like
+ * HASH256_process. HASH384_update and HASH512_update take a whole buffer
+ * on the same hash512 state and compress every complete 128-byte block
+ * straight from it.
+ *
+ * The hash512 struct also carries the 80-word message schedule, 640 of
+ * its 728 bytes, though the schedule is scratch and dead between calls.
+ * hash512c holds only what survives a call: the chaining value, the
+ * length and the partial block, 216 bytes, so it is cheap to copy, for
+ * instance to hash many messages after one shared prefix.
+ *
+ * Either state can be cloned part way through a message, or exported as
+ * an octet and imported again: a tag, 0x02 for SHA-384 or 0x03 for
+ * SHA-512, the eight chaining words and the 128-bit length in bits, both
+ * big-endian, then the bytes of the partial block, 81 to 208 bytes.
+ *
+ * The compression function is chosen at run time: the message schedule
+ * is computed four words at a time with AVX2, or with the AVX-512
+ * rotate and three-input logic instructions when the CPU has AVX-512VL,
+ * else in portable C. Built with -DHASH256_NOSIMD (make NOSIMD=1), only
+ * portable C is compiled.
+ */
+
+#ifndef HASH512_H
+#define HASH512_H
+
+#include "core.h"
+
+#define HASH512_BLOCK 128      /**< SHA-384/512 block size in bytes */
+
+#define HASH512_STATE_MAX 208  /**< Longest exported SHA-384/512 state */
+
+#define HASH512_SIMD_NONE 0    /**< Portable C compression */
+#define HASH512_SIMD_AVX2 1    /**< AVX2 message schedule */
+#define HASH512_SIMD_AVX512 2  /**< AVX-512VL message schedule */
+
+/**
+ * @brief Compact SHA-384/512 instance, without the message schedule */
+typedef struct
+{
+    unsign64 length[2];                 /**< 128-bit input length in bits */
+    unsign64 h[8];                      /**< Chaining value */
+    unsigned char b[HASH512_BLOCK];     /**< Partial block, length[0]/8 mod 128 bytes */
+    int hlen;                           /**< Hash length in bytes */
+} hash512c;
+
+/**	@brief Selects the fastest compression function the CPU has, up to a limit
+ *
+	The choice is made automatically, and thread-safely, on first use; this
+	overrides it, for comparing the kernels. All give the same digests, so
+	hashing in other threads stays correct across the switch.
+	@param max the fastest kernel allowed, HASH512_SIMD_NONE, _AVX2 or _AVX512
+	@return the kernel now in use
+ */
+extern int HASH512_simd(int max);
+/**	@brief Tests which compression function is in use
+ *
+	@return HASH512_SIMD_NONE, HASH512_SIMD_AVX2 or HASH512_SIMD_AVX512
+ */
+extern int HASH512_simd_active(void);
+/**	@brief Compresses whole blocks into a SHA-384/512 chaining value
+ *
+	No padding and no length: the raw compression function, applied n times.
+	@param h the eight state words, updated in place
+	@param b n*HASH512_BLOCK bytes of message
+	@param n the number of blocks
+ */
+extern void HASH512_blocks(unsign64 h[8], const char *b, int n);
+/**	@brief Process an array of bytes
+ *
+	Same state as calling HASH384_process(H, b[i]) for each byte in turn.
+	@param H an instance SHA384
+	@param b the bytes to be included in hash
+	@param len the number of bytes
+ */
+extern void HASH384_update(hash384 *H, const char *b, int len);
+/**	@brief Process an array of bytes
+ *
+	Same state as calling HASH512_process(H, b[i]) for each byte in turn.
+	@param H an instance SHA512
+	@param b the bytes to be included in hash
+	@param len the number of bytes
+ */
+extern void HASH512_update(hash512 *H, const char *b, int len);
+
+/**	@brief Initialise a compact instance of SHA384
+ *
+	@param H a compact instance
+ */
+extern void HASH384C_init(hash512c *H);
+/**	@brief Initialise a compact instance of SHA512
+ *
+	@param H a compact instance
+ */
+extern void HASH512C_init(hash512c *H);
+/**	@brief Process an array of bytes
+ *
+	@param H a compact instance of SHA384 or SHA512
+	@param b the bytes to be included in hash
+	@param len the number of bytes
+ */
+extern void HASH512C_update(hash512c *H, const char *b, int len);
+/**	@brief Generate the hash, and re-initialise
+ *
+	Same digest as HASH384_hash or HASH512_hash over the same bytes.
+	@param H a compact instance of SHA384 or SHA512
+	@param h is the output hash, H->hlen bytes
+ */
+extern void HASH512C_hash(hash512c *H, char *h);
+
+/**	@brief Copies a SHA384 or SHA512 instance part way through a message
+ *
+	Copies only the live part of the state, not the message schedule.
+	@param D the copy
+	@param S the instance to copy
+ */
+extern void HASH512_clone(hash512 *D, const hash512 *S);
+/**	@brief Exports a SHA384 or SHA512 instance
+ *
+	@param H an instance SHA384 or SHA512
+	@param O the exported state, with room for HASH512_STATE_MAX bytes
+	@return 0 if OK, or -1 if O is too short
+ */
+extern int HASH512_export(const hash512 *H, octet *O);
+/**	@brief Imports a SHA384 or SHA512 instance
+ *
+	@param H the instance to set
+	@param O a state from HASH512_export or HASH512C_export
+	@return 0 if OK, or -1 if O is not an exported SHA-384/512 state
+ */
+extern int HASH512_import(hash512 *H, octet *O);
+/**	@brief Exports a compact SHA384 or SHA512 instance
+ *
+	@param H a compact instance
+	@param O the exported state, with room for HASH512_STATE_MAX bytes
+	@return 0 if OK, or -1 if O is too short
+ */
+extern int HASH512C_export(const hash512c *H, octet *O);
+/**	@brief Imports a compact SHA384 or SHA512 instance
+ *
+	@param H the compact instance to set
+	@param O a state from HASH512_export or HASH512C_export
+	@return 0 if OK, or -1 if O is not an exported SHA-384/512 state
+ */
+extern int HASH512C_import(hash512c *H, octet *O);
+
+#endif
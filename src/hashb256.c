@@ -0,0 +1,423 @@
+/**
+ * hashb256.c - Multi-buffer SHA-256 over many independent messages
+ *
+ * The lane states are kept word-major, s[j][l] being word j of lane l,
+ * and before each step the next block of every lane is transposed into
+ * w[t][l], so that word t of all lanes loads as one vector. A lane's
+ * message is consumed as two runs of blocks: the complete blocks, read
+ * in place, then one or two blocks holding the last partial block, the
+ * padding and the length. Each round of scheduling runs the kernel for
+ * as many steps as the shortest run left among the busy lanes.
+ */
+
+#include <string.h>
+
+#include "hashb256.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(HASH256_NOSIMD)
+#define HASHB256_X86
+#include <immintrin.h>
+#endif
+
+static const unsign32 IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+typedef struct
+{
+    int job;                               /* Index of the job, or -1 if the lane is idle */
+    const unsigned char *p;                /* The next block */
+    int left;                              /* Blocks left at p */
+    int tail;                              /* 1 once p points into pad */
+    int npad;                              /* Blocks in pad */
+    unsigned char pad[2 * HASH256_BLOCK];  /* The last partial block, padding and length */
+} HASHB256_LANE;
+
+/* One step: compress block w[.][l] into state s[.][l] for every lane */
+typedef void (*HASHB256_kernel)(unsign32 s[8][HASHB256_LANES], unsign32 w[16][HASHB256_LANES]);
+
+/* rep times u = HMAC(u), f ^= u, in each lane from l0 on, the key given by its ipad and opad chaining values */
+typedef void (*HASHB256_chain)(const unsign32 *ipad, const unsign32 *opad, unsign32 u[8][HASHB256_LANES], unsign32 f[8][HASHB256_LANES], int l0, int rep);
+
+#ifdef HASHB256_X86
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+AVX2_TARGET static inline __m256i HASHB256_ror8(__m256i x, int n)
+{
+    return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+/* h += the compression of block W into h, in each of the 8 lanes; W is overwritten */
+AVX2_TARGET static inline void HASHB256_compress8(__m256i h[8], __m256i W[16])
+{
+    __m256i v[8], t1, t2, x;
+
+    for (int j = 0; j < 8; j++) v[j] = h[j];
+    for (int t = 0; t < 64; t++)
+    {
+        if (t >= 16)
+        {
+            x = W[(t - 15) & 15];
+            t1 = _mm256_xor_si256(_mm256_xor_si256(HASHB256_ror8(x, 7), HASHB256_ror8(x, 18)), _mm256_srli_epi32(x, 3));
+            x = W[(t - 2) & 15];
+            t2 = _mm256_xor_si256(_mm256_xor_si256(HASHB256_ror8(x, 17), HASHB256_ror8(x, 19)), _mm256_srli_epi32(x, 10));
+            W[t & 15] = _mm256_add_epi32(_mm256_add_epi32(W[t & 15], W[(t - 7) & 15]), _mm256_add_epi32(t1, t2));
+        }
+        x = v[4];
+        t1 = _mm256_xor_si256(_mm256_xor_si256(HASHB256_ror8(x, 6), HASHB256_ror8(x, 11)), HASHB256_ror8(x, 25));
+        t1 = _mm256_add_epi32(_mm256_add_epi32(v[7], t1), _mm256_xor_si256(_mm256_and_si256(x, v[5]), _mm256_andnot_si256(x, v[6])));
+        t1 = _mm256_add_epi32(_mm256_add_epi32(t1, _mm256_set1_epi32((int)HASH256_K[t])), W[t & 15]);
+        x = v[0];
+        t2 = _mm256_xor_si256(_mm256_xor_si256(HASHB256_ror8(x, 2), HASHB256_ror8(x, 13)), HASHB256_ror8(x, 22));
+        t2 = _mm256_add_epi32(t2, _mm256_or_si256(_mm256_and_si256(x, v[1]), _mm256_and_si256(v[2], _mm256_or_si256(x, v[1]))));
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = v[4];
+        v[4] = _mm256_add_epi32(v[3], t1);
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = v[0];
+        v[0] = _mm256_add_epi32(t1, t2);
+    }
+    for (int j = 0; j < 8; j++) h[j] = _mm256_add_epi32(h[j], v[j]);
+}
+
+AVX2_TARGET static void HASHB256_x8_avx2(unsign32 s[8][HASHB256_LANES], unsign32 w[16][HASHB256_LANES])
+{
+    __m256i h[8], W[16];
+
+    for (int j = 0; j < 8; j++) h[j] = _mm256_loadu_si256((const __m256i *)s[j]);
+    for (int t = 0; t < 16; t++) W[t] = _mm256_loadu_si256((const __m256i *)w[t]);
+    HASHB256_compress8(h, W);
+    for (int j = 0; j < 8; j++) _mm256_storeu_si256((__m256i *)s[j], h[j]);
+}
+
+/* One hash of a 32-byte message m after the key block that left chaining value iv, into m */
+AVX2_TARGET static inline void HASHB256_hmac8_half(__m256i m[8], const unsign32 *iv)
+{
+    __m256i W[16];
+
+    for (int j = 0; j < 8; j++)
+    {
+        W[j] = m[j];
+        m[j] = _mm256_set1_epi32((int)iv[j]);
+    }
+    W[8] = _mm256_set1_epi32((int)0x80000000);
+    for (int t = 9; t < 15; t++) W[t] = _mm256_setzero_si256();
+    W[15] = _mm256_set1_epi32((HASH256_BLOCK + SHA256) * 8);
+    HASHB256_compress8(m, W);
+}
+
+AVX2_TARGET static void HASHB256_hmac8_avx2(const unsign32 *ipad, const unsign32 *opad, unsign32 u[8][HASHB256_LANES], unsign32 f[8][HASHB256_LANES], int l0, int rep)
+{
+    __m256i U[8], F[8];
+
+    for (int j = 0; j < 8; j++)
+    {
+        U[j] = _mm256_loadu_si256((const __m256i *)&u[j][l0]);
+        F[j] = _mm256_loadu_si256((const __m256i *)&f[j][l0]);
+    }
+    while (rep-- > 0)
+    {
+        HASHB256_hmac8_half(U, ipad);
+        HASHB256_hmac8_half(U, opad);
+        for (int j = 0; j < 8; j++) F[j] = _mm256_xor_si256(F[j], U[j]);
+    }
+    for (int j = 0; j < 8; j++)
+    {
+        _mm256_storeu_si256((__m256i *)&u[j][l0], U[j]);
+        _mm256_storeu_si256((__m256i *)&f[j][l0], F[j]);
+    }
+}
+
+/* h += the compression of block W into h, in each of the 16 lanes; W is overwritten */
+AVX512_TARGET static inline void HASHB256_compress16(__m512i h[8], __m512i W[16])
+{
+    __m512i v[8], t1, t2, x;
+
+    for (int j = 0; j < 8; j++) v[j] = h[j];
+
+    /* Three-way XOR is ternary-logic table 0x96, CH is 0xCA and MAJ is 0xE8 */
+    for (int t = 0; t < 64; t++)
+    {
+        if (t >= 16)
+        {
+            x = W[(t - 15) & 15];
+            t1 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x, 3), 0x96);
+            x = W[(t - 2) & 15];
+            t2 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10), 0x96);
+            W[t & 15] = _mm512_add_epi32(_mm512_add_epi32(W[t & 15], W[(t - 7) & 15]), _mm512_add_epi32(t1, t2));
+        }
+        x = v[4];
+        t1 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(x, 6), _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25), 0x96);
+        t1 = _mm512_add_epi32(_mm512_add_epi32(v[7], t1), _mm512_ternarylogic_epi32(x, v[5], v[6], 0xCA));
+        t1 = _mm512_add_epi32(_mm512_add_epi32(t1, _mm512_set1_epi32((int)HASH256_K[t])), W[t & 15]);
+        x = v[0];
+        t2 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(x, 2), _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22), 0x96);
+        t2 = _mm512_add_epi32(t2, _mm512_ternarylogic_epi32(x, v[1], v[2], 0xE8));
+        v[7] = v[6];
+        v[6] = v[5];
+        v[5] = v[4];
+        v[4] = _mm512_add_epi32(v[3], t1);
+        v[3] = v[2];
+        v[2] = v[1];
+        v[1] = v[0];
+        v[0] = _mm512_add_epi32(t1, t2);
+    }
+    for (int j = 0; j < 8; j++) h[j] = _mm512_add_epi32(h[j], v[j]);
+}
+
+AVX512_TARGET static void HASHB256_x16_avx512(unsign32 s[8][HASHB256_LANES], unsign32 w[16][HASHB256_LANES])
+{
+    __m512i h[8], W[16];
+
+    for (int j = 0; j < 8; j++) h[j] = _mm512_loadu_si512(s[j]);
+    for (int t = 0; t < 16; t++) W[t] = _mm512_loadu_si512(w[t]);
+    HASHB256_compress16(h, W);
+    for (int j = 0; j < 8; j++) _mm512_storeu_si512(s[j], h[j]);
+}
+
+AVX512_TARGET static inline void HASHB256_hmac16_half(__m512i m[8], const unsign32 *iv)
+{
+    __m512i W[16];
+
+    for (int j = 0; j < 8; j++)
+    {
+        W[j] = m[j];
+        m[j] = _mm512_set1_epi32((int)iv[j]);
+    }
+    W[8] = _mm512_set1_epi32((int)0x80000000);
+    for (int t = 9; t < 15; t++) W[t] = _mm512_setzero_si512();
+    W[15] = _mm512_set1_epi32((HASH256_BLOCK + SHA256) * 8);
+    HASHB256_compress16(m, W);
+}
+
+AVX512_TARGET static void HASHB256_hmac16_avx512(const unsign32 *ipad, const unsign32 *opad, unsign32 u[8][HASHB256_LANES], unsign32 f[8][HASHB256_LANES], int l0, int rep)
+{
+    __m512i U[8], F[8];
+
+    (void)l0;
+    for (int j = 0; j < 8; j++)
+    {
+        U[j] = _mm512_loadu_si512(u[j]);
+        F[j] = _mm512_loadu_si512(f[j]);
+    }
+    while (rep-- > 0)
+    {
+        HASHB256_hmac16_half(U, ipad);
+        HASHB256_hmac16_half(U, opad);
+        for (int j = 0; j < 8; j++) F[j] = _mm512_xor_si512(F[j], U[j]);
+    }
+    for (int j = 0; j < 8; j++)
+    {
+        _mm512_storeu_si512(u[j], U[j]);
+        _mm512_storeu_si512(f[j], F[j]);
+    }
+}
+
+#endif
+
+/* The kernels of one level, and the fewest HMAC chains worth a vector step when SHA-NI is in use */
+typedef struct
+{
+    HASHB256_kernel kernel;
+    HASHB256_chain chain;
+    int width;
+    int chainmin;
+} HASHB256_level;
+
+/* Indexed by HASHB256_SIMD_*. The chains keep their state in registers with no transposing,
+   so a step costs only about five SHA-NI blocks with AVX-512 and seven with AVX2 */
+static const HASHB256_level HASHB256_levels[] = {
+    {NULL, NULL, 1, 0},
+#ifdef HASHB256_X86
+    {HASHB256_x8_avx2, HASHB256_hmac8_avx2, 8, 7},
+    {HASHB256_x16_avx512, HASHB256_hmac16_avx512, 16, 5},
+#endif
+};
+
+static int HASHB256_active = -1;
+
+int HASHB256_simd(int max)
+{
+    int k = HASHB256_SIMD_NONE;
+
+#ifdef HASHB256_X86
+    __builtin_cpu_init();
+    if (max >= HASHB256_SIMD_AVX512 && __builtin_cpu_supports("avx512f"))
+        k = HASHB256_SIMD_AVX512;
+    else if (max >= HASHB256_SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+        k = HASHB256_SIMD_AVX2;
+#else
+    (void)max;
+#endif
+    return DISPATCH_set(&HASHB256_active, k);
+}
+
+int HASHB256_simd_active(void)
+{
+    return DISPATCH_get(&HASHB256_active, HASHB256_simd, HASHB256_SIMD_AVX512);
+}
+
+/* Set up lane L for job j, with its starting chaining value in h */
+static void HASHB256_load(HASHB256_LANE *L, const HASH256_JOB *j, unsign32 *h)
+{
+    int full = j->len / HASH256_BLOCK, rem = j->len % HASH256_BLOCK;
+    unsign64 bits = ((unsign64)j->prefix + (unsign64)j->len) * 8;
+
+    memset(L->pad, 0, sizeof(L->pad));
+    if (rem > 0) memcpy(L->pad, j->msg + full * HASH256_BLOCK, (size_t)rem);
+    L->pad[rem] = 0x80;
+    L->npad = rem < HASH256_BLOCK - 8 ? 1 : 2;
+    for (int i = 0; i < 8; i++) L->pad[L->npad * HASH256_BLOCK - 1 - i] = (unsigned char)(bits >> (8 * i));
+    for (int i = 0; i < 8; i++) h[i] = j->iv != NULL ? j->iv[i] : IV[i];
+
+    L->tail = full == 0;
+    L->p = L->tail ? L->pad : (const unsigned char *)j->msg;
+    L->left = L->tail ? L->npad : full;
+}
+
+/* Finish lane L on the single-stream kernel and write its digest */
+static void HASHB256_finish(HASHB256_LANE *L, unsign32 *h, char *digest)
+{
+    HASH256_blocks(h, (const char *)L->p, L->left);
+    if (!L->tail) HASH256_blocks(h, (const char *)L->pad, L->npad);
+    for (int i = 0; i < SHA256; i++) digest[i] = (char)(h[i / 4] >> (8 * (3 - i % 4)));
+}
+
+void HASH256_multi(int n, HASH256_JOB J[])
+{
+    const HASHB256_level *K = &HASHB256_levels[HASHB256_simd_active()];
+    HASHB256_LANE L[HASHB256_LANES];
+    unsign32 s[8][HASHB256_LANES], w[16][HASHB256_LANES], h[8];
+    const unsigned char *q;
+    int l, k, next = 0, active = 0, lanes, single;
+
+    /* A SHA-NI block costs about one lane's share of a step, so once the queue is dry the
+       stragglers are never slower one by one; a portable C block costs about half a step */
+    lanes = K->width;
+    single = HASH256_simd_active() == HASH256_SIMD_SHANI ? lanes : 2;
+
+    if (lanes == 1)
+    {
+        for (next = 0; next < n; next++)
+        {
+            HASHB256_load(&L[0], &J[next], h);
+            HASHB256_finish(&L[0], h, J[next].digest);
+        }
+        memset(L[0].pad, 0, sizeof(L[0].pad));
+        return;
+    }
+
+    memset(w, 0, sizeof(w));
+    for (l = 0; l < lanes; l++)
+    {
+        L[l].job = -1;
+        if (next == n) continue;
+        HASHB256_load(&L[l], &J[next], h);
+        for (int i = 0; i < 8; i++) s[i][l] = h[i];
+        L[l].job = next++;
+        active++;
+    }
+
+    while (active > 0)
+    {
+        /* The queue is dry and most lanes idle: the rest are quicker one by one */
+        if (next == n && active <= single)
+        {
+            for (l = 0; l < lanes; l++)
+            {
+                if (L[l].job < 0) continue;
+                for (int i = 0; i < 8; i++) h[i] = s[i][l];
+                HASHB256_finish(&L[l], h, J[L[l].job].digest);
+            }
+            break;
+        }
+
+        k = 0;
+        for (l = 0; l < lanes; l++)
+            if (L[l].job >= 0 && (k == 0 || L[l].left < k)) k = L[l].left;
+
+        for (int step = 0; step < k; step++)
+        {
+            for (l = 0; l < lanes; l++)
+            {
+                if (L[l].job < 0) continue;
+                q = L[l].p + step * HASH256_BLOCK;
+                for (int t = 0; t < 16; t++)
+                    w[t][l] = ((unsign32)q[4 * t] << 24) | ((unsign32)q[4 * t + 1] << 16) | ((unsign32)q[4 * t + 2] << 8) | (unsign32)q[4 * t + 3];
+            }
+            K->kernel(s, w);
+        }
+
+        for (l = 0; l < lanes; l++)
+        {
+            if (L[l].job < 0) continue;
+            L[l].p += k * HASH256_BLOCK;
+            L[l].left -= k;
+            if (L[l].left > 0) continue;
+            if (!L[l].tail)
+            {
+                L[l].tail = 1;
+                L[l].p = L[l].pad;
+                L[l].left = L[l].npad;
+                continue;
+            }
+
+            for (int i = 0; i < SHA256; i++) J[L[l].job].digest[i] = (char)(s[i / 4][l] >> (8 * (3 - i % 4)));
+            L[l].job = -1;
+            active--;
+            if (next == n) continue;
+            HASHB256_load(&L[l], &J[next], h);
+            for (int i = 0; i < 8; i++) s[i][l] = h[i];
+            L[l].job = next++;
+            active++;
+        }
+    }
+
+    /* Message tails and HMAC key states may be secret */
+    memset(L, 0, sizeof(L));
+    memset(s, 0, sizeof(s));
+    memset(w, 0, sizeof(w));
+    memset(h, 0, sizeof(h));
+}
+
+/* The chain of lane l alone, on the single-stream kernel */
+static void HASHB256_chain1(const unsign32 *ipad, const unsign32 *opad, unsign32 u[8][HASHB256_LANES], unsign32 f[8][HASHB256_LANES], int l, int rep)
+{
+    unsigned char b[HASH256_BLOCK];
+    unsign32 h[8];
+    int i, j;
+
+    /* The inner and outer messages are both 32 bytes, so share one padded block */
+    memset(b, 0, sizeof(b));
+    b[SHA256] = 0x80;
+    b[HASH256_BLOCK - 2] = ((HASH256_BLOCK + SHA256) * 8) >> 8;
+    for (j = 0; j < 8; j++) h[j] = u[j][l];
+    while (rep-- > 0)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            for (j = 0; j < SHA256; j++) b[j] = (unsigned char)(h[j / 4] >> (8 * (3 - j % 4)));
+            memcpy(h, i == 0 ? ipad : opad, sizeof(h));
+            HASH256_blocks(h, (const char *)b, 1);
+        }
+        for (j = 0; j < 8; j++) f[j][l] ^= h[j];
+    }
+    for (j = 0; j < 8; j++) u[j][l] = h[j];
+    memset(b, 0, sizeof(b));
+    memset(h, 0, sizeof(h));
+}
+
+void HASH256_hmac_chains(const unsign32 ipad[8], const unsign32 opad[8], int n, unsign32 u[8][HASHB256_LANES], unsign32 f[8][HASHB256_LANES], int rep)
+{
+    const HASHB256_level *K = &HASHB256_levels[HASHB256_simd_active()];
+    int l = 0, lanes = K->width;
+    /* Without SHA-NI a step costs less than two portable C blocks */
+    int chainmin = HASH256_simd_active() == HASH256_SIMD_SHANI ? K->chainmin : 2;
+
+    /* Whole groups of lanes in the vector kernel, while that beats one at a time */
+    for (; lanes > 1 && n - l >= chainmin; l += lanes) K->chain(ipad, opad, u, f, l, rep);
+    for (; l < n; l++) HASHB256_chain1(ipad, opad, u, f, l, rep);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file hashb256.h
+ * @brief Multi-buffer SHA-256 over many independent messages
+ *
+ * One SHA-256 stream is a chain of dependent rounds and leaves most of a
+ * vector unit idle. Batch verification, batch signing and HS256 token
+ * checks hash many short, unrelated messages, so instead each 32-bit lane
+ * of a vector register carries a different message: 16 lanes with
+ * AVX-512, 8 with AVX2. Every step compresses one block in every lane.
+ *
+ * Messages are queued as HASH256_JOBs of any lengths. A lane takes the
+ * next job from the queue as soon as its message is done, so lanes stay
+ * full while the queue lasts; once it is empty and few lanes are left,
+ * those finish on the single-stream HASH256_blocks instead.
+ *
+ * A job may start from an intermediate chaining value rather than the
+ * SHA-256 IV, with the bytes it already covers counted in the final
+ * length, which is how HMAC's inner and outer hashes resume after a
+ * cached key block.
+ *
+ * PBKDF2 with HMAC-SHA256 is a long chain of HMACs of 32-byte messages,
+ * one chain per output block, each HMAC two compressions from the cached
+ * key states. HASH256_hmac_chains runs several such chains in the lanes,
+ * with the chain values held in registers for the whole run.
+ *
+ * The kernels are chosen at run time, as for FPB_NIST256. Without AVX2,
+ * or when built with -DHASH256_NOSIMD, jobs are hashed one at a time.
+ */
+
+#ifndef HASHB256_H
+#define HASHB256_H
+
+#include "core.h"
+#include "hash256.h"
+
+#define HASHB256_LANES 16       /**< Most messages in flight at once */
+
+#define HASHB256_SIMD_NONE 0    /**< One message at a time on HASH256_blocks */
+#define HASHB256_SIMD_AVX2 1    /**< 8 lanes of AVX2 */
+#define HASHB256_SIMD_AVX512 2  /**< 16 lanes of AVX-512 */
+
+/**
+	@brief One message for HASH256_multi
+*/
+typedef struct
+{
+    const char *msg;     /**< The message bytes */
+    int len;             /**< The number of message bytes */
+    const unsign32 *iv;  /**< Eight chaining words to start from, or NULL for the SHA-256 IV */
+    int prefix;          /**< Bytes already hashed into iv, a multiple of HASH256_BLOCK, 0 if iv=NULL */
+    char *digest;        /**< On exit the SHA256 bytes of the hash */
+} HASH256_JOB;
+
+/**	@brief Selects the widest multi-buffer kernel the CPU has, up to a limit
+ *
+	The choice is made automatically, and thread-safely, on first use; this
+	overrides it, for comparing the kernels. All give the same digests, so
+	hashing in other threads stays correct across the switch.
+	@param max the widest kernel allowed, HASHB256_SIMD_NONE, _AVX2 or _AVX512
+	@return the kernel now in use
+ */
+extern int HASHB256_simd(int max);
+/**	@brief Tests which multi-buffer kernel is in use
+ *
+	@return HASHB256_SIMD_NONE, HASHB256_SIMD_AVX2 or HASHB256_SIMD_AVX512
+ */
+extern int HASHB256_simd_active(void);
+/**	@brief Hashes n independent messages, several at a time
+ *
+	Each digest is the same as HASH256_init, HASH256_update over the
+	message and HASH256_hash would give, or when iv is set, the same as
+	resuming from a hash256 state with that chaining value and length.
+	@param n the number of jobs
+	@param J array of n jobs, processed in order of the queue
+ */
+extern void HASH256_multi(int n, HASH256_JOB J[]);
+/**	@brief Runs HMAC-SHA256 iteration chains side by side
+ *
+	For each chain l < n, rep times: u = HMAC(K, u) over the 32-byte u,
+	then f ^= u, which is the inner loop of PBKDF2. K is given by the
+	chaining values after its ipad and opad blocks, as in HMAC_KEY.
+	Columns n and above of u and f are scratch.
+	@param ipad the chaining value after the block of K XOR ipad
+	@param opad the chaining value after the block of K XOR opad
+	@param n the number of chains, at most HASHB256_LANES
+	@param u chain l in u[.][l], word-major, replaced by the last HMAC
+	@param f accumulator l in f[.][l], word-major
+	@param rep the number of iterations
+ */
+extern void HASH256_hmac_chains(const unsign32 ipad[8], const unsign32 opad[8], int n, unsign32 u[8][HASHB256_LANES], unsign32 f[8][HASHB256_LANES], int rep);
+
+#endif
@@ -0,0 +1,395 @@
+/**
+ * hmac.c - HMAC with a cached key, and HKDF and PBKDF2 on top of it
+ *
+ * The key states are taken after exactly one block of padded key, so the
+ * partial block of each is empty and a copy of the state is all there is
+ * to restore. The SHA-2 states are the compact hash256c and hash512c.
+ *
+ * PBKDF2 threads claim runs of output blocks from a shared counter and
+ * write each block straight to its place in the output; batch HKDF
+ * threads claim whole requests the same way.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#define _DARWIN_C_SOURCE  /* macOS hides _SC_NPROCESSORS_ONLN under strict POSIX */
+
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "hmac.h"
+#include "hashb256.h"
+
+typedef struct
+{
+    const HMAC_KEY *key;
+    octet *S;    /* The salt */
+    int rep;     /* Iterations */
+    int len;     /* Output bytes */
+    int blocks;  /* Output blocks */
+    int claim;   /* Blocks claimed at a time */
+    int next;    /* Next block to claim, from 0 */
+    char *out;
+} HMAC_PBKDF2_JOB;
+
+typedef struct
+{
+    const HMAC_KEY *key;  /* The PRK */
+    HMAC_HKDF_REQ *R;
+    int n;                /* Requests */
+    int next;             /* Next request to claim */
+} HMAC_HKDF_JOB;
+
+/* The HMAC block size for a hash, or 0 if it is not supported */
+static int HMAC_blksize(int hash, int hlen)
+{
+    if (hash == MC_SHA2)
+    {
+        if (hlen == SHA256) return HASH256_BLOCK;
+        if (hlen == SHA384 || hlen == SHA512) return HASH512_BLOCK;
+    }
+    if (hash == MC_SHA3 && hlen >= 16 && hlen <= 64 && hlen % 4 == 0) return 200 - 2 * hlen;
+    return 0;
+}
+
+static void HMAC_hinit(int hash, int hlen, HMAC_STATE *s)
+{
+    if (hash == MC_SHA3) SHA3_init(&s->s3, hlen);
+    else if (hlen == SHA256) HASH256C_init(&s->s256);
+    else if (hlen == SHA384) HASH384C_init(&s->s512);
+    else HASH512C_init(&s->s512);
+}
+
+static void HMAC_hupdate(int hash, int hlen, HMAC_STATE *s, const char *b, int len)
+{
+    if (hash == MC_SHA3) SHA3_update(&s->s3, b, len);
+    else if (hlen == SHA256) HASH256C_update(&s->s256, b, len);
+    else HASH512C_update(&s->s512, b, len);
+}
+
+/* The hlen-byte digest */
+static void HMAC_hfinal(int hash, int hlen, HMAC_STATE *s, char *h)
+{
+    if (hash == MC_SHA3) SHA3_digest(&s->s3, h);
+    else if (hlen == SHA256) HASH256C_hash(&s->s256, h);
+    else HASH512C_hash(&s->s512, h);
+}
+
+int HMAC_KEY_init(HMAC_KEY *k, int hash, int hlen, octet *K)
+{
+    unsigned char k0[200];
+    int i, blen = HMAC_blksize(hash, hlen);
+
+    if (blen == 0) return -1;
+    k->hash = hash;
+    k->hlen = hlen;
+
+    memset(k0, 0, sizeof(k0));
+    if (K->len > blen)
+    {
+        HMAC_hinit(hash, hlen, &k->ipad);
+        HMAC_hupdate(hash, hlen, &k->ipad, K->val, K->len);
+        HMAC_hfinal(hash, hlen, &k->ipad, (char *)k0);
+    }
+    else if (K->len > 0) memcpy(k0, K->val, (size_t)K->len);
+
+    for (i = 0; i < blen; i++) k0[i] ^= 0x36;
+    HMAC_hinit(hash, hlen, &k->ipad);
+    HMAC_hupdate(hash, hlen, &k->ipad, (const char *)k0, blen);
+    for (i = 0; i < blen; i++) k0[i] ^= 0x36 ^ 0x5c;
+    HMAC_hinit(hash, hlen, &k->opad);
+    HMAC_hupdate(hash, hlen, &k->opad, (const char *)k0, blen);
+
+    memset(k0, 0, sizeof(k0));
+    return 0;
+}
+
+void HMAC_KEY_kill(HMAC_KEY *k)
+{
+    memset(k, 0, sizeof(HMAC_KEY));
+}
+
+void HMAC_start(HMAC_CTX *c, const HMAC_KEY *k)
+{
+    c->key = k;
+    c->inner = k->ipad;
+}
+
+void HMAC_update(HMAC_CTX *c, const char *m, int len)
+{
+    HMAC_hupdate(c->key->hash, c->key->hlen, &c->inner, m, len);
+}
+
+void HMAC_final(HMAC_CTX *c, char *t, int len)
+{
+    const HMAC_KEY *k = c->key;
+    HMAC_STATE outer = k->opad;
+    char h[64];
+
+    HMAC_hfinal(k->hash, k->hlen, &c->inner, h);
+    HMAC_hupdate(k->hash, k->hlen, &outer, h, k->hlen);
+    HMAC_hfinal(k->hash, k->hlen, &outer, h);
+    if (len > k->hlen) len = k->hlen;
+    memcpy(t, h, (size_t)len);
+
+    memset(h, 0, sizeof(h));
+    memset(&outer, 0, sizeof(outer));
+    memset(&c->inner, 0, sizeof(c->inner));
+}
+
+void HMAC_keyed(const HMAC_KEY *k, octet *T, int len, octet *M)
+{
+    HMAC_CTX c;
+
+    T->len = 0;
+    if (len > k->hlen) len = k->hlen;
+    if (len > T->max) return;
+    HMAC_start(&c, k);
+    HMAC_update(&c, M->val, M->len);
+    HMAC_final(&c, T->val, len);
+    T->len = len;
+}
+
+void HMAC_HKDF_Extract(int hash, int hlen, octet *K, octet *P, octet *S)
+{
+    HMAC_KEY k;
+    char z[64];
+    octet Z = {0, sizeof(z), z};
+
+    if (P == NULL)
+    {
+        memset(z, 0, sizeof(z));
+        Z.len = hlen;
+        P = &Z;
+    }
+    K->len = 0;
+    if (HMAC_KEY_init(&k, hash, hlen, P) != 0) return;
+    HMAC_keyed(&k, K, hlen, S);
+    HMAC_KEY_kill(&k);
+}
+
+/* olen bytes of HKDF output for info I into e, on the PRK key k */
+static void HMAC_HKDF_expand(const HMAC_KEY *k, char *e, int olen, octet *I)
+{
+    HMAC_CTX c;
+    char t[64];
+    unsigned char i;
+    int n, m = 0, tlen = 0;
+
+    for (i = 1; m < olen; i++)
+    {
+        /* T(i) = HMAC(K, T(i-1) | I | i) */
+        HMAC_start(&c, k);
+        HMAC_update(&c, t, tlen);
+        HMAC_update(&c, I->val, I->len);
+        HMAC_update(&c, (const char *)&i, 1);
+        HMAC_final(&c, t, k->hlen);
+        tlen = k->hlen;
+        n = olen - m < tlen ? olen - m : tlen;
+        memcpy(e + m, t, (size_t)n);
+        m += n;
+    }
+    memset(t, 0, sizeof(t));
+}
+
+void HMAC_HKDF_Expand(int hash, int hlen, octet *E, int olen, octet *K, octet *I)
+{
+    HMAC_KEY k;
+
+    E->len = 0;
+    /* The block counter is a single byte, so RFC 5869 allows at most 255 blocks */
+    if (olen <= 0 || olen > 255 * hlen || olen > E->max || HMAC_KEY_init(&k, hash, hlen, K) != 0) return;
+    HMAC_HKDF_expand(&k, E->val, olen, I);
+    E->len = olen;
+    HMAC_KEY_kill(&k);
+}
+
+/* Claim requests until none are left */
+static void HMAC_HKDF_work(HMAC_HKDF_JOB *J)
+{
+    int i;
+
+    while ((i = __atomic_fetch_add(&J->next, 1, __ATOMIC_RELAXED)) < J->n)
+        HMAC_HKDF_expand(J->key, J->R[i].key, J->R[i].len, J->R[i].info);
+}
+
+static void *HMAC_HKDF_thread(void *arg)
+{
+    HMAC_HKDF_work((HMAC_HKDF_JOB *)arg);
+    return NULL;
+}
+
+int HMAC_HKDF_batch(int hash, int hlen, octet *P, octet *S, int n, HMAC_HKDF_REQ R[], octet *A, int threads)
+{
+    HMAC_KEY k;
+    HMAC_HKDF_JOB J;
+    pthread_t tid[64];
+    char prk[64];
+    octet PRK = {0, sizeof(prk), prk};
+    long total = 0, blocks = 0;
+    int i, started = 0;
+
+    if (HMAC_blksize(hash, hlen) == 0) return -1;
+    for (i = 0; i < n; i++)
+    {
+        if (R[i].len < 0 || R[i].len > 255 * hlen) return -1;
+        total += R[i].len;
+        blocks += (R[i].len + hlen - 1) / hlen;
+    }
+    if (total > A->max) return -1;
+
+    /* Extract once, and key HMAC on the PRK once for every expansion */
+    HMAC_HKDF_Extract(hash, hlen, &PRK, P, S);
+    HMAC_KEY_init(&k, hash, hlen, &PRK);
+    memset(prk, 0, sizeof(prk));
+
+    for (i = 0, total = 0; i < n; i++)
+    {
+        R[i].key = A->val + total;
+        total += R[i].len;
+    }
+    A->len = (int)total;
+
+    J.key = &k;
+    J.R = R;
+    J.n = n;
+    J.next = 0;
+
+    if (threads == 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (blocks < HMAC_HKDF_MT_MIN || threads < 1) threads = 1;
+    if (threads > n) threads = n;
+    if (threads > (int)(sizeof(tid) / sizeof(tid[0]))) threads = (int)(sizeof(tid) / sizeof(tid[0]));
+    for (i = 1; i < threads; i++)
+        if (pthread_create(&tid[started], NULL, HMAC_HKDF_thread, &J) == 0) started++;
+    HMAC_HKDF_work(&J);
+    for (i = 0; i < started; i++) pthread_join(tid[i], NULL);
+
+    HMAC_KEY_kill(&k);
+    return 0;
+}
+
+/* U1 = HMAC(P, S | INT(blk)) */
+static void HMAC_PBKDF2_first(const HMAC_KEY *k, octet *S, unsign32 blk, char *u)
+{
+    HMAC_CTX c;
+    char b[4];
+
+    b[0] = (char)(blk >> 24);
+    b[1] = (char)(blk >> 16);
+    b[2] = (char)(blk >> 8);
+    b[3] = (char)blk;
+    HMAC_start(&c, k);
+    HMAC_update(&c, S->val, S->len);
+    HMAC_update(&c, b, 4);
+    HMAC_final(&c, u, k->hlen);
+}
+
+/* F = U1 ^ ... ^ Urep of the n blocks from b, counting from 0, into the output */
+static void HMAC_PBKDF2_blocks(HMAC_PBKDF2_JOB *J, int b, int n)
+{
+    const HMAC_KEY *k = J->key;
+    HMAC_CTX c;
+    unsign32 u[8][HASHB256_LANES], f[8][HASHB256_LANES];
+    char t[64], v[64];
+    int i, j, m, hlen = k->hlen;
+
+    if (k->hash == MC_SHA2 && hlen == SHA256)
+    {
+        /* The chains of all n blocks side by side, from the cached key states */
+        memset(u, 0, sizeof(u));
+        for (i = 0; i < n; i++)
+        {
+            HMAC_PBKDF2_first(k, J->S, (unsign32)(b + i + 1), t);
+            for (j = 0; j < SHA256; j++) u[j / 4][i] = (u[j / 4][i] << 8) | (unsigned char)t[j];
+        }
+        memcpy(f, u, sizeof(f));
+        HASH256_hmac_chains(k->ipad.s256.h, k->opad.s256.h, n, u, f, J->rep - 1);
+        for (i = 0; i < n; i++)
+        {
+            for (j = 0; j < SHA256; j++) t[j] = (char)(f[j / 4][i] >> (8 * (3 - j % 4)));
+            m = J->len - (b + i) * hlen < hlen ? J->len - (b + i) * hlen : hlen;
+            memcpy(J->out + (b + i) * hlen, t, (size_t)m);
+        }
+        memset(u, 0, sizeof(u));
+        memset(f, 0, sizeof(f));
+    }
+    else
+    {
+        for (i = 0; i < n; i++)
+        {
+            HMAC_PBKDF2_first(k, J->S, (unsign32)(b + i + 1), v);
+            memcpy(t, v, (size_t)hlen);
+            for (m = 2; m <= J->rep; m++)
+            {
+                HMAC_start(&c, k);
+                HMAC_update(&c, v, hlen);
+                HMAC_final(&c, v, hlen);
+                for (j = 0; j < hlen; j++) t[j] ^= v[j];
+            }
+            m = J->len - (b + i) * hlen < hlen ? J->len - (b + i) * hlen : hlen;
+            memcpy(J->out + (b + i) * hlen, t, (size_t)m);
+        }
+    }
+    memset(t, 0, sizeof(t));
+    memset(v, 0, sizeof(v));
+}
+
+/* Claim runs of blocks until none are left */
+static void HMAC_PBKDF2_work(HMAC_PBKDF2_JOB *J)
+{
+    int b;
+
+    while ((b = __atomic_fetch_add(&J->next, J->claim, __ATOMIC_RELAXED)) < J->blocks)
+        HMAC_PBKDF2_blocks(J, b, J->blocks - b < J->claim ? J->blocks - b : J->claim);
+}
+
+static void *HMAC_PBKDF2_thread(void *arg)
+{
+    HMAC_PBKDF2_work((HMAC_PBKDF2_JOB *)arg);
+    return NULL;
+}
+
+void HMAC_PBKDF2(int hash, int hlen, octet *K, int len, octet *P, octet *S, int rep)
+{
+    HMAC_PBKDF2_mt(hash, hlen, K, len, P, S, rep, 1);
+}
+
+void HMAC_PBKDF2_mt(int hash, int hlen, octet *K, int len, octet *P, octet *S, int rep, int threads)
+{
+    HMAC_KEY k;
+    HMAC_PBKDF2_JOB J;
+    pthread_t tid[64];
+    int i, started = 0;
+
+    K->len = 0;
+    if (len <= 0 || len > K->max || HMAC_KEY_init(&k, hash, hlen, P) != 0) return;
+
+    J.key = &k;
+    J.S = S;
+    J.rep = rep;
+    J.len = len;
+    J.blocks = (len + hlen - 1) / hlen;
+    J.next = 0;
+    J.out = K->val;
+
+    if (threads == 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > J.blocks) threads = J.blocks;
+    if (threads > (int)(sizeof(tid) / sizeof(tid[0]))) threads = (int)(sizeof(tid) / sizeof(tid[0]));
+    /* SHA-256 blocks go through the lanes in runs, shared evenly between the threads */
+    J.claim = 1;
+    if (hash == MC_SHA2 && hlen == SHA256)
+    {
+        J.claim = (J.blocks + threads - 1) / threads;
+        if (J.claim > HASHB256_LANES) J.claim = HASHB256_LANES;
+        HASHB256_simd_active();
+    }
+
+    for (i = 1; i < threads; i++)
+        if (pthread_create(&tid[started], NULL, HMAC_PBKDF2_thread, &J) == 0) started++;
+    HMAC_PBKDF2_work(&J);
+    for (i = 0; i < started; i++) pthread_join(tid[i], NULL);
+
+    K->len = len;
+    HMAC_KEY_kill(&k);
+}
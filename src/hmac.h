@@ -0,0 +1,186 @@
+/**
+ * @file hmac.h
+ * @brief HMAC with a cached key, and HKDF and PBKDF2 on top of it
+ *
+ * HMAC hashes the key XOR ipad and the key XOR opad, a block each, before
+ * and after every message. For a fixed key those two blocks always leave
+ * the same two hash states, so HMAC_KEY computes them once and each tag
+ * starts from copies: a tag costs the compressions of the message and of
+ * the inner hash, and nothing for the key.
+ *
+ * An HMAC_CTX runs one tag incrementally, for messages that arrive in
+ * pieces. HMAC_HKDF_Extract, HMAC_HKDF_Expand and HMAC_PBKDF2 give the
+ * same output as MIRACL's HKDF_Extract, HKDF_Expand and PBKDF2, keying
+ * HMAC once per call rather than once per block or iteration.
+ *
+ * Every PBKDF2 output block is an independent chain of rep HMACs, each
+ * two compressions from the cached key. HMAC_PBKDF2_mt shares the blocks
+ * out between threads, and runs HMAC-SHA256 chains several at a time in
+ * the lanes of HASH256_hmac_chains.
+ *
+ * A key hierarchy derives many subkeys from one secret, one HKDF_Expand
+ * per subkey with its own info. HMAC_HKDF_batch extracts once, keys HMAC
+ * on the PRK once, and expands every request into one arena.
+ *
+ * SHA-256, SHA-384 and SHA-512 (MC_SHA2) and SHA3 (MC_SHA3) are supported,
+ * as by MIRACL's HMAC, with block sizes 64, 128 and the SHA3 rate.
+ */
+
+#ifndef HMAC_H
+#define HMAC_H
+
+#include "core.h"
+#include "hash256.h"
+#include "hash512.h"
+#include "sha3.h"
+
+#define HMAC_HKDF_MT_MIN 256  /**< Fewest output blocks worth starting threads for */
+
+/**
+ * @brief A hash state of any family HMAC runs on */
+typedef union
+{
+    hash256c s256;  /**< SHA-256 */
+    hash512c s512;  /**< SHA-384 and SHA-512 */
+    sha3 s3;        /**< SHA3 */
+} HMAC_STATE;
+
+/**
+ * @brief An HMAC key, as the hash states after the padded key */
+typedef struct
+{
+    int hash;         /**< MC_SHA2 or MC_SHA3 */
+    int hlen;         /**< The hash output length in bytes */
+    HMAC_STATE ipad;  /**< The hash of the key XOR ipad */
+    HMAC_STATE opad;  /**< The hash of the key XOR opad */
+} HMAC_KEY;
+
+/**
+ * @brief One HMAC computation in progress */
+typedef struct
+{
+    const HMAC_KEY *key;  /**< The key, which must outlive the computation */
+    HMAC_STATE inner;     /**< The inner hash so far */
+} HMAC_CTX;
+
+/**
+ * @brief One key for HMAC_HKDF_batch */
+typedef struct
+{
+    octet *info;  /**< The context information, such as tenant, purpose and epoch */
+    int len;      /**< Bytes of key wanted, at most 255 times the hash length */
+    char *key;    /**< On exit, the len bytes of key in the arena */
+} HMAC_HKDF_REQ;
+
+/**	@brief Keys HMAC
+ *
+	@param k the key context to set up
+	@param hash the hash family (SHA2 or SHA3)
+	@param hlen the hash function output length (32,48 or 64 for SHA2)
+	@param K the key
+	@return 0 if OK, or -1 if the hash is not supported
+ */
+extern int HMAC_KEY_init(HMAC_KEY *k, int hash, int hlen, octet *K);
+/**	@brief Erases a key context
+ *
+	@param k the key context
+ */
+extern void HMAC_KEY_kill(HMAC_KEY *k);
+/**	@brief Starts a tag
+ *
+	@param c the computation to start
+	@param k the key
+ */
+extern void HMAC_start(HMAC_CTX *c, const HMAC_KEY *k);
+/**	@brief Adds message bytes
+ *
+	@param c the computation
+	@param m the bytes
+	@param len the number of bytes
+ */
+extern void HMAC_update(HMAC_CTX *c, const char *m, int len);
+/**	@brief Finishes a tag, and erases the computation
+ *
+	@param c the computation
+	@param t the output tag
+	@param len the tag length, at most the hash output length
+ */
+extern void HMAC_final(HMAC_CTX *c, char *t, int len);
+/**	@brief HMAC function with a cached key
+ *
+	Same tag as HMAC(k->hash, k->hlen, T, len, K, M) with k keyed by K.
+	@param k the key
+	@param T an output tag, left empty if it cannot hold len bytes
+	@param len the tag length, cut to the hash output length
+	@param M an input message
+ */
+extern void HMAC_keyed(const HMAC_KEY *k, octet *T, int len, octet *M);
+/**	@brief HKDF_Extract function, on a cached key
+ *
+	Same output as HKDF_Extract.
+	@param hash the hash family (SHA2 or SHA3)
+	@param hlen the hash function output length (32,48 or 64)
+	@param K an output Key
+	@param P public input salt, or NULL
+	@param S raw secret keying material
+ */
+extern void HMAC_HKDF_Extract(int hash, int hlen, octet *K, octet *P, octet *S);
+/**	@brief HKDF_Expand function, on a cached key
+ *
+	Same output as HKDF_Expand, with the key K hashed once for all blocks.
+	E is left empty if olen is more than 255*hlen, or than E can hold.
+	@param hash the hash family (SHA2 or SHA3)
+	@param hlen the hash function output length (32,48 or 64)
+	@param E an expanded output Key
+	@param olen is the desired length of the expanded key
+	@param K is the fixed length input key
+	@param I is public context information
+ */
+extern void HMAC_HKDF_Expand(int hash, int hlen, octet *E, int olen, octet *K, octet *I);
+/**	@brief Derives many keys from one secret by HKDF
+ *
+	Key i is the same as HKDF_Expand(hash, hlen, E, R[i].len, PRK, R[i].info)
+	with PRK from HKDF_Extract(hash, hlen, PRK, P, S). The keys are laid out
+	in A in request order. With threads > 1 and at least HMAC_HKDF_MT_MIN
+	output blocks, requests are shared between the calling thread and up
+	to threads-1 helper threads; threads = 0 uses one per online CPU.
+	@param hash the hash family (SHA2 or SHA3)
+	@param hlen the hash function output length (32,48 or 64)
+	@param P public input salt, or NULL
+	@param S raw secret keying material
+	@param n the number of requests
+	@param R array of n requests, each key set to its place in A
+	@param A the arena for all the keys
+	@param threads the most threads to use, or 0 for one per CPU
+	@return 0 if OK, or -1 if the hash is not supported, a length is out of range or A is too short
+ */
+extern int HMAC_HKDF_batch(int hash, int hlen, octet *P, octet *S, int n, HMAC_HKDF_REQ R[], octet *A, int threads);
+/**	@brief PBKDF2 Password Based Key Derivation Function, on a cached key
+ *
+	Same output as PBKDF2, with the password hashed once for all iterations.
+	@param hash is the hash type
+	@param hlen is the hash output length
+	@param K the derived key, left empty if it cannot hold len bytes
+	@param len the length of the derived key
+	@param P input password
+	@param S input salt
+	@param rep Number of times to be iterated.
+ */
+extern void HMAC_PBKDF2(int hash, int hlen, octet *K, int len, octet *P, octet *S, int rep);
+/**	@brief PBKDF2 Password Based Key Derivation Function, on several threads
+ *
+	Same output as PBKDF2. With threads > 1 the output blocks are shared
+	between the calling thread and up to threads-1 helper threads;
+	threads = 0 uses one per online CPU. HMAC_PBKDF2 is threads = 1.
+	@param hash is the hash type
+	@param hlen is the hash output length
+	@param K the derived key, left empty if it cannot hold len bytes
+	@param len the length of the derived key
+	@param P input password
+	@param S input salt
+	@param rep Number of times to be iterated.
+	@param threads the most threads to use, or 0 for one per CPU
+ */
+extern void HMAC_PBKDF2_mt(int hash, int hlen, octet *K, int len, octet *P, octet *S, int rep, int threads);
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * safegcd_NIST256.c - Constant-time safegcd inversion modulo p and r
+ *
+ * Follows libsecp256k1's modinv64. With zeta = -(delta + 1/2), a divstep
+ * on (zeta, f, g) with f odd is
+ *   zeta < 0 and g odd:  (zeta, f, g) -> (-zeta - 2, g, (g - f)/2)
+ *   otherwise:           (zeta, f, g) -> (zeta - 1, f, (g + (g & 1).f)/2)
+ * and after enough steps g = 0 and f = +-1. The transition matrices are
+ * also applied to (d, e), which start at (0, 1) and are kept reduced mod
+ * m, so that at the end d = +-1/x mod m.
+ *
+ * Numbers are held as five signed 62-bit limbs, so a matrix entry times
+ * a limb fits in 128 bits with room for the sums.
+ */
+
+#include "safegcd_NIST256.h"
+
+typedef __int128 s128;
+
+#define M62 (((unsign64)-1) >> 2)
+
+typedef struct
+{
+    sign64 v[5];  /* Little-endian limbs in radix 2^62, the top one signed */
+} SIGNED62;
+
+typedef struct
+{
+    SIGNED62 m;       /* The modulus */
+    unsign64 minv62;  /* 1/m mod 2^62 */
+} MODINFO;
+
+/* Transition matrix of 59 divsteps, scaled by 2^62 */
+typedef struct
+{
+    sign64 u, v, q, r;
+} TRANS2X2;
+
+static const MODINFO MOD_P = {{{0x3FFFFFFFFFFFFFFFLL, 0x00000003FFFFFFFFLL, 0x0000000000000000LL, 0x3FFFFFC000000040LL, 0xFFLL}}, 0x3FFFFFFFFFFFFFFFULL};
+static const MODINFO MOD_R = {{{0x33B9CAC2FC632551LL, 0x339BEAB69C5E7A13LL, 0x3FFFFFFFFFFFFFFBLL, 0x3FFFFFC00000003FLL, 0xFFLL}}, 0x332E375511FF43B1ULL};
+
+/* 59 divsteps on the low bits of f and g, without branches */
+static sign64 divsteps_59(sign64 zeta, unsign64 f0, unsign64 g0, TRANS2X2 *t)
+{
+    /* Entries start as the identity times 8 = 2^(62-59), and are kept as unsigned so the shifts are defined */
+    unsign64 u = 8, v = 0, q = 0, r = 8;
+    volatile unsign64 c1, c2;
+    unsign64 mask1, mask2, f = f0, g = g0, x, y, z;
+
+    for (int i = 3; i < 62; i++)
+    {
+        /* Masks for zeta < 0 and for g odd */
+        c1 = (unsign64)(zeta >> 63);
+        mask1 = c1;
+        c2 = g & 1;
+        mask2 = 0 - c2;
+        /* x, y, z are f, u, v negated if zeta < 0 */
+        x = (f ^ mask1) - mask1;
+        y = (u ^ mask1) - mask1;
+        z = (v ^ mask1) - mask1;
+        /* Add them to g, q, r if g is odd */
+        g += x & mask2;
+        q += y & mask2;
+        r += z & mask2;
+        /* Now mask1 means zeta < 0 and g odd: zeta becomes -zeta-2, else zeta-1 */
+        mask1 &= mask2;
+        zeta = (zeta ^ (sign64)mask1) - 1;
+        /* ...and f, u, v take the old g, q, r */
+        f += g & mask1;
+        u += q & mask1;
+        v += r & mask1;
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+    t->u = (sign64)u;
+    t->v = (sign64)v;
+    t->q = (sign64)q;
+    t->r = (sign64)r;
+    return zeta;
+}
+
+/* (d, e) = t.(d, e) / 2^62 mod m, with multiples of m added so the division is exact */
+static void update_de_62(SIGNED62 *d, SIGNED62 *e, const TRANS2X2 *t, const MODINFO *mi)
+{
+    const sign64 u = t->u, v = t->v, q = t->q, r = t->r;
+    sign64 md, me, sd, se;
+    s128 cd, ce;
+
+    /* Keep (d, e) in range: add m.[u,q] if d < 0, and m.[v,r] if e < 0 */
+    sd = d->v[4] >> 63;
+    se = e->v[4] >> 63;
+    md = (u & sd) + (v & se);
+    me = (q & sd) + (r & se);
+
+    cd = (s128)u * d->v[0] + (s128)v * e->v[0];
+    ce = (s128)q * d->v[0] + (s128)r * e->v[0];
+
+    /* Choose md, me so that the low 62 bits of t.(d, e) + m.(md, me) are zero */
+    md -= (sign64)((mi->minv62 * (unsign64)cd + (unsign64)md) & M62);
+    me -= (sign64)((mi->minv62 * (unsign64)ce + (unsign64)me) & M62);
+
+    cd += (s128)mi->m.v[0] * md;
+    ce += (s128)mi->m.v[0] * me;
+    cd >>= 62;
+    ce >>= 62;
+
+    for (int i = 1; i < 5; i++)
+    {
+        cd += (s128)u * d->v[i] + (s128)v * e->v[i] + (s128)mi->m.v[i] * md;
+        ce += (s128)q * d->v[i] + (s128)r * e->v[i] + (s128)mi->m.v[i] * me;
+        d->v[i - 1] = (sign64)((unsign64)cd & M62);
+        e->v[i - 1] = (sign64)((unsign64)ce & M62);
+        cd >>= 62;
+        ce >>= 62;
+    }
+    d->v[4] = (sign64)cd;
+    e->v[4] = (sign64)ce;
+}
+
+/* (f, g) = t.(f, g) / 2^62, which is exact */
+static void update_fg_62(SIGNED62 *f, SIGNED62 *g, const TRANS2X2 *t)
+{
+    const sign64 u = t->u, v = t->v, q = t->q, r = t->r;
+    s128 cf, cg;
+
+    cf = (s128)u * f->v[0] + (s128)v * g->v[0];
+    cg = (s128)q * f->v[0] + (s128)r * g->v[0];
+    cf >>= 62;
+    cg >>= 62;
+
+    for (int i = 1; i < 5; i++)
+    {
+        cf += (s128)u * f->v[i] + (s128)v * g->v[i];
+        cg += (s128)q * f->v[i] + (s128)r * g->v[i];
+        f->v[i - 1] = (sign64)((unsign64)cf & M62);
+        g->v[i - 1] = (sign64)((unsign64)cg & M62);
+        cf >>= 62;
+        cg >>= 62;
+    }
+    f->v[4] = (sign64)cf;
+    g->v[4] = (sign64)cg;
+}
+
+/* Carry each limb's excess into the next, leaving limbs 0..3 in [0, 2^62) */
+static void carry_62(sign64 *r)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        r[i + 1] += r[i] >> 62;
+        r[i] &= (sign64)M62;
+    }
+}
+
+/* Bring r from (-2m, m) to [0, m), negating it first if sign < 0 */
+static void normalize_62(SIGNED62 *r, sign64 sign, const MODINFO *mi)
+{
+    volatile sign64 cond_add, cond_negate;
+    sign64 *x = r->v;
+
+    cond_add = x[4] >> 63;
+    for (int i = 0; i < 5; i++) x[i] += mi->m.v[i] & cond_add;
+    cond_negate = sign >> 63;
+    for (int i = 0; i < 5; i++) x[i] = (x[i] ^ cond_negate) - cond_negate;
+    carry_62(x);
+
+    cond_add = x[4] >> 63;
+    for (int i = 0; i < 5; i++) x[i] += mi->m.v[i] & cond_add;
+    carry_62(x);
+}
+
+static void modinv(unsign64 *x, const unsign64 *a, const MODINFO *mi)
+{
+    SIGNED62 d = {{0, 0, 0, 0, 0}}, e = {{1, 0, 0, 0, 0}}, f = mi->m, g;
+    sign64 zeta = -1;  /* delta = 1/2 */
+    TRANS2X2 t;
+
+    g.v[0] = (sign64)(a[0] & M62);
+    g.v[1] = (sign64)(((a[0] >> 62) | (a[1] << 2)) & M62);
+    g.v[2] = (sign64)(((a[1] >> 60) | (a[2] << 4)) & M62);
+    g.v[3] = (sign64)(((a[2] >> 58) | (a[3] << 6)) & M62);
+    g.v[4] = (sign64)(a[3] >> 56);
+
+    for (int i = 0; i < 10; i++)
+    {
+        zeta = divsteps_59(zeta, (unsign64)f.v[0], (unsign64)g.v[0], &t);
+        update_de_62(&d, &e, &t, mi);
+        update_fg_62(&f, &g, &t);
+    }
+
+    /* g = 0 and f = +-1 now, so d = +-1/a */
+    normalize_62(&d, f.v[4], mi);
+
+    x[0] = (unsign64)d.v[0] | ((unsign64)d.v[1] << 62);
+    x[1] = ((unsign64)d.v[1] >> 2) | ((unsign64)d.v[2] << 60);
+    x[2] = ((unsign64)d.v[2] >> 4) | ((unsign64)d.v[3] << 58);
+    x[3] = ((unsign64)d.v[3] >> 6) | ((unsign64)d.v[4] << 56);
+}
+
+void SAFEGCD_NIST256_modp(unsign64 *x, const unsign64 *a)
+{
+    modinv(x, a, &MOD_P);
+}
+
+void SAFEGCD_NIST256_modr(unsign64 *x, const unsign64 *a)
+{
+    modinv(x, a, &MOD_R);
+}
+
+void SAFEGCD_NIST256_invmodr(BIG_256_56 x, BIG_256_56 a)
+{
+    char b[MODBYTES_256_56];
+    unsign64 w[4];
+
+    BIG_256_56_toBytes(b, a);
+    for (int i = 0; i < 4; i++)
+    {
+        w[i] = 0;
+        for (int j = 0; j < 8; j++) w[i] = (w[i] << 8) | (unsign64)(unsigned char)b[8 * (3 - i) + j];
+    }
+    SAFEGCD_NIST256_modr(w, w);
+    for (int i = 0; i < 4; i++)
+        for (int j = 0; j < 8; j++) b[8 * (3 - i) + j] = (char)(w[i] >> (56 - 8 * j));
+    BIG_256_56_fromBytes(x, b);
+
+    for (int i = 0; i < MODBYTES_256_56; i++) b[i] = 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file safegcd_NIST256.h
+ * @brief Constant-time modular inversion by safegcd for the NIST256 moduli
+ *
+ * Bernstein and Yang's divstep algorithm, "Fast constant-time gcd
+ * computation and modular inversion" (2019), in the form libsecp256k1
+ * uses: batches of 59 divsteps run on the low 64 bits of f and g alone
+ * and produce a 2x2 transition matrix, which is then applied to the full
+ * numbers in signed radix 2^62. Ten batches, 590 divsteps, suffice for
+ * any 256-bit modulus, so the sequence of operations never depends on
+ * the input. Both the field prime p and the group order r are supported.
+ *
+ * Built into FP64_NIST256_inv and FR64_NIST256_inv in place of Fermat
+ * exponentiation when compiled with -DNIST256_SAFEGCD (make SAFEGCD=1).
+ */
+
+#ifndef SAFEGCD_NIST256_H
+#define SAFEGCD_NIST256_H
+
+#include "core.h"
+#include "big_256_56.h"
+
+/**	@brief Inverse modulo the field prime p, constant time
+ *
+	Inputs and outputs are plain integers, four little-endian 64-bit limbs
+	@param x on exit = 1/a mod p, or 0 if a = 0
+	@param a the input, 0 <= a < p
+ */
+extern void SAFEGCD_NIST256_modp(unsign64 *x, const unsign64 *a);
+/**	@brief Inverse modulo the group order r, constant time
+ *
+	Inputs and outputs are plain integers, four little-endian 64-bit limbs
+	@param x on exit = 1/a mod r, or 0 if a = 0
+	@param a the input, 0 <= a < r
+ */
+extern void SAFEGCD_NIST256_modr(unsign64 *x, const unsign64 *a);
+/**	@brief Inverse of a BIG modulo the group order r, constant time
+ *
+	Same result as BIG_256_56_invmodp(x, a, r) for CURVE_Order_NIST256
+	@param x BIG number, on exit = 1/a mod r
+	@param a BIG number, 0 <= a < r
+ */
+extern void SAFEGCD_NIST256_invmodr(BIG_256_56 x, BIG_256_56 a);
+
+#endif
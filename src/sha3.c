@@ -0,0 +1,495 @@
+/**
+ * sha3.c - Bulk SHA3/SHAKE on MIRACL Core's sha3 state, and 4-way Keccak
+ *
+ * One round of Keccak-f[1600] is written once, as SHA3_ROUND, over
+ * operations passed in as macros, and instantiated for 64-bit words and
+ * for AVX2 and AVX-512VL vectors of four states. The four-state layout
+ * is word-major, S[i][l] being lane i of state l, so that lane i of all
+ * states loads as one vector.
+ *
+ * SHA3_multi runs each job as a sequence of permutations: one per block
+ * of message, the last holding the partial block and the padding, then
+ * one per further block of output. A state freed by a finished job takes
+ * the next job at once, so all four stay busy while the queue lasts.
+ */
+
+#include <string.h>
+
+#include "sha3.h"
+#include "dispatch.h"
+
+#if defined(__x86_64__) && !defined(HASH256_NOSIMD)
+#define SHA3_X86
+#include <immintrin.h>
+#endif
+
+static const unsign64 RC[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+    0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+    0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+/* One round on lanes A[x+5y] of type T: theta, rho and pi into b, chi back into A, iota */
+#define SHA3_ROUND(T, A, rc, XOR, XOR5, ROL, CHI, RC)                  \
+    do                                                                 \
+    {                                                                  \
+        T c0, c1, c2, c3, c4, d0, d1, d2, d3, d4;                      \
+        T b0, b1, b2, b3, b4, b5, b6, b7, b8, b9, b10, b11, b12;       \
+        T b13, b14, b15, b16, b17, b18, b19, b20, b21, b22, b23, b24;  \
+        c0 = XOR5(A[0], A[5], A[10], A[15], A[20]);                    \
+        c1 = XOR5(A[1], A[6], A[11], A[16], A[21]);                    \
+        c2 = XOR5(A[2], A[7], A[12], A[17], A[22]);                    \
+        c3 = XOR5(A[3], A[8], A[13], A[18], A[23]);                    \
+        c4 = XOR5(A[4], A[9], A[14], A[19], A[24]);                    \
+        d0 = XOR(c4, ROL(c1, 1));                                      \
+        d1 = XOR(c0, ROL(c2, 1));                                      \
+        d2 = XOR(c1, ROL(c3, 1));                                      \
+        d3 = XOR(c2, ROL(c4, 1));                                      \
+        d4 = XOR(c3, ROL(c0, 1));                                      \
+        b0 = XOR(A[0], d0);                                            \
+        b1 = ROL(XOR(A[6], d1), 44);                                   \
+        b2 = ROL(XOR(A[12], d2), 43);                                  \
+        b3 = ROL(XOR(A[18], d3), 21);                                  \
+        b4 = ROL(XOR(A[24], d4), 14);                                  \
+        b5 = ROL(XOR(A[3], d3), 28);                                   \
+        b6 = ROL(XOR(A[9], d4), 20);                                   \
+        b7 = ROL(XOR(A[10], d0), 3);                                   \
+        b8 = ROL(XOR(A[16], d1), 45);                                  \
+        b9 = ROL(XOR(A[22], d2), 61);                                  \
+        b10 = ROL(XOR(A[1], d1), 1);                                   \
+        b11 = ROL(XOR(A[7], d2), 6);                                   \
+        b12 = ROL(XOR(A[13], d3), 25);                                 \
+        b13 = ROL(XOR(A[19], d4), 8);                                  \
+        b14 = ROL(XOR(A[20], d0), 18);                                 \
+        b15 = ROL(XOR(A[4], d4), 27);                                  \
+        b16 = ROL(XOR(A[5], d0), 36);                                  \
+        b17 = ROL(XOR(A[11], d1), 10);                                 \
+        b18 = ROL(XOR(A[17], d2), 15);                                 \
+        b19 = ROL(XOR(A[23], d3), 56);                                 \
+        b20 = ROL(XOR(A[2], d2), 62);                                  \
+        b21 = ROL(XOR(A[8], d3), 55);                                  \
+        b22 = ROL(XOR(A[14], d4), 39);                                 \
+        b23 = ROL(XOR(A[15], d0), 41);                                 \
+        b24 = ROL(XOR(A[21], d1), 2);                                  \
+        A[0] = CHI(b0, b1, b2);                                        \
+        A[1] = CHI(b1, b2, b3);                                        \
+        A[2] = CHI(b2, b3, b4);                                        \
+        A[3] = CHI(b3, b4, b0);                                        \
+        A[4] = CHI(b4, b0, b1);                                        \
+        A[5] = CHI(b5, b6, b7);                                        \
+        A[6] = CHI(b6, b7, b8);                                        \
+        A[7] = CHI(b7, b8, b9);                                        \
+        A[8] = CHI(b8, b9, b5);                                        \
+        A[9] = CHI(b9, b5, b6);                                        \
+        A[10] = CHI(b10, b11, b12);                                    \
+        A[11] = CHI(b11, b12, b13);                                    \
+        A[12] = CHI(b12, b13, b14);                                    \
+        A[13] = CHI(b13, b14, b10);                                    \
+        A[14] = CHI(b14, b10, b11);                                    \
+        A[15] = CHI(b15, b16, b17);                                    \
+        A[16] = CHI(b16, b17, b18);                                    \
+        A[17] = CHI(b17, b18, b19);                                    \
+        A[18] = CHI(b18, b19, b15);                                    \
+        A[19] = CHI(b19, b15, b16);                                    \
+        A[20] = CHI(b20, b21, b22);                                    \
+        A[21] = CHI(b21, b22, b23);                                    \
+        A[22] = CHI(b22, b23, b24);                                    \
+        A[23] = CHI(b23, b24, b20);                                    \
+        A[24] = CHI(b24, b20, b21);                                    \
+        A[0] = XOR(A[0], RC(rc));                                      \
+    } while (0)
+
+#define SHA3_XOR(x, y) ((x) ^ (y))
+#define SHA3_XOR5(a, b, c, d, e) ((a) ^ (b) ^ (c) ^ (d) ^ (e))
+#define SHA3_ROL(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+#define SHA3_CHI(a, b, c) ((a) ^ (~(b) & (c)))
+#define SHA3_RC(k) RC[k]
+
+void SHA3_permute(unsign64 S[25])
+{
+    unsign64 A[25];
+
+    memcpy(A, S, sizeof(A));
+    for (int k = 0; k < 24; k += 2)
+    {
+        SHA3_ROUND(unsign64, A, k, SHA3_XOR, SHA3_XOR5, SHA3_ROL, SHA3_CHI, SHA3_RC);
+        SHA3_ROUND(unsign64, A, k + 1, SHA3_XOR, SHA3_XOR5, SHA3_ROL, SHA3_CHI, SHA3_RC);
+    }
+    memcpy(S, A, sizeof(A));
+}
+
+static void SHA3_permute4_c(unsign64 S[25][SHA3_LANES])
+{
+    unsign64 A[25];
+
+    for (int l = 0; l < SHA3_LANES; l++)
+    {
+        for (int i = 0; i < 25; i++) A[i] = S[i][l];
+        SHA3_permute(A);
+        for (int i = 0; i < 25; i++) S[i][l] = A[i];
+    }
+}
+
+#ifdef SHA3_X86
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx2,avx512f,avx512vl")))
+
+#define SHA3_XOR_AVX2(x, y) _mm256_xor_si256(x, y)
+#define SHA3_XOR5_AVX2(a, b, c, d, e) _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(c, d)), e)
+#define SHA3_ROL_AVX2(x, n) _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n)))
+#define SHA3_CHI_AVX2(a, b, c) _mm256_xor_si256(a, _mm256_andnot_si256(b, c))
+#define SHA3_RC_VEC(k) _mm256_set1_epi64x((long long)RC[k])
+
+AVX2_TARGET static void SHA3_permute4_avx2(unsign64 S[25][SHA3_LANES])
+{
+    __m256i A[25];
+
+    for (int i = 0; i < 25; i++) A[i] = _mm256_loadu_si256((const __m256i *)S[i]);
+    for (int k = 0; k < 24; k++)
+        SHA3_ROUND(__m256i, A, k, SHA3_XOR_AVX2, SHA3_XOR5_AVX2, SHA3_ROL_AVX2, SHA3_CHI_AVX2, SHA3_RC_VEC);
+    for (int i = 0; i < 25; i++) _mm256_storeu_si256((__m256i *)S[i], A[i]);
+}
+
+#define SHA3_XOR5_AVX512(a, b, c, d, e) _mm256_ternarylogic_epi64(_mm256_ternarylogic_epi64(a, b, c, 0x96), d, e, 0x96)
+#define SHA3_ROL_AVX512(x, n) _mm256_rol_epi64(x, n)
+#define SHA3_CHI_AVX512(a, b, c) _mm256_ternarylogic_epi64(a, b, c, 0xD2)
+
+AVX512_TARGET static void SHA3_permute4_avx512(unsign64 S[25][SHA3_LANES])
+{
+    __m256i A[25];
+
+    for (int i = 0; i < 25; i++) A[i] = _mm256_loadu_si256((const __m256i *)S[i]);
+    for (int k = 0; k < 24; k++)
+        SHA3_ROUND(__m256i, A, k, SHA3_XOR_AVX2, SHA3_XOR5_AVX512, SHA3_ROL_AVX512, SHA3_CHI_AVX512, SHA3_RC_VEC);
+    for (int i = 0; i < 25; i++) _mm256_storeu_si256((__m256i *)S[i], A[i]);
+}
+
+#endif
+
+typedef void (*SHA3_kernel)(unsign64 S[25][SHA3_LANES]);
+
+/* The four-way permutation of each level, indexed by SHA3_SIMD_* */
+static const SHA3_kernel SHA3_kernels[] = {
+    SHA3_permute4_c,
+#ifdef SHA3_X86
+    SHA3_permute4_avx2,
+    SHA3_permute4_avx512,
+#endif
+};
+
+static int SHA3_active = -1;
+
+int SHA3_simd(int max)
+{
+    int k = SHA3_SIMD_NONE;
+
+#ifdef SHA3_X86
+    __builtin_cpu_init();
+    if (max >= SHA3_SIMD_AVX512 && __builtin_cpu_supports("avx512vl"))
+        k = SHA3_SIMD_AVX512;
+    else if (max >= SHA3_SIMD_AVX2 && __builtin_cpu_supports("avx2"))
+        k = SHA3_SIMD_AVX2;
+#else
+    (void)max;
+#endif
+    return DISPATCH_set(&SHA3_active, k);
+}
+
+int SHA3_simd_active(void)
+{
+    return DISPATCH_get(&SHA3_active, SHA3_simd, SHA3_SIMD_AVX512);
+}
+
+void SHA3_permute4(unsign64 S[25][SHA3_LANES])
+{
+    SHA3_kernels[SHA3_simd_active()](S);
+}
+
+/* Little-endian, written out so that the compiler emits one load or store */
+static inline unsign64 SHA3_load(const unsigned char *b)
+{
+    return (unsign64)b[0] | (unsign64)b[1] << 8 | (unsign64)b[2] << 16 | (unsign64)b[3] << 24 |
+           (unsign64)b[4] << 32 | (unsign64)b[5] << 40 | (unsign64)b[6] << 48 | (unsign64)b[7] << 56;
+}
+
+static inline void SHA3_store(unsigned char *b, unsign64 x)
+{
+    b[0] = (unsigned char)x;
+    b[1] = (unsigned char)(x >> 8);
+    b[2] = (unsigned char)(x >> 16);
+    b[3] = (unsigned char)(x >> 24);
+    b[4] = (unsigned char)(x >> 32);
+    b[5] = (unsigned char)(x >> 40);
+    b[6] = (unsigned char)(x >> 48);
+    b[7] = (unsigned char)(x >> 56);
+}
+
+/* XORs a block of rate bytes into the lanes S[0], S[stride], ... */
+static void SHA3_absorb(unsign64 *S, int stride, const unsigned char *b, int rate)
+{
+    for (int i = 0; i < rate / 8; i++) S[i * stride] ^= SHA3_load(b + 8 * i);
+}
+
+/* Copies out the first n bytes of the lanes S[0], S[stride], ... */
+static void SHA3_extract(const unsign64 *S, int stride, unsigned char *o, int n)
+{
+    int i;
+
+    for (i = 0; i < n / 8; i++) SHA3_store(o + 8 * i, S[i * stride]);
+    for (i *= 8; i < n; i++) o[i] = (unsigned char)(S[(i / 8) * stride] >> (8 * (i % 8)));
+}
+
+void SHA3_update(sha3 *H, const char *b, int len)
+{
+    const unsigned char *p = (const unsigned char *)b;
+    int pos = H->length % H->rate;
+
+    while (len > 0)
+    {
+        if (pos == 0 && len >= H->rate)
+        {
+            SHA3_absorb(H->S, 1, p, H->rate);
+            SHA3_permute(H->S);
+            p += H->rate;
+            len -= H->rate;
+            continue;
+        }
+        if ((pos & 7) == 0 && len >= 8)
+        {
+            H->S[pos / 8] ^= SHA3_load(p);
+            pos += 8;
+            p += 8;
+            len -= 8;
+        }
+        else
+        {
+            H->S[pos / 8] ^= (unsign64)*p << (8 * (pos & 7));
+            pos++;
+            p++;
+            len--;
+        }
+        if (pos == H->rate)
+        {
+            SHA3_permute(H->S);
+            pos = 0;
+        }
+    }
+    H->length = pos;
+}
+
+/* Pads with domain bits d, then squeezes len bytes */
+static void SHA3_final(sha3 *H, int d, unsigned char *h, int len)
+{
+    int pos = H->length % H->rate, k;
+
+    H->S[pos / 8] ^= (unsign64)d << (8 * (pos & 7));
+    H->S[(H->rate - 1) / 8] ^= (unsign64)0x80 << (8 * ((H->rate - 1) & 7));
+    for (;;)
+    {
+        SHA3_permute(H->S);
+        k = len < H->rate ? len : H->rate;
+        SHA3_extract(H->S, 1, h, k);
+        h += k;
+        len -= k;
+        if (len == 0) break;
+    }
+    SHA3_init(H, H->len);
+}
+
+void SHA3_digest(sha3 *H, char *h)
+{
+    SHA3_final(H, 0x06, (unsigned char *)h, H->len);
+}
+
+void SHA3_xof(sha3 *H, char *h, int len)
+{
+    SHA3_final(H, 0x1F, (unsigned char *)h, len);
+}
+
+void SHA3_clone(sha3 *D, const sha3 *S)
+{
+    *D = *S;
+}
+
+int SHA3_export(const sha3 *H, octet *O)
+{
+    unsigned char *b = (unsigned char *)O->val;
+
+    if (O->max < SHA3_STATE_MAX) return -1;
+    b[0] = 0x04;
+    b[1] = (unsigned char)H->len;
+    b[2] = (unsigned char)(H->length % H->rate);
+    SHA3_extract(H->S, 1, b + 3, 200);
+    O->len = SHA3_STATE_MAX;
+    return 0;
+}
+
+/* The output lengths SHA3_init accepts, so that an imported state has a rate it could have had */
+static int SHA3_length(int len)
+{
+    switch (len)
+    {
+    case SHAKE128:
+    case SHA3_HASH224:
+    case SHA3_HASH256:  /* and SHAKE256 */
+    case SHA3_HASH384:
+    case SHA3_HASH512:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+int SHA3_import(sha3 *H, octet *O)
+{
+    const unsigned char *b = (const unsigned char *)O->val;
+
+    if (O->len != SHA3_STATE_MAX || b[0] != 0x04 || !SHA3_length(b[1]) || b[2] >= 200 - 2 * b[1]) return -1;
+    H->len = b[1];
+    H->rate = 200 - 2 * b[1];
+    H->length = b[2];
+    for (int i = 0; i < 25; i++) H->S[i] = SHA3_load(b + 3 + 8 * i);
+    return 0;
+}
+
+typedef struct
+{
+    int job;                    /* Index of the job, or -1 if the state is idle */
+    const unsigned char *p;     /* The next block of message */
+    int blocks;                 /* Blocks left to absorb, the padded one included */
+    unsigned char *out;         /* Where the next output goes */
+    int olen;                   /* Output bytes still to squeeze */
+    unsigned char pad[200];     /* The last partial block and the padding */
+} SHA3_LANE;
+
+static void SHA3_start(SHA3_LANE *L, int job, const SHA3_JOB *j, int rate, int d, int olen)
+{
+    int rem = j->len % rate;
+
+    L->job = job;
+    L->p = (const unsigned char *)j->msg;
+    L->blocks = j->len / rate + 1;
+    L->out = (unsigned char *)j->out;
+    L->olen = olen;
+    memset(L->pad, 0, (size_t)rate);
+    if (rem > 0) memcpy(L->pad, L->p + j->len - rem, (size_t)rem);
+    L->pad[rem] ^= (unsigned char)d;
+    L->pad[rate - 1] ^= 0x80;
+}
+
+/* Before a permutation: absorbs the next block into the lanes S[0], S[stride], ... */
+static void SHA3_step_in(SHA3_LANE *L, unsign64 *S, int stride, int rate)
+{
+    if (L->blocks == 0) return;
+    if (L->blocks > 1)
+    {
+        SHA3_absorb(S, stride, L->p, rate);
+        L->p += rate;
+    }
+    else SHA3_absorb(S, stride, L->pad, rate);
+    L->blocks--;
+}
+
+/* After it: squeezes, once the message is absorbed; 1 when the job is done */
+static int SHA3_step_out(SHA3_LANE *L, const unsign64 *S, int stride, int rate)
+{
+    int k;
+
+    if (L->blocks > 0) return 0;
+    k = L->olen < rate ? L->olen : rate;
+    SHA3_extract(S, stride, L->out, k);
+    L->out += k;
+    L->olen -= k;
+    return L->olen == 0;
+}
+
+/* Runs a job to the end on its own state s */
+static void SHA3_single(SHA3_LANE *L, unsign64 s[25], int rate)
+{
+    do
+    {
+        SHA3_step_in(L, s, 1, rate);
+        SHA3_permute(s);
+    } while (!SHA3_step_out(L, s, 1, rate));
+}
+
+void SHA3_multi(int t, int xof, int n, SHA3_JOB J[])
+{
+    SHA3_LANE L[SHA3_LANES];
+    unsign64 S[25][SHA3_LANES], s[25];
+    int rate = 200 - 2 * t, d = xof ? 0x1F : 0x06;
+    int l, i, next = 0, active = 0, k = SHA3_simd_active();
+    /* Four states in AVX-512VL take less time than one in C, in AVX2 about 1.5 times as long,
+       so there the last busy state is faster finished on its own */
+    int alone = k == SHA3_SIMD_AVX2;
+
+    if (k == SHA3_SIMD_NONE)
+    {
+        for (i = 0; i < n; i++)
+        {
+            SHA3_start(&L[0], i, &J[i], rate, d, xof ? J[i].olen : t);
+            memset(s, 0, sizeof(s));
+            SHA3_single(&L[0], s, rate);
+        }
+        memset(L[0].pad, 0, sizeof(L[0].pad));
+        memset(s, 0, sizeof(s));
+        return;
+    }
+
+    for (l = 0; l < SHA3_LANES; l++) L[l].job = -1;
+    for (;;)
+    {
+        for (l = 0; l < SHA3_LANES && next < n; l++)
+        {
+            if (L[l].job >= 0) continue;
+            SHA3_start(&L[l], next, &J[next], rate, d, xof ? J[next].olen : t);
+            for (i = 0; i < 25; i++) S[i][l] = 0;
+            next++;
+            active++;
+        }
+        if (active == 0) break;
+
+        if (next == n && active == 1 && alone)
+        {
+            for (l = 0; L[l].job < 0; l++);
+            for (i = 0; i < 25; i++) s[i] = S[i][l];
+            SHA3_single(&L[l], s, rate);
+            break;
+        }
+
+        for (l = 0; l < SHA3_LANES; l++)
+            if (L[l].job >= 0) SHA3_step_in(&L[l], &S[0][l], SHA3_LANES, rate);
+        SHA3_kernels[k](S);
+        for (l = 0; l < SHA3_LANES; l++)
+        {
+            if (L[l].job < 0 || !SHA3_step_out(&L[l], &S[0][l], SHA3_LANES, rate)) continue;
+            L[l].job = -1;
+            active--;
+        }
+    }
+
+    for (l = 0; l < SHA3_LANES; l++) memset(L[l].pad, 0, sizeof(L[l].pad));
+    memset(S, 0, sizeof(S));
+    memset(s, 0, sizeof(s));
+}
+
+void XOF_Expand_bulk(int hlen, octet *E, int olen, octet *P, octet *S)
+{
+    sha3 H;
+    char b[2];
+
+    SHA3_init(&H, hlen);
+    SHA3_update(&H, S->val, S->len);
+    b[0] = (char)((olen >> 8) & 0xff);
+    b[1] = (char)(olen & 0xff);
+    SHA3_update(&H, b, 2);
+    SHA3_update(&H, P->val, P->len);
+    b[0] = (char)(P->len & 0xff);
+    SHA3_update(&H, b, 1);
+    SHA3_xof(&H, E->val, olen);
+    E->len = olen;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file sha3.h
+ * @brief Bulk SHA3/SHAKE on MIRACL Core's sha3 state, and 4-way Keccak
+ *
+ * SHA3_process absorbs one byte per call and SHA3_shake squeezes one byte
+ * at a time. SHA3_update absorbs a whole buffer into the same sha3 state
+ * eight bytes to a lane, a full block per permutation once aligned, and
+ * SHA3_xof and SHA3_digest squeeze a lane at a time.
+ *
+ * For independent inputs, such as the messages of a hash-to-field batch,
+ * SHA3_multi runs four Keccak-f[1600] states side by side, one per 64-bit
+ * lane of an AVX2 register, or of an AVX-512VL one, whose rotate and
+ * three-input logic instructions shorten theta and chi. The kernel is
+ * chosen at run time; without AVX2, or built with -DHASH256_NOSIMD (make
+ * NOSIMD=1), the states are permuted one at a time in portable C.
+ *
+ * The state is the sponge of FIPS 202 as sha3 holds it: byte i of a block
+ * is XORed into byte i mod 8 of S[i/8], and length counts the bytes of the
+ * current block. Output is the same as from the byte-at-a-time functions.
+ *
+ * A state part way through a message can be cloned, or exported as an
+ * octet and imported again: a 0x04 tag, the output length the instance
+ * was initialised with, the bytes absorbed into the current block, then
+ * the 200-byte state, lane by lane, little-endian.
+ */
+
+#ifndef SHA3_H
+#define SHA3_H
+
+#include "core.h"
+
+#define SHA3_LANES 4        /**< States permuted at once by SHA3_permute4 */
+
+#define SHA3_STATE_MAX 203   /**< Length of an exported SHA3 state */
+
+#define SHA3_SIMD_NONE 0    /**< One state at a time in portable C */
+#define SHA3_SIMD_AVX2 1    /**< Four states in AVX2 */
+#define SHA3_SIMD_AVX512 2  /**< Four states in AVX-512VL */
+
+/**
+	@brief One input for SHA3_multi
+*/
+typedef struct
+{
+    const char *msg;  /**< The message bytes */
+    int len;          /**< The number of message bytes */
+    char *out;        /**< On exit the hash, or olen bytes of SHAKE output */
+    int olen;         /**< The number of SHAKE output bytes, ignored for SHA3 */
+} SHA3_JOB;
+
+/**	@brief Selects the fastest permutation kernel the CPU has, up to a limit
+ *
+	The choice is made automatically, and thread-safely, on first use; this
+	overrides it, for comparing the kernels. All give the same digests, so
+	hashing in other threads stays correct across the switch.
+	@param max the fastest kernel allowed, SHA3_SIMD_NONE, _AVX2 or _AVX512
+	@return the kernel now in use
+ */
+extern int SHA3_simd(int max);
+/**	@brief Tests which permutation kernel is in use
+ *
+	@return SHA3_SIMD_NONE, SHA3_SIMD_AVX2 or SHA3_SIMD_AVX512
+ */
+extern int SHA3_simd_active(void);
+/**	@brief Keccak-f[1600] on one state
+ *
+	@param S the 25 lanes, S[x+5y], permuted in place
+ */
+extern void SHA3_permute(unsign64 S[25]);
+/**	@brief Keccak-f[1600] on four states at once
+ *
+	@param S lane x+5y of state l in S[x+5y][l], permuted in place
+ */
+extern void SHA3_permute4(unsign64 S[25][SHA3_LANES]);
+/**	@brief Process an array of bytes
+ *
+	Same state as calling SHA3_process(H, b[i]) for each byte in turn.
+	@param H an instance SHA3
+	@param b the bytes to be included in hash
+	@param len the number of bytes
+ */
+extern void SHA3_update(sha3 *H, const char *b, int len);
+/**	@brief Create fixed length final hash output of SHA3, and re-initialise
+ *
+	Same output as SHA3_hash.
+	@param H an instance SHA3
+	@param h a byte array to take hash
+ */
+extern void SHA3_digest(sha3 *H, char *h);
+/**	@brief Create variable length final hash output of SHAKE, and re-initialise
+ *
+	Same output as SHA3_shake, squeezed a lane at a time.
+	@param H an instance SHA3
+	@param h a byte array to take hash
+	@param len is the length of the hash
+ */
+extern void SHA3_xof(sha3 *H, char *h, int len);
+/**	@brief Copies a SHA3 instance part way through a message
+ *
+	@param D the copy
+	@param S the instance to copy
+ */
+extern void SHA3_clone(sha3 *D, const sha3 *S);
+/**	@brief Exports a SHA3 instance
+ *
+	@param H an instance SHA3
+	@param O the exported state, with room for SHA3_STATE_MAX bytes
+	@return 0 if OK, or -1 if O is too short
+ */
+extern int SHA3_export(const sha3 *H, octet *O);
+/**	@brief Imports a SHA3 instance
+ *
+	@param H the instance to set
+	@param O a state from SHA3_export
+	@return 0 if OK, or -1 if O is not an exported SHA3 state, or is one
+	for a length SHA3_init does not take
+ */
+extern int SHA3_import(sha3 *H, octet *O);
+/**	@brief Hashes n independent messages, four at a time
+ *
+	Each output is the same as SHA3_init(H, t), SHA3_update over the
+	message, then SHA3_digest, or SHA3_xof of olen bytes when xof is set.
+	@param t the instance type, as for SHA3_init
+	@param xof nonzero for SHAKE output, zero for SHA3
+	@param n the number of jobs
+	@param J array of n jobs, processed in order
+ */
+extern void SHA3_multi(int t, int xof, int n, SHA3_JOB J[]);
+/**	@brief XOF_Expand function, absorbing and squeezing in bulk
+ *
+	Same output as XOF_Expand.
+	@param hlen the SHA3 output length (16 or 32)
+	@param E an expanded messsage
+	@param olen is the desired length of the expanded key
+	@param P is Domain Separator
+	@param S input message
+ */
+extern void XOF_Expand_bulk(int hlen, octet *E, int olen, octet *P, octet *S);
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * ecpool_fork.c - Ephemeral key pool across fork()
+ *
+ * A child of fork() inherits the pool's ring and RNG state byte for byte.
+ * If it took key pairs from them, parent and child would hand out the same
+ * ephemeral keys. This fills a pool, forks, and has each process take one
+ * key pair from its pool with no inline fallback: the child's pool must be
+ * refilled afresh and give a public key the parent's never does.
+ *
+ * Usage: ecpool_fork
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// MIRACL Core headers
+#include "core.h"
+#include "ecdh_NIST256.h"
+
+// Fast paths on top of MIRACL Core
+#include "ecpool_NIST256.h"
+
+#define POOL_SIZE 64
+#define WAIT_MS 5000
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+// Take a key pair from the pool only, waiting for the refill thread if empty
+static int take(ECC_NIST256_POOL *P, octet *S, octet *W) {
+    for (int ms = 0; ms < WAIT_MS; ms++) {
+        if (ECC_NIST256_POOL_KEY_PAIR(P, NULL, S, W) == 0) return 0;
+        sleep_ms(1);
+    }
+    return -1;
+}
+
+// Write all of b, or fail
+static int write_all(int fd, const char *b, int n) {
+    while (n > 0) {
+        ssize_t k = write(fd, b, n);
+        if (k <= 0) return -1;
+        b += k;
+        n -= (int)k;
+    }
+    return 0;
+}
+
+// Read exactly n bytes, or fail
+static int read_all(int fd, char *b, int n) {
+    while (n > 0) {
+        ssize_t k = read(fd, b, n);
+        if (k <= 0) return -1;
+        b += k;
+        n -= (int)k;
+    }
+    return 0;
+}
+
+int main(void) {
+    csprng rng;
+    char raw[100];
+    char s[EGS_NIST256], w[2 * EFS_NIST256 + 1], cw[2 * EFS_NIST256 + 1];
+    octet S = {0, sizeof(s), s};
+    octet W = {0, sizeof(w), w};
+    ECC_NIST256_POOL_STATS st;
+    int fd[2], status;
+    pid_t pid;
+
+    time_t ran = time(NULL);
+    raw[0] = (char)ran;
+    raw[1] = (char)(ran >> 8);
+    raw[2] = (char)(ran >> 16);
+    raw[3] = (char)(ran >> 24);
+    for (int i = 4; i < 100; i++) raw[i] = (char)i;
+    RAND_seed(&rng, 100, raw);
+
+    ECC_NIST256_POOL *P = ECC_NIST256_POOL_NEW(&rng, POOL_SIZE);
+    if (P == NULL) {
+        printf("✗ ECC_NIST256_POOL_NEW failed\n");
+        return 1;
+    }
+    for (int ms = 0; ms < WAIT_MS; ms++) {
+        ECC_NIST256_POOL_GET_STATS(P, &st);
+        if (st.depth == st.size) break;
+        sleep_ms(1);
+    }
+    if (st.depth == 0) {
+        printf("✗ pool never filled\n");
+        return 1;
+    }
+
+    if (pipe(fd) != 0) {
+        printf("✗ pipe failed\n");
+        return 1;
+    }
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        printf("✗ fork failed\n");
+        return 1;
+    }
+    if (pid == 0) {
+        // Child: send the public key of the first key pair the pool gives it
+        close(fd[0]);
+        int rc = take(P, &S, &W);
+        if (rc == 0 && W.len == (int)sizeof(w)) rc = write_all(fd[1], W.val, W.len);
+        else rc = -1;
+        close(fd[1]);
+        ECC_NIST256_POOL_FREE(P);
+        _exit(rc == 0 ? 0 : 1);
+    }
+
+    close(fd[1]);
+    int rc = take(P, &S, &W);
+    int got = read_all(fd[0], cw, sizeof(cw));
+    close(fd[0]);
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) got = -1;
+
+    if (rc != 0) {
+        printf("✗ parent could not take a key pair\n");
+        rc = 1;
+    } else if (got != 0) {
+        printf("✗ child could not take a key pair\n");
+        rc = 1;
+    } else if (W.len != (int)sizeof(w) || memcmp(W.val, cw, sizeof(cw)) == 0) {
+        printf("✗ parent and child took the same key pair\n");
+        rc = 1;
+    } else {
+        printf("✓ parent and child took different key pairs\n");
+    }
+
+    ECC_NIST256_POOL_FREE(P);
+    RAND_clean(&rng);
+    return rc;
+}
@@ -0,0 +1,71 @@
+/**
+ * gentab_NIST256.c - Build-time generator for the NIST256 fixed-base table
+ *
+ * Emits a C source file holding sign-free window multiples of the curve
+ * generator (from CURVE_Gx_NIST256/CURVE_Gy_NIST256):
+ *
+ *     ECP_NIST256_GTAB[i][j] = (j+1) * 16^i * G,   0 <= i < 65, 0 <= j < 8
+ *
+ * Points are stored affine, as FP64_NIST256 residues in the full-radix
+ * Montgomery form the fixed-base comb computes in, so they can be loaded
+ * without any conversion. Run by the Makefile; the output is compiled
+ * into the library as const data (.rodata).
+ *
+ * Usage: gentab_NIST256 > gtab_NIST256.c
+ */
+
+#include <stdio.h>
+
+// MIRACL Core headers
+#include "core.h"
+#include "big_256_56.h"
+#include "fp_NIST256.h"
+#include "ecp_NIST256.h"
+
+#include "fp64_NIST256.h"
+#include "ecgen_NIST256.h"
+
+static void print_fp(FP_NIST256 *x) {
+    FP64_NIST256 y;
+    FP64_NIST256_fromFP(&y, x);
+    printf("{{");
+    for (int k = 0; k < FP64_NIST256_LIMBS; k++) {
+        printf("0x%016llXULL%s", (unsigned long long)y.v[k], k + 1 < FP64_NIST256_LIMBS ? "," : "");
+    }
+    printf("}}");
+}
+
+int main() {
+    ECP_NIST256 B, T, A;
+
+    if (!ECP_NIST256_generator(&B)) {
+        fprintf(stderr, "gentab_NIST256: failed to load generator\n");
+        return 1;
+    }
+
+    printf("/* Generated by tools/gentab_NIST256.c - do not edit */\n\n");
+    printf("#include \"ecgen_NIST256.h\"\n\n");
+    printf("const ECP64_NIST256_AFFINE ECP_NIST256_GTAB[ECGEN_NIST256_WINDOWS][ECGEN_NIST256_ENTRIES] = {\n");
+
+    // B runs through 16^i.G, T through (j+1).B
+    for (int i = 0; i < ECGEN_NIST256_WINDOWS; i++) {
+        printf("    {\n");
+        ECP_NIST256_copy(&T, &B);
+        for (int j = 0; j < ECGEN_NIST256_ENTRIES; j++) {
+            if (j > 0) ECP_NIST256_add(&T, &B);
+            ECP_NIST256_copy(&A, &T);
+            ECP_NIST256_affine(&A);
+
+            printf("        {");
+            print_fp(&A.x);
+            printf(", ");
+            print_fp(&A.y);
+            printf("}%s\n", j + 1 < ECGEN_NIST256_ENTRIES ? "," : "");
+        }
+        printf("    }%s\n", i + 1 < ECGEN_NIST256_WINDOWS ? "," : "");
+
+        for (int k = 0; k < ECGEN_NIST256_WINDOW; k++) ECP_NIST256_dbl(&B);
+    }
+    printf("};\n");
+    return 0;
+}